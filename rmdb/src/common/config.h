@@ -34,6 +34,26 @@ static constexpr int HEADER_PAGE_ID = 0;                                      //
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
 static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_MAX_SIZE = 262144;                           // address space reserved for online buffer pool growth 1GB
+static constexpr int RESIZE_TIMEOUT_MS = 5000;                                // how long shrinking waits for pinned frames
+static constexpr int BUFFER_POOL_PARTITIONS = 16;                             // number of buffer pool partitions (latch shards)
+static constexpr bool OPTIMISTIC_READS = true;                               // pin buffer pool hits without taking the partition latch
+static constexpr int OPTIMISTIC_SAMPLE_RATE = 64;                             // one in N latch-free hits updates the replacer (power of 2)
+static constexpr int SCAN_RING_SIZE = 32;                                     // frames in a sequential scan buffer ring
+static constexpr int SCAN_RING_THRESHOLD_DIVISOR = 4;                         // tables larger than pool_size / divisor pages use a scan ring
+static constexpr int PREFETCH_THREADS = 4;                                    // background threads doing read-ahead I/O
+static constexpr int PREFETCH_QUEUE_SIZE = 256;                               // max queued read-ahead requests
+static constexpr int SCAN_PREFETCH_DISTANCE = 16;                             // pages a sequential scan reads ahead
+static constexpr int PAGE_CLEANER_INTERVAL_MS = 10;                           // interval between two page cleaner rounds
+static constexpr int PAGE_CLEANER_TARGET_CLEAN = 32;                          // frames per partition kept clean near the victim end
+static constexpr int PAGE_CLEANER_MAX_PAGES = 256;                            // max pages written per page cleaner round
+static constexpr bool USE_DIRECT_IO = false;                                 // open table/index files with O_DIRECT
+static constexpr bool USE_PAGE_COMPRESSION = false;                          // compress pages of newly created table/index files
+static constexpr bool USE_PAGE_CHECKSUMS = true;                             // CRC32C checksum on every page of newly created table/index files
+static constexpr bool USE_HUGE_PAGES = true;                                 // back buffer pool frames with huge pages
+static constexpr int IX_BULK_LOAD_FILL_FACTOR = 90;                           // percent of btree_order filled by the index bulk loader
+static constexpr size_t IX_BULK_LOAD_SORT_MEM = 64 << 20;                     // bytes of (key, rid) pairs sorted in memory before spilling a run
+static constexpr int IX_BULK_LOAD_BATCH_PAGES = 64;                           // index pages written by the bulk loader per write_pages call
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
 
@@ -48,7 +68,8 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
 
-// replacer
+// replacer: "LRU", "CLOCK" or "LRU-K"
 static const std::string REPLACER_TYPE = "LRU";
+static constexpr int LRUK_REPLACER_K = 2;                                     // K of the LRU-K replacer
 
 static const std::string DB_META_NAME = "db.meta";
@@ -163,4 +163,10 @@ class PageNotExistError : public RMDBError {
    public:
     PageNotExistError(const std::string &table_name, int page_no)
         : RMDBError("Page " + std::to_string(page_no) + " in table " + table_name + "not exits") {}
-};
\ No newline at end of file
+};
+
+class PageChecksumError : public RMDBError {
+   public:
+    PageChecksumError(const std::string &file_name, int page_no)
+        : RMDBError("Page checksum mismatch: page " + std::to_string(page_no) + " in file " + file_name) {}
+};
@@ -25,12 +25,15 @@ const char *help_info = "Supported SQL syntax:\n"
                    "command:\n"
                    "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
                    "  DROP TABLE table_name\n"
-                   "  CREATE INDEX table_name (column_name)\n"
+                   "  VERIFY TABLE table_name\n"
+                   "  CREATE INDEX table_name (column_name) [WITH (index_option [, index_option])]\n"
                    "  DROP INDEX table_name (column_name)\n"
                    "  INSERT INTO table_name VALUES (value [, value ...])\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "index_option:\n"
+                   "  {tree = {btree | blink} | compression = {none | prefix}}\n"
                    "type:\n"
                    "  {INT | FLOAT | CHAR(n)}\n"
                    "where_clause:\n"
@@ -50,7 +53,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, context, x->pax_);
                 break;
             }
             case T_DropTable:
@@ -60,7 +63,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->blink_, x->compress_);
                 break;
             }
             case T_DropIndex:
@@ -75,7 +78,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     }
 }
 
-// 执行help; show tables; desc table; begin; commit; abort;语句
+// 执行help; show tables; desc table; verify table; begin; commit; abort;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -95,6 +98,11 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->desc_table(x->tab_name_, context);
                 break;
             }
+            case T_VerifyTable:
+            {
+                sm_manager_->verify_table(x->tab_name_, context);
+                break;
+            }
             case T_Transaction_begin:
             {
                 // 显示开启一个事务
@@ -135,6 +143,13 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
             planner_->set_enable_sortmerge_join(x->bool_value_);
             break;
         }
+        case ast::SetKnobType::BufferPoolSize: {
+            if (x->int_value_ <= 0) {
+                throw RMDBError("buffer_pool_size must be positive");
+            }
+            sm_manager_->get_bpm()->resize(x->int_value_);
+            break;
+        }
         default: {
             throw RMDBError("Not implemented!\n");
             break;
@@ -170,17 +185,18 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
     size_t num_rec = 0;
     // 执行query_plan
     for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple()) {
-        auto Tuple = executorTreeRoot->Next();
+        // 只读视图，输出时不需要保留记录，因此不物化
+        auto Tuple = executorTreeRoot->NextView();
         std::vector<std::string> columns;
         for (auto &col : executorTreeRoot->cols()) {
             std::string col_str;
-            char *rec_buf = Tuple->data + col.offset;
+            const char *rec_buf = Tuple.data + col.offset;
             if (col.type == TYPE_INT) {
-                col_str = std::to_string(*(int *)rec_buf);
+                col_str = std::to_string(*(const int *)rec_buf);
             } else if (col.type == TYPE_FLOAT) {
-                col_str = std::to_string(*(float *)rec_buf);
+                col_str = std::to_string(*(const float *)rec_buf);
             } else if (col.type == TYPE_STRING) {
-                col_str = std::string((char *)rec_buf, col.len);
+                col_str = std::string(rec_buf, col.len);
                 col_str.resize(strlen(col_str.c_str()));
             }
             columns.push_back(col_str);
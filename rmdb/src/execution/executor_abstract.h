@@ -19,6 +19,8 @@ class AbstractExecutor {
    public:
     Rid _abstract_rid;
 
+    std::unique_ptr<RmRecord> _view_rec;    // NextView()默认实现物化出的当前记录
+
     Context *context_;
 
 
@@ -43,6 +45,24 @@ class AbstractExecutor {
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
+    /**
+     * @description: 返回当前记录的只读视图，视图在下一次nextTuple()之前有效。
+     * 能直接给出记录地址的算子应重写此函数以避免分配和复制，默认实现通过Next()物化一条记录并由算子保存
+     */
+    virtual RmRecordView NextView() {
+        _view_rec = Next();
+        if (_view_rec == nullptr) {
+            return RmRecordView();
+        }
+        return RmRecordView(_view_rec->data, _view_rec->size);
+    }
+
+    /**
+     * @description: 告知算子上层只会读取cols()中下标为col_idxs的字段，其余字段的内容可以不填。
+     * 按列存储的表据此只拼出需要的字段，默认忽略
+     */
+    virtual void set_used_cols(const std::vector<size_t> &col_idxs) {}
+
     virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
 
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
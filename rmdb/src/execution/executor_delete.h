@@ -35,22 +35,22 @@ class DeleteExecutor : public AbstractExecutor {
         rids_ = rids;
         context_ = context;
     }
-    Value get_record_value(const RmRecord &record, const TabCol &col) {
+    Value get_record_value(const char *data, const TabCol &col) {
         Value val;
         auto col_meta = sm_manager_->db_.get_table(tab_name_).get_col(col.col_name)[0];
 
         val.type = col_meta.type;
         
         if (col_meta.type == TYPE_INT) {
-            val.set_int(*(int *)(record.data + col_meta.offset));
+            val.set_int(*(const int *)(data + col_meta.offset));
         } else if (col_meta.type == TYPE_FLOAT) {
-            val.set_float(*(float *)(record.data + col_meta.offset));
+            val.set_float(*(const float *)(data + col_meta.offset));
         } else if (col_meta.type == TYPE_STRING) {
             
             int offset = col_meta.offset;
             int len = col_meta.len;
 
-            val.set_str(std::string(record.data + offset, len));
+            val.set_str(std::string(data + offset, len));
         } 
         else {
             throw TypeNotExistsError();
@@ -60,14 +60,14 @@ class DeleteExecutor : public AbstractExecutor {
         return val;
     }
 
-    bool check_condition(const Condition &cond, const RmRecord &record){
-        Value left = get_record_value(record, cond.lhs_col);
+    bool check_condition(const Condition &cond, const char *data){
+        Value left = get_record_value(data, cond.lhs_col);
         Value right;
 
         if (cond.is_rhs_val) {
             right = cond.rhs_val;
         } else {
-            right = get_record_value(record, cond.rhs_col);
+            right = get_record_value(data, cond.rhs_col);
         }
         int flag = 0;
         if (left.type == TYPE_INT && right.type == TYPE_INT) {
@@ -127,15 +127,21 @@ class DeleteExecutor : public AbstractExecutor {
     }
     std::unique_ptr<RmRecord> Next() override {
         for (auto &rid : rids_) {
-            auto record = fh_->get_record(rid, context_);
+            // 条件直接在缓冲池的页面上检查，不复制记录
+            RmRecordView record = fh_->get_record_view(rid, context_);
+            // slot已经为空(记录已被删除)时得到空的视图
+            if (!record) {
+                continue;
+            }
 
             bool is_valid = true;
-            for(auto cond:conds_){
-                if(!check_condition(cond,*record)){
+            for(auto &cond:conds_){
+                if(!check_condition(cond,record.data)){
                     is_valid = false;
                     break;
                 }
             }
+            record.guard.release();
             if(!is_valid){
                 continue;
             }
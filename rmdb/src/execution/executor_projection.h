@@ -21,6 +21,7 @@ class ProjectionExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                     // 需要投影的字段
     size_t len_;                                    // 字段总长度
     std::vector<size_t> sel_idxs_;                  
+    std::vector<char> buf_;                         // 当前投影结果，NextView()返回的视图指向这里
 
    public:
     ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols) {
@@ -37,6 +38,8 @@ class ProjectionExecutor : public AbstractExecutor {
             cols_.push_back(col);
         }
         len_ = curr_offset;
+        buf_.resize(len_);
+        prev_->set_used_cols(sel_idxs_);
     }
 
     void beginTuple() override {
@@ -47,18 +50,33 @@ class ProjectionExecutor : public AbstractExecutor {
         prev_->nextTuple();
     }
 
+    bool is_end() const override { return prev_->is_end(); }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
     std::unique_ptr<RmRecord> Next() override {
-        auto record = prev_->Next();
-        if (record == nullptr) {
+        RmRecordView view = NextView();
+        if (!view) {
             return nullptr;
         }
-        auto new_record = std::make_unique<RmRecord>(len_);
+        return view.materialize();
+    }
+
+    // 投影到复用的buf_中，不分配内存
+    RmRecordView NextView() override {
+        RmRecordView record = prev_->NextView();
+        if (!record) {
+            return RmRecordView();
+        }
+        auto &prev_cols = prev_->cols();
         for (size_t i = 0; i < sel_idxs_.size(); i++) {
             auto &col = cols_[i];
-            auto &prev_col = prev_->cols()[sel_idxs_[i]];
-            memcpy(new_record->data + col.offset, record->data + prev_col.offset, col.len);
+            auto &prev_col = prev_cols[sel_idxs_[i]];
+            memcpy(buf_.data() + col.offset, record.data + prev_col.offset, col.len);
         }
-        return new_record;
+        return RmRecordView(buf_.data(), len_);
     }
 
     Rid &rid() override { return _abstract_rid; }
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <string_view>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -18,6 +20,13 @@ See the Mulan PSL v2 for more details. */
 
 class SeqScanExecutor : public AbstractExecutor {
    private:
+    // 字段与常量比较的条件，在页面上按字段批量求值
+    struct ColumnPred {
+        ColMeta col;
+        CompOp op;
+        Value val;
+    };
+
     std::string tab_name_;              // 表的名称
     std::vector<Condition> conds_;      // scan的条件
     RmFileHandle *fh_;                  // 表的数据文件句柄
@@ -26,7 +35,14 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;     // table_iterator
+    std::unique_ptr<RmScan> scan_;      // table_iterator，按页pin住页面，记录直接在缓冲池的页面上读取
+
+    std::vector<ColumnPred> col_preds_; // conds_中能按字段批量求值的条件
+    std::vector<Condition> row_conds_;  // conds_中其余需要逐条记录求值的条件
+    std::vector<int> sel_;              // 当前页面上满足所有条件的slot号
+    size_t sel_idx_ = 0;                // 当前记录在sel_中的下标
+    std::vector<size_t> used_cols_;     // 上层算子会读取的字段在cols_中的下标，PAX表只拼出这些字段
+    std::vector<char> buf_;             // PAX表中拼出的当前记录
 
     SmManager *sm_manager_;
 
@@ -43,25 +59,30 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+
+        for (size_t i = 0; i < cols_.size(); i++) {
+            used_cols_.push_back(i);
+        }
+        buf_.resize(len_);
     }
     std::string get_tab_name() override { return tab_name_; }
     
-    Value get_record_value(const RmRecord &record, const TabCol &col) {
+    Value get_record_value(const char *data, const TabCol &col) {
         Value val;
         auto col_meta = sm_manager_->db_.get_table(tab_name_).get_col(col.col_name)[0];
 
         val.type = col_meta.type;
         
         if (col_meta.type == TYPE_INT) {
-            val.set_int(*(int *)(record.data + col_meta.offset));
+            val.set_int(*(const int *)(data + col_meta.offset));
         } else if (col_meta.type == TYPE_FLOAT) {
-            val.set_float(*(float *)(record.data + col_meta.offset));
+            val.set_float(*(const float *)(data + col_meta.offset));
         } else if (col_meta.type == TYPE_STRING) {
             
             int offset = col_meta.offset;
             int len = col_meta.len;
 
-            val.set_str(std::string(record.data + offset, len));
+            val.set_str(std::string(data + offset, len));
         } 
         else {
             throw TypeNotExistsError();
@@ -71,14 +92,34 @@ class SeqScanExecutor : public AbstractExecutor {
         return val;
     }
 
-    bool check_condition(const Condition &cond, const RmRecord &record){
-        Value left = get_record_value(record, cond.lhs_col);
+    // flag为左值与右值比较的结果(<0, 0, >0)
+    static bool eval_op(CompOp op, int flag) {
+        switch (op) {
+            case OP_EQ:
+                return flag == 0;
+            case OP_NE:
+                return flag != 0;
+            case OP_LT:
+                return flag < 0;
+            case OP_LE:
+                return flag <= 0;
+            case OP_GT:
+                return flag > 0;
+            case OP_GE:
+                return flag >= 0;
+            default:
+                throw InternalError("Unexpected cond.op field type");
+        }
+    }
+
+    bool check_condition(const Condition &cond, const char *data){
+        Value left = get_record_value(data, cond.lhs_col);
         Value right;
 
         if (cond.is_rhs_val) {
             right = cond.rhs_val;
         } else {
-            right = get_record_value(record, cond.rhs_col);
+            right = get_record_value(data, cond.rhs_col);
         }
         int flag = 0;
         if (left.type == TYPE_INT && right.type == TYPE_INT) {
@@ -119,60 +160,157 @@ class SeqScanExecutor : public AbstractExecutor {
         } else {
             throw InternalError("Unexpected value pair field type");
         }
-        switch (cond.op) {
-            case OP_EQ:
-                return flag == 0;
-            case OP_NE:
-                return flag != 0;
-            case OP_LT:
-                return flag < 0;
-            case OP_LE:
-                return flag <= 0;
-            case OP_GT:
-                return flag > 0;
-            case OP_GE:
-                return flag >= 0;
-            default:
-                throw InternalError("Unexpected cond.op field type");
-        }
+        return eval_op(cond.op, flag);
     }
 
     void beginTuple() override {
-        scan_ = std::make_unique<RmScan>(fh_);
-        while (!scan_->is_end() && !check_eval()) {      // 跳过不满足条件的记录,找到第一条符合的
-            scan_->next();
+        // 定长和PAX页面上的字段可以直接按列访问，字段与同类型常量的比较放到col_preds_中按列批量求值
+        // 数值字段与同类型常量的比较同时交给scan_，用zone map跳过整个页面
+        col_preds_.clear();
+        row_conds_.clear();
+        std::vector<RmZonePred> zone_preds;
+        TabMeta &tab = sm_manager_->db_.get_table(tab_name_);
+        for (auto &cond : conds_) {
+            if (cond.is_rhs_val) {
+                auto &col = *tab.get_col(cond.lhs_col.col_name);
+                int zone_col = fh_->get_zone_col(col.offset);
+                if (zone_col >= 0 && col.type == cond.rhs_val.type) {
+                    double val = col.type == TYPE_INT ? cond.rhs_val.int_val : cond.rhs_val.float_val;
+                    zone_preds.push_back(RmZonePred{zone_col, cond.op, val});
+                }
+                if (!fh_->is_slotted() && col.type == cond.rhs_val.type) {
+                    col_preds_.push_back(ColumnPred{col, cond.op, cond.rhs_val});
+                    continue;
+                }
+            }
+            row_conds_.push_back(cond);
         }
 
-    }
-    bool check_eval(){
-        auto rec = fh_->get_record(scan_->rid(), context_);
-        bool is_valid = true;
-        for(auto cond:conds_){
-            if(!check_condition(cond,*rec)){
-                is_valid = false;
-                break;
-            }
+        scan_ = std::make_unique<RmScan>(fh_, std::move(zone_preds));
+        sel_.clear();
+        sel_idx_ = 0;
+        if (!scan_->is_end()) {
+            filter_page();
         }
-        return is_valid;
+        seek();
     }
 
     void nextTuple() override {
-        do {
-            scan_->next();  
-        } while (!is_end() && !check_eval());
+        sel_idx_++;
+        seek();
     }
 
+    bool is_end() const override { return scan_->is_end(); }
+
     std::unique_ptr<RmRecord> Next() override {
-        if (scan_->is_end()) 
+        if (is_end()) 
             return nullptr;
         else {
-            return fh_->get_record(scan_->rid(), context_); 
+            return std::make_unique<RmRecord>(len_, record_data());
         }  
 
     }
 
+    // 定长和slotted表直接指向scan_当前pin住的页面或其解码缓冲区，PAX表指向buf_，下一次nextTuple()前有效
+    RmRecordView NextView() override {
+        if (is_end()) {
+            return RmRecordView();
+        }
+        return RmRecordView(record_data(), len_);
+    }
+
+    void set_used_cols(const std::vector<size_t> &col_idxs) override { used_cols_ = col_idxs; }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
     Rid &rid() override { 
-        rid_ = scan_->rid();   
+        if (is_end()) {
+            rid_ = scan_->rid();
+        } else {
+            rid_ = Rid{scan_->rid().page_no, sel_[sel_idx_]};
+        }
         return rid_;
     }
+
+   private:
+    // 对当前页面求出满足所有条件的slot号：先按字段逐个条件筛选整页的slot，再对剩下的记录逐条求值其余条件
+    void filter_page() {
+        sel_ = scan_->page_slots();
+        sel_idx_ = 0;
+        for (auto &pred : col_preds_) {
+            RmColumnView column = scan_->get_column(pred.col.offset, pred.col.len);
+            if (pred.col.type == TYPE_INT) {
+                int val = pred.val.int_val;
+                filter_column(column, pred.op, [val](const char *v) {
+                    int x = *reinterpret_cast<const int *>(v);
+                    return (x > val) - (x < val);
+                });
+            } else if (pred.col.type == TYPE_FLOAT) {
+                float val = pred.val.float_val;
+                filter_column(column, pred.op, [val](const char *v) {
+                    float x = *reinterpret_cast<const float *>(v);
+                    return (x > val) - (x < val);
+                });
+            } else {
+                int len = pred.col.len;
+                const std::string &val = pred.val.str_val;
+                filter_column(column, pred.op, [len, &val](const char *v) {
+                    return std::string_view(v, len).compare(val);
+                });
+            }
+        }
+        if (!row_conds_.empty()) {
+            size_t n = 0;
+            for (int slot_no : sel_) {
+                const char *data = scan_->get_slot_data(slot_no);
+                bool ok = true;
+                for (auto &cond : row_conds_) {
+                    if (!check_condition(cond, data)) {
+                        ok = false;
+                        break;
+                    }
+                }
+                if (ok) {
+                    sel_[n++] = slot_no;
+                }
+            }
+            sel_.resize(n);
+        }
+    }
+
+    // 保留sel_中该字段满足op的slot，cmp返回字段值与常量比较的结果
+    template <typename Cmp>
+    void filter_column(const RmColumnView &column, CompOp op, Cmp cmp) {
+        size_t n = 0;
+        for (int slot_no : sel_) {
+            if (eval_op(op, cmp(column.base + slot_no * column.stride))) {
+                sel_[n++] = slot_no;
+            }
+        }
+        sel_.resize(n);
+    }
+
+    // 当前页面上没有剩余的记录时，向后找到第一个有满足条件的记录的页面
+    void seek() {
+        while (sel_idx_ >= sel_.size() && !scan_->is_end()) {
+            if (scan_->next_page()) {
+                filter_page();
+            }
+        }
+    }
+
+    const char *record_data() {
+        int slot_no = sel_[sel_idx_];
+        if (!fh_->is_pax()) {
+            return scan_->get_slot_data(slot_no);
+        }
+        for (size_t idx : used_cols_) {
+            auto &col = cols_[idx];
+            RmColumnView column = scan_->get_column(col.offset, col.len);
+            memcpy(buf_.data() + col.offset, column.base + slot_no * column.stride, col.len);
+        }
+        return buf_.data();
+    }
 };
\ No newline at end of file
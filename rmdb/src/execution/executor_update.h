@@ -38,22 +38,22 @@ class UpdateExecutor : public AbstractExecutor {
         context_ = context;
     }
 
-    Value get_record_value(const RmRecord &record, const TabCol &col) {
+    Value get_record_value(const char *data, const TabCol &col) {
         Value val;
         auto col_meta = sm_manager_->db_.get_table(tab_name_).get_col(col.col_name)[0];
 
         val.type = col_meta.type;
         
         if (col_meta.type == TYPE_INT) {
-            val.set_int(*(int *)(record.data + col_meta.offset));
+            val.set_int(*(const int *)(data + col_meta.offset));
         } else if (col_meta.type == TYPE_FLOAT) {
-            val.set_float(*(float *)(record.data + col_meta.offset));
+            val.set_float(*(const float *)(data + col_meta.offset));
         } else if (col_meta.type == TYPE_STRING) {
             
             int offset = col_meta.offset;
             int len = col_meta.len;
 
-            val.set_str(std::string(record.data + offset, len));
+            val.set_str(std::string(data + offset, len));
         } 
         else {
             throw TypeNotExistsError();
@@ -63,14 +63,14 @@ class UpdateExecutor : public AbstractExecutor {
         return val;
     }
 
-    bool check_condition(const Condition &cond, const RmRecord &record){
-        Value left = get_record_value(record, cond.lhs_col);
+    bool check_condition(const Condition &cond, const char *data){
+        Value left = get_record_value(data, cond.lhs_col);
         Value right;
 
         if (cond.is_rhs_val) {
             right = cond.rhs_val;
         } else {
-            right = get_record_value(record, cond.rhs_col);
+            right = get_record_value(data, cond.rhs_col);
         }
         int flag = 0;
         if (left.type == TYPE_INT && right.type == TYPE_INT) {
@@ -130,10 +130,15 @@ class UpdateExecutor : public AbstractExecutor {
     }
     std::unique_ptr<RmRecord> Next() override {
         for(auto rid_:rids_){
-            auto record = fh_->get_record(rid_, context_);
+            // 先在缓冲池的页面上检查条件，只有需要修改的记录才复制出来
+            RmRecordView view = fh_->get_record_view(rid_, context_);
+            // slot已经为空(记录已被删除)时得到空的视图
+            if (!view) {
+                continue;
+            }
             bool is_valid = true;
-            for(auto cond:conds_){
-                if(!check_condition(cond,*record)){
+            for(auto &cond:conds_){
+                if(!check_condition(cond,view.data)){
                     is_valid = false;
                     break;
                 }
@@ -141,6 +146,8 @@ class UpdateExecutor : public AbstractExecutor {
             if(!is_valid){
                 continue;
             }
+            auto record = view.materialize();
+            view.guard.release();
             // 设置每个字段
             for (auto &set_clause : set_clauses_) {
                 auto col = set_clause.lhs;
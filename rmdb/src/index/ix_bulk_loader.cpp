@@ -0,0 +1,544 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_bulk_loader.h"
+
+#include <algorithm>
+#include <queue>
+
+// run文件的stdio缓冲区大小，读写都是顺序的
+static constexpr size_t RUN_IO_BUFFER_SIZE = 1 << 20;
+
+static int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+// num_entries个键值对平均分到每个最多装入cap个的结点中，前num_entries % num_nodes个结点多装一个
+static std::vector<int> split_evenly(int num_entries, int cap) {
+    int num_nodes = ceil_div(num_entries, cap);
+    int q = num_entries / num_nodes, r = num_entries % num_nodes;
+    std::vector<int> sizes(num_nodes, q);
+    for (int j = 0; j < r; j++) {
+        sizes[j]++;
+    }
+    return sizes;
+}
+
+namespace {
+
+/**
+ * 压缩的索引中贪心地划分一层结点：按顺序把key加入当前结点，加入后的格式(见ix_key_compress.h)按填充因子放不下时
+ * 开始新的结点。内部结点的第0个key不保存，不影响格式
+ */
+class CompressedPacker {
+   public:
+    CompressedPacker(const IxFileHdr &file_hdr, int fill_factor, bool is_leaf)
+        : file_hdr_(file_hdr), fill_factor_(fill_factor), is_leaf_(is_leaf), first_(file_hdr.col_tot_len_) {}
+
+    int count() const { return count_; }
+
+    /**
+     * @description: 把key加入当前结点，放不下时返回false且不修改当前结点，调用者调用start()后重新加入
+     */
+    bool add(const char *key) {
+        int key_len = file_hdr_.col_tot_len_;
+        int prefix = prefix_, end = end_;
+        bool stored = is_leaf_ || count_ > 0;
+        if (stored) {
+            prefix = has_stored_ ? std::min(prefix, ix_common_prefix(first_.data(), key, key_len)) : key_len;
+            end = std::max(end, ix_significant_len(key, key_len));
+        }
+        int prefix_len = std::min(prefix, end);
+        int cap = ix_compressed_capacity(file_hdr_, {prefix_len, end - prefix_len});
+        if (count_ > 0 && count_ + 1 > std::clamp(cap * fill_factor_ / 100, 3, cap)) {
+            return false;
+        }
+        if (stored && !has_stored_) {
+            memcpy(first_.data(), key, key_len);
+            has_stored_ = true;
+        }
+        prefix_ = prefix;
+        end_ = end;
+        count_++;
+        return true;
+    }
+
+    void start() {
+        count_ = 0;
+        prefix_ = end_ = 0;
+        has_stored_ = false;
+    }
+
+   private:
+    const IxFileHdr &file_hdr_;
+    int fill_factor_;
+    bool is_leaf_;
+    std::vector<char> first_;   // 第一个保存的key，有序的key的公共前缀即为与它的公共前缀
+    bool has_stored_ = false;
+    int count_ = 0;
+    int prefix_ = 0;            // 已保存的key的公共前缀长度
+    int end_ = 0;               // 已保存的key去掉末尾的0之后的最大长度
+};
+
+}  // namespace
+
+IxBulkLoader::IxBulkLoader(DiskManager *disk_manager, int fd, int fill_factor, size_t sort_mem)
+    : disk_manager_(disk_manager), fd_(fd), batch_(alloc_aligned_buffer(IX_BULK_LOAD_BATCH_PAGES * PAGE_SIZE)) {
+    assert(fill_factor > 0 && fill_factor <= 100);
+    fill_factor_ = fill_factor;
+    char *buf = new char[PAGE_SIZE];
+    memset(buf, 0, PAGE_SIZE);
+    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    file_hdr_.deserialize(buf);
+    delete[] buf;
+    // 只能加载到刚创建的空索引文件中
+    assert(file_hdr_.root_page_ == IX_INIT_ROOT_PAGE && file_hdr_.num_pages_ == IX_INIT_NUM_PAGES);
+    key_search_ = IxKeySearch(file_hdr_);
+
+    key_len_ = file_hdr_.col_tot_len_;
+    entry_len_ = key_len_ + static_cast<int>(sizeof(Rid));
+    // 结点中的键值对达到btree_order + 1时分裂，因此最多装入btree_order个；至少装入3个，保证每个内部结点至少有2个孩子
+    int order = file_hdr_.btree_order_;
+    leaf_cap_ = std::clamp(order * fill_factor / 100, 3, order);
+    inner_cap_ = leaf_cap_;
+    max_buffered_ = std::max<size_t>(1, sort_mem / entry_len_);
+}
+
+IxBulkLoader::~IxBulkLoader() {
+    for (FILE *run : runs_) {
+        fclose(run);
+    }
+}
+
+/**
+ * @description: 加入一个键值对，内存中缓存的键值对达到上限时写出一个run
+ */
+void IxBulkLoader::add(const char *key, const Rid &rid) {
+    if (buffer_.size() / entry_len_ >= max_buffered_) {
+        spill();
+    }
+    buffer_.insert(buffer_.end(), key, key + key_len_);
+    if (file_hdr_.compress_) {
+        // 压缩的索引按结点中的key格式排序和构建
+        char *stored = buffer_.data() + buffer_.size() - key_len_;
+        ix_encode_key(file_hdr_, stored, stored);
+    }
+    auto rid_bytes = reinterpret_cast<const char *>(&rid);
+    buffer_.insert(buffer_.end(), rid_bytes, rid_bytes + sizeof(Rid));
+}
+
+/**
+ * @description: 按(key, rid)比较两个键值对，key相同时rid小的在前
+ */
+bool IxBulkLoader::entry_less(const char *a, const char *b) const {
+    int res = key_search_.compare(a, b);
+    if (res != 0) {
+        return res < 0;
+    }
+    Rid ra, rb;
+    memcpy(&ra, a + key_len_, sizeof(Rid));
+    memcpy(&rb, b + key_len_, sizeof(Rid));
+    return ra.page_no < rb.page_no || (ra.page_no == rb.page_no && ra.slot_no < rb.slot_no);
+}
+
+/**
+ * @description: 对buffer_中的键值对排序并去掉重复的key，只排序指向键值对的指针
+ * @param {vector<char*>*} sorted 排好序的键值对，指向buffer_
+ */
+void IxBulkLoader::sort_buffer(std::vector<const char *> *sorted) const {
+    size_t n = buffer_.size() / entry_len_;
+    sorted->resize(n);
+    for (size_t i = 0; i < n; i++) {
+        (*sorted)[i] = buffer_.data() + i * entry_len_;
+    }
+    std::sort(sorted->begin(), sorted->end(), [this](const char *a, const char *b) { return entry_less(a, b); });
+    auto last = std::unique(sorted->begin(), sorted->end(),
+                            [this](const char *a, const char *b) { return key_search_.compare(a, b) == 0; });
+    sorted->erase(last, sorted->end());
+}
+
+/**
+ * @description: 把buffer_中的键值对排序后写到一个新的临时文件中
+ */
+void IxBulkLoader::spill() {
+    std::vector<const char *> sorted;
+    sort_buffer(&sorted);
+    FILE *run = std::tmpfile();
+    if (run == nullptr) {
+        throw UnixError();
+    }
+    runs_.push_back(run);
+    setvbuf(run, nullptr, _IOFBF, RUN_IO_BUFFER_SIZE);
+    for (const char *entry : sorted) {
+        if (fwrite(entry, entry_len_, 1, run) != 1) {
+            throw UnixError();
+        }
+    }
+    buffer_.clear();
+}
+
+/**
+ * @description: 多路归并所有run，跨run重复的key同样只保留rid最小的键值对
+ * @return {int} 写出的键值对数量
+ * @param {FILE*} out 归并结果
+ */
+int IxBulkLoader::merge_runs(FILE *out) {
+    size_t num_runs = runs_.size();
+    std::vector<std::vector<char>> heads(num_runs, std::vector<char>(entry_len_));
+    auto read_head = [&](size_t i) { return fread(heads[i].data(), entry_len_, 1, runs_[i]) == 1; };
+    // 小根堆，堆顶是各run当前键值对中最小的
+    auto greater = [&](size_t a, size_t b) { return entry_less(heads[b].data(), heads[a].data()); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+    for (size_t i = 0; i < num_runs; i++) {
+        rewind(runs_[i]);
+        if (read_head(i)) {
+            heap.push(i);
+        }
+    }
+    int num_entries = 0;
+    std::vector<char> last(entry_len_);
+    while (!heap.empty()) {
+        size_t i = heap.top();
+        heap.pop();
+        if (num_entries == 0 || key_search_.compare(last.data(), heads[i].data()) != 0) {
+            if (fwrite(heads[i].data(), entry_len_, 1, out) != 1) {
+                throw UnixError();
+            }
+            memcpy(last.data(), heads[i].data(), entry_len_);
+            num_entries++;
+        }
+        if (read_head(i)) {
+            heap.push(i);
+        }
+    }
+    return num_entries;
+}
+
+/**
+ * @description: 排序所有键值对并构建B+树，写出所有结点、叶子链表头和文件头。没有键值对时保持空树不变
+ * @return {int} 加载的键值对数量(不含重复的key)
+ */
+int IxBulkLoader::finish() {
+    if (runs_.empty()) {
+        // 所有键值对都在内存中，直接按排好序的指针构建
+        std::vector<const char *> sorted;
+        sort_buffer(&sorted);
+        size_t next = 0;
+        build(static_cast<int>(sorted.size()), [&]() { return sorted[next++]; }, [&]() { next = 0; });
+        return static_cast<int>(sorted.size());
+    }
+    // 键值对的数量需要在构建之前知道，因此先把所有run归并到一个文件中，再顺序读出
+    if (!buffer_.empty()) {
+        spill();
+    }
+    FILE *merged = std::tmpfile();
+    if (merged == nullptr) {
+        throw UnixError();
+    }
+    setvbuf(merged, nullptr, _IOFBF, RUN_IO_BUFFER_SIZE);
+    int num_entries;
+    try {
+        num_entries = merge_runs(merged);
+        rewind(merged);
+        std::vector<char> entry(entry_len_);
+        build(num_entries, [&]() {
+            if (fread(entry.data(), entry_len_, 1, merged) != 1) {
+                throw UnixError();
+            }
+            return entry.data();
+        }, [&]() { rewind(merged); });
+    } catch (...) {
+        fclose(merged);
+        throw;
+    }
+    fclose(merged);
+    return num_entries;
+}
+
+/**
+ * @description: 自底向上逐层构建B+树
+ * @param {int} num_entries 有序且不重复的键值对数量
+ * @param {function} next_entry 依次返回下一个键值对，返回的指针在下一次调用之前有效
+ * @param {function} restart 回到第一个键值对，压缩的索引需要先读一遍所有键值对划分叶结点
+ */
+void IxBulkLoader::build(int num_entries, const std::function<const char *()> &next_entry,
+                         const std::function<void()> &restart) {
+    if (num_entries == 0) {
+        return;
+    }
+    // 每层每个结点的键值对数量，第0层为叶结点，最后一层只有根结点
+    std::vector<std::vector<int>> level_sizes;
+    // 每层每个结点在父结点中的key，压缩的索引事先算出，否则在构建这一层时得到
+    std::vector<std::vector<char>> level_keys;
+    if (file_hdr_.compress_) {
+        plan_compressed(num_entries, next_entry, &level_sizes, &level_keys);
+        restart();
+    } else {
+        level_sizes.push_back(split_evenly(num_entries, leaf_cap_));
+        while (level_sizes.back().size() > 1) {
+            level_sizes.push_back(split_evenly(static_cast<int>(level_sizes.back().size()), inner_cap_));
+        }
+        level_keys.resize(level_sizes.size());
+    }
+    std::vector<page_id_t> level_start = {IX_INIT_ROOT_PAGE};
+    for (size_t k = 1; k < level_sizes.size(); k++) {
+        level_start.push_back(level_start[k - 1] + static_cast<int>(level_sizes[k - 1].size()));
+    }
+
+    for (size_t k = 0; k < level_sizes.size(); k++) {
+        bool is_leaf = k == 0;
+        bool is_root = k + 1 == level_sizes.size();
+        page_id_t parent_start = is_root ? IX_NO_PAGE : level_start[k + 1];
+        const std::vector<int> &parent_sizes = is_root ? std::vector<int>() : level_sizes[k + 1];
+        if (is_leaf) {
+            build_level(level_sizes[k], parent_start, parent_sizes, true,
+                        [&](Rid *rid) {
+                            const char *entry = next_entry();
+                            memcpy(rid, entry + key_len_, sizeof(Rid));
+                            return entry;
+                        },
+                        &level_keys[k]);
+        } else {
+            // 内部结点的键值对是下一层每个结点的key和页号
+            const std::vector<char> &child_keys = level_keys[k - 1];
+            int child = 0;
+            build_level(level_sizes[k], parent_start, parent_sizes, false,
+                        [&](Rid *rid) {
+                            *rid = Rid{.page_no = level_start[k - 1] + child, .slot_no = -1};
+                            return child_keys.data() + static_cast<size_t>(child++) * key_len_;
+                        },
+                        &level_keys[k]);
+        }
+    }
+    flush_pages();
+
+    page_id_t last_leaf = level_start[0] + static_cast<int>(level_sizes[0].size()) - 1;
+    {
+        // 叶子链表头的前一个/后一个叶子是最后一个/第一个叶结点
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        *reinterpret_cast<IxPageHdr *>(page_buf) = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = true,
+            .prev_leaf = last_leaf,
+            .next_leaf = IX_INIT_ROOT_PAGE,
+            .right_link = IX_NO_PAGE,
+        };
+        disk_manager_->write_page(fd_, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
+    }
+
+    file_hdr_.num_pages_ = level_start.back() + 1;
+    file_hdr_.root_page_ = level_start.back();
+    file_hdr_.first_leaf_ = IX_INIT_ROOT_PAGE;
+    file_hdr_.last_leaf_ = last_leaf;
+    char *data = new char[file_hdr_.tot_len_];
+    file_hdr_.serialize(data);
+    disk_manager_->write_page(fd_, IX_FILE_HDR_PAGE, data, file_hdr_.tot_len_);
+    delete[] data;
+    disk_manager_->set_fd2pageno(fd_, file_hdr_.num_pages_);
+}
+
+/**
+ * @description: 压缩的索引中每个结点能装入的键值对数量取决于其中key的格式，因此先读一遍所有键值对，
+ *              贪心地划分叶结点并记录相邻叶结点之间截断后的分隔key，再在内存中逐层划分内部结点。
+ *              每层最后一个结点不足半满时从前一个结点移入一些键值对
+ * @param {vector<vector<int>>*} level_sizes 传出每层每个结点的键值对数量
+ * @param {vector<vector<char>>*} level_keys 传出每层每个结点在父结点中的key
+ */
+void IxBulkLoader::plan_compressed(int num_entries, const std::function<const char *()> &next_entry,
+                                   std::vector<std::vector<int>> *level_sizes,
+                                   std::vector<std::vector<char>> *level_keys) {
+    int min_size = (file_hdr_.btree_order_ + 1) / 2;
+    std::vector<int> sizes;
+    std::vector<char> keys;
+    auto push_key = [&](std::vector<char> *out, const char *key) { out->insert(out->end(), key, key + key_len_); };
+
+    // 叶结点：只保留前一个和当前结点中的key，用于最后一个结点不足半满时重新确定二者之间的分隔key
+    CompressedPacker leaf_packer(file_hdr_, fill_factor_, true);
+    std::vector<char> prev_node, cur_node;
+    for (int i = 0; i < num_entries; i++) {
+        const char *key = next_entry();
+        if (i == 0) {
+            push_key(&keys, key);
+        } else if (!leaf_packer.add(key)) {
+            sizes.push_back(leaf_packer.count());
+            keys.resize(keys.size() + key_len_);
+            ix_shortest_separator(cur_node.data() + cur_node.size() - key_len_, key, key_len_,
+                                  keys.data() + keys.size() - key_len_);
+            prev_node.swap(cur_node);
+            cur_node.clear();
+            leaf_packer.start();
+        }
+        if (leaf_packer.count() == 0) {
+            leaf_packer.add(key);
+        }
+        push_key(&cur_node, key);
+    }
+    sizes.push_back(leaf_packer.count());
+    size_t m = sizes.size();
+    if (m >= 2 && sizes[m - 1] < min_size && sizes[m - 2] + sizes[m - 1] >= 2 * min_size) {
+        int split = sizes[m - 2] - (min_size - sizes[m - 1]);
+        const char *right = prev_node.data() + static_cast<size_t>(split) * key_len_;
+        ix_shortest_separator(right - key_len_, right, key_len_, keys.data() + (m - 1) * key_len_);
+        sizes[m - 2] = split;
+        sizes[m - 1] = min_size;
+    }
+    level_sizes->push_back(std::move(sizes));
+    level_keys->push_back(std::move(keys));
+
+    // 内部结点：键值对是下一层每个结点的key，结点的key即其第一个孩子的key
+    while (level_sizes->back().size() > 1) {
+        const std::vector<char> &child_keys = level_keys->back();
+        int num_children = static_cast<int>(level_sizes->back().size());
+        CompressedPacker packer(file_hdr_, fill_factor_, false);
+        sizes.clear();
+        keys.clear();
+        std::vector<int> starts;
+        for (int i = 0; i < num_children; i++) {
+            const char *key = child_keys.data() + static_cast<size_t>(i) * key_len_;
+            if (i > 0 && !packer.add(key)) {
+                sizes.push_back(packer.count());
+                packer.start();
+            }
+            if (packer.count() == 0) {
+                starts.push_back(i);
+                packer.add(key);
+            }
+        }
+        sizes.push_back(packer.count());
+        m = sizes.size();
+        if (m >= 2 && sizes[m - 1] < min_size && sizes[m - 2] + sizes[m - 1] >= 2 * min_size) {
+            sizes[m - 2] -= min_size - sizes[m - 1];
+            sizes[m - 1] = min_size;
+            starts[m - 1] = num_children - min_size;
+        }
+        for (int start : starts) {
+            push_key(&keys, child_keys.data() + static_cast<size_t>(start) * key_len_);
+        }
+        level_sizes->push_back(sizes);
+        level_keys->push_back(keys);
+    }
+}
+
+/**
+ * @description: 构建一层结点，结点的页号连续。除了只有一个结点的根结点以外，每个结点都至少装了一半左右
+ * @param {vector<int>&} sizes 这一层每个结点的键值对数量
+ * @param {page_id_t} parent_start 上一层第一个结点的页号，这一层是根结点时为IX_NO_PAGE
+ * @param {vector<int>&} parent_sizes 上一层每个结点的孩子数量
+ * @param {bool} is_leaf 是否为叶结点
+ * @param {function} next_entry 依次返回下一个键值对的key，rid作为传出参数
+ * @param {vector<char>*} node_keys 每个结点在父结点中的key，B-link树中即前一个结点的high key；
+ *                                  压缩的索引中事先算出，否则在这里填入每个结点的第一个key
+ */
+void IxBulkLoader::build_level(const std::vector<int> &sizes, page_id_t parent_start,
+                               const std::vector<int> &parent_sizes, bool is_leaf,
+                               const std::function<const char *(Rid *)> &next_entry, std::vector<char> *node_keys) {
+    int num_nodes = static_cast<int>(sizes.size());
+    bool compress = file_hdr_.compress_;
+    if (!compress) {
+        node_keys->resize(static_cast<size_t>(num_nodes) * key_len_);
+    }
+    // 压缩的结点先收集所有键值对，再以最紧凑的格式写入
+    std::vector<char> entry_keys;
+    std::vector<Rid> entry_rids;
+    page_id_t start = batch_start_ + batch_size_;
+    prev_node_ = nullptr;
+    int parent = 0, parent_children = 0;
+    for (int j = 0; j < num_nodes; j++) {
+        page_id_t page_no = start + j;
+        int size = sizes[j];
+        Rid rid;
+        const char *key = next_entry(&rid);
+        char *node_key = node_keys->data() + static_cast<size_t>(j) * key_len_;
+        if (!compress) {
+            memcpy(node_key, key, key_len_);
+        }
+        if (file_hdr_.blink_ && prev_node_ != nullptr) {
+            // 上一个结点的high key就是这个结点在父结点中的key
+            char *high_key = compress ? prev_node_ + sizeof(IxPageHdr)
+                                      : prev_node_ + sizeof(IxPageHdr) + file_hdr_.keys_size_ - key_len_;
+            memcpy(high_key, node_key, key_len_);
+        }
+
+        if (!parent_sizes.empty() && parent_children == parent_sizes[parent]) {
+            parent++;
+            parent_children = 0;
+        }
+        parent_children++;
+        char *page = new_page(page_no);
+        *reinterpret_cast<IxPageHdr *>(page) = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = parent_sizes.empty() ? IX_NO_PAGE : parent_start + parent,
+            .num_key = size,
+            .is_leaf = is_leaf,
+            .prev_leaf = is_leaf ? (j == 0 ? IX_LEAF_HEADER_PAGE : page_no - 1) : IX_NO_PAGE,
+            .next_leaf = is_leaf ? (j == num_nodes - 1 ? IX_LEAF_HEADER_PAGE : page_no + 1) : IX_NO_PAGE,
+            .right_link = file_hdr_.blink_ && j < num_nodes - 1 ? page_no + 1 : IX_NO_PAGE,
+        };
+        if (compress) {
+            entry_keys.resize(static_cast<size_t>(size) * key_len_);
+            entry_rids.resize(size);
+            for (int i = 0; i < size; i++) {
+                if (i > 0) {
+                    key = next_entry(&rid);
+                }
+                memcpy(entry_keys.data() + static_cast<size_t>(i) * key_len_, key, key_len_);
+                entry_rids[i] = rid;
+            }
+            bool packed = ix_pack_node(page, file_hdr_, entry_keys.data(), entry_rids.data(), size);
+            assert(packed);
+            (void)packed;
+        } else {
+            char *keys = page + sizeof(IxPageHdr);
+            char *rids = keys + file_hdr_.keys_size_;
+            for (int i = 0; i < size; i++) {
+                if (i > 0) {
+                    key = next_entry(&rid);
+                }
+                memcpy(keys + static_cast<size_t>(i) * key_len_, key, key_len_);
+                memcpy(rids + static_cast<size_t>(i) * sizeof(Rid), &rid, sizeof(Rid));
+            }
+        }
+        prev_node_ = page;
+    }
+}
+
+/**
+ * @description: 在当前批次中取出页号为page_no的页面并清零，批次已满时先写出
+ */
+char *IxBulkLoader::new_page(page_id_t page_no) {
+    if (batch_size_ == IX_BULK_LOAD_BATCH_PAGES) {
+        flush_pages();
+    }
+    if (batch_size_ == 0) {
+        batch_start_ = page_no;
+    }
+    assert(page_no == batch_start_ + batch_size_);
+    char *page = batch_.get() + static_cast<size_t>(batch_size_++) * PAGE_SIZE;
+    memset(page, 0, PAGE_SIZE);
+    return page;
+}
+
+/**
+ * @description: 把当前批次中的连续页面一次写出
+ */
+void IxBulkLoader::flush_pages() {
+    if (batch_size_ == 0) {
+        return;
+    }
+    std::vector<const char *> bufs(batch_size_);
+    for (int i = 0; i < batch_size_; i++) {
+        bufs[i] = batch_.get() + static_cast<size_t>(i) * PAGE_SIZE;
+    }
+    disk_manager_->write_pages(fd_, batch_start_, bufs.data(), batch_size_);
+    batch_start_ += batch_size_;
+    batch_size_ = 0;
+    prev_node_ = nullptr;
+}
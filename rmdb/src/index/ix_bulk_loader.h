@@ -0,0 +1,93 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "ix_defs.h"
+#include "ix_key_compress.h"
+#include "ix_key_search.h"
+#include "storage/disk_manager.h"
+
+/**
+ * 自底向上地批量构建B+树，用于在已有数据的表上创建索引，代替逐条insert_entry。
+ * add()收集(key, rid)，超过内存预算时把这一批排序后写到临时文件中成为一个run，finish()时多路归并所有run；
+ * 有序的键值对按填充因子依次装满叶结点，再由每个结点的第一个key逐层构建内部结点。
+ * 每层的结点数在构建之前就能算出，所以所有结点的页号(叶结点从IX_INIT_ROOT_PAGE开始，逐层向上，根结点最后)、
+ * parent以及叶子链表都是确定的，每个页面只写一次，按页号顺序成批地通过DiskManager写出，不经过缓冲池。
+ * B-link树的结点同时填好right_link和high key。与insert_entry相同，重复的key只保留rid最小的键值对。
+ * 压缩的索引(IxFileHdr::compress_)中结点的容量取决于key的格式，先读一遍有序的键值对贪心地划分叶结点，
+ * 叶结点之间的分隔key截断为最短前缀，各层的划分都确定之后再读一遍写出结点。
+ * 用法：IxManager::create_index创建空的索引文件之后打开文件，add()所有键值对再finish()，之后才能open_index
+ */
+class IxBulkLoader {
+   public:
+    /**
+     * @param fd 刚创建的空索引文件
+     * @param fill_factor 结点装入btree_order的百分之多少个键值对，留出的空位使之后的插入不会立即分裂
+     * @param sort_mem 内存中排序的键值对最多占用的字节数
+     */
+    IxBulkLoader(DiskManager *disk_manager, int fd, int fill_factor = IX_BULK_LOAD_FILL_FACTOR,
+                 size_t sort_mem = IX_BULK_LOAD_SORT_MEM);
+
+    ~IxBulkLoader();
+
+    IxBulkLoader(const IxBulkLoader &) = delete;
+    IxBulkLoader &operator=(const IxBulkLoader &) = delete;
+
+    void add(const char *key, const Rid &rid);
+
+    int finish();
+
+    // 已经写到临时文件中的run数量
+    size_t num_runs() const { return runs_.size(); }
+
+   private:
+    bool entry_less(const char *a, const char *b) const;
+
+    void sort_buffer(std::vector<const char *> *sorted) const;
+
+    void spill();
+
+    int merge_runs(FILE *out);
+
+    void build(int num_entries, const std::function<const char *()> &next_entry, const std::function<void()> &restart);
+
+    void plan_compressed(int num_entries, const std::function<const char *()> &next_entry,
+                         std::vector<std::vector<int>> *level_sizes, std::vector<std::vector<char>> *level_keys);
+
+    void build_level(const std::vector<int> &sizes, page_id_t parent_start, const std::vector<int> &parent_sizes,
+                     bool is_leaf, const std::function<const char *(Rid *)> &next_entry, std::vector<char> *node_keys);
+
+    char *new_page(page_id_t page_no);
+
+    void flush_pages();
+
+    DiskManager *disk_manager_;
+    int fd_;
+    IxFileHdr file_hdr_;
+    IxKeySearch key_search_;
+    int fill_factor_;
+    int key_len_;                       // col_tot_len
+    int entry_len_;                     // 每个键值对为key后接Rid
+    int leaf_cap_;                      // 每个叶结点最多装入的键值对数量
+    int inner_cap_;                     // 每个内部结点最多装入的孩子数量
+    size_t max_buffered_;               // 内存中最多缓存的键值对数量
+    std::vector<char> buffer_;          // 尚未排序的键值对
+    std::vector<FILE *> runs_;          // 排好序的run，临时文件在关闭时自动删除
+
+    AlignedBuffer batch_;               // 待写出的连续页面
+    page_id_t batch_start_ = IX_INIT_ROOT_PAGE;
+    int batch_size_ = 0;
+    char *prev_node_ = nullptr;         // 同一层的上一个结点，B-link树中等待填入high key，所在的批次写出后置为nullptr
+};
@@ -22,6 +22,12 @@ constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
 
+// 索引文件的格式版本，记录在IxFileHdr末尾。IxPageHdr随right_link、prefix_len/key_width的加入而变大，
+// 没有版本号的旧文件中结点的格式与当前不同，打开时拒绝而不是按当前格式误读
+constexpr int IX_LAYOUT_VERSION_NONE = 0;       // 文件头中没有版本号
+constexpr int IX_LAYOUT_VERSION_PREFIX = 1;     // IxPageHdr带有right_link、prefix_len和key_width
+constexpr int IX_LAYOUT_VERSION = IX_LAYOUT_VERSION_PREFIX;
+
 class IxFileHdr {
 public: 
     page_id_t first_free_page_no_;      // 文件中第一个空闲的磁盘页面的页面号
@@ -36,6 +42,13 @@ public:
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    bool blink_ = false;                // 是否为B-link树(Lehman-Yao)：结点带right_link和high key，分裂不需要自上而下地加锁
+    // 是否压缩结点中的key(见ix_key_compress.h)：key按memcmp保序的格式存放，结点只保存公共前缀和各key不同的部分，
+    // 每个结点的格式记录在IxPageHdr中，此时keys_size_不再使用
+    bool compress_ = false;
+    // 页面是否带有校验和，创建时确定；旧的索引文件为false，btree_order_也没有为校验和留出空间
+    bool page_checksums_ = false;
+    int layout_version_ = IX_LAYOUT_VERSION;    // 索引文件的格式版本，见IX_LAYOUT_VERSION
     int tot_len_;                       // 记录结构体的整体长度
 
     IxFileHdr() {
@@ -43,15 +56,17 @@ public:
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
-                int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
+                int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf, bool blink = false,
+                bool compress = false, bool page_checksums = false)
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
-                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
+                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf),
+                blink_(blink), compress_(compress), page_checksums_(page_checksums) {
                     tot_len_ = 0;
                 } 
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 7 + sizeof(bool) * 3;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -85,6 +100,14 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &blink_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &compress_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &page_checksums_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &layout_version_, sizeof(int));
+        offset += sizeof(int);
         assert(offset == tot_len_);
     }
 
@@ -123,6 +146,18 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        // 末尾的选项是后来加入的，旧的文件头中没有，保持默认值
+        for (bool *option : {&blink_, &compress_, &page_checksums_}) {
+            if (offset < tot_len_) {
+                *option = *reinterpret_cast<const bool*>(src + offset);
+                offset += sizeof(bool);
+            }
+        }
+        layout_version_ = IX_LAYOUT_VERSION_NONE;
+        if (offset < tot_len_) {
+            layout_version_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+        }
         assert(offset == tot_len_);
     }
 };
@@ -135,6 +170,12 @@ public:
     bool is_leaf;                   // 是否为叶节点
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+    // B-link树中同一层右兄弟的页号，最右的结点为IX_NO_PAGE；此时结点的keys区域末尾还存放high key，
+    // 即该结点中所有key的上界(不含)，查找的key不小于high key时沿right_link向右移动
+    page_id_t right_link;
+    // 压缩的结点(IxFileHdr::compress_)中所有key共同的前缀长度，以及每个key在前缀之后保存的字节数
+    uint16_t prefix_len;
+    uint16_t key_width;
 };
 
 class Iid {
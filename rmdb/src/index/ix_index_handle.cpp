@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#include <thread>  // NOLINT
+
 #include "ix_scan.h"
 
 /**
@@ -19,25 +21,63 @@ See the Mulan PSL v2 for more details. */
  * @note 返回key index（同时也是rid index），作为slot no
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    if (file_hdr->compress_) {
+        return compressed_search(target, 0, false);
+    }
+    return key_search->lower_bound(keys, 0, page_hdr->num_key, target);
 }
 
 /**
  * @brief 在当前node中查找第一个>target的key_idx
  *
- * @return key_idx，范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
- * @note 注意此处的范围从1开始
+ * @param begin 从第begin个key开始查找，内部结点的第0个key不参与查找，叶结点传入0
+ * @return key_idx，范围为[begin,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
+ * @note 注意此处的范围默认从1开始
  */
-int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
+int IxNodeHandle::upper_bound(const char *target, int begin) const {
+    begin = std::min(begin, page_hdr->num_key);
+    if (file_hdr->compress_) {
+        return compressed_search(target, begin, true);
+    }
+    return key_search->upper_bound(keys, begin, page_hdr->num_key, target);
+}
 
-    return -1;
+/**
+ * @brief 压缩的结点中二分查找：先比较公共前缀，再逐个比较key_width字节的后缀，
+ * target在后缀之后还有非0字节时大于后缀相同的key
+ *
+ * @param upper 为false时查找第一个>=target的key，为true时查找第一个>target的key
+ */
+int IxNodeHandle::compressed_search(const char *target, int begin, bool upper) const {
+    int size = page_hdr->num_key;
+    if (overflow_) {
+        return upper ? key_search->upper_bound(overflow_keys_.data(), begin, size, target)
+                     : key_search->lower_bound(overflow_keys_.data(), begin, size, target);
+    }
+    if (begin >= size) {
+        return begin;
+    }
+    assert(begin >= first_stored());
+    int prefix_len = page_hdr->prefix_len;
+    int key_width = page_hdr->key_width;
+    int res = memcmp(target, keys, prefix_len);
+    if (res != 0) {
+        return res < 0 ? begin : size;
+    }
+    const char *suffix = target + prefix_len;
+    bool tail = ix_significant_len(target, file_hdr->col_tot_len_) > prefix_len + key_width;
+    // pred为true的key都排在答案之前：lower_bound为key < target，upper_bound为key <= target
+    int lo = begin, hi = size;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = memcmp(slot(mid), suffix, key_width);
+        if (cmp < 0 || (cmp == 0 && (upper || tail))) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
 /**
@@ -49,13 +89,12 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
-
-    return false;
+    int pos = lower_bound(key);
+    if (pos == get_size() || key_search->compare(get_key(pos), key) != 0) {
+        return false;
+    }
+    *value = get_rid(pos);
+    return true;
 }
 
 /**
@@ -64,12 +103,8 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
-
-    return -1;
+    // 第i个key是第i个孩子中最小的key，目标key位于最后一个不大于它的key对应的孩子中
+    return value_at(upper_bound(key) - 1);
 }
 
 /**
@@ -85,14 +120,46 @@ page_id_t IxNodeHandle::internal_lookup(const char *key) {
  *                           /        \
  *       [0,pos)     [pos,pos+n)   [pos+n,num_key+n)
  *                      key           key_slot
+ * 压缩的结点中key符合当前格式且放得下时原地插入，否则解码所有键值对后按新的格式重新写入，放不下时进入overflow_状态；
+ * 内部结点在位置0插入时原来的第0个key没有保存，移到位置1之后由调用者set_key
  */
 void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-
+    int size = get_size();
+    int key_len = file_hdr->col_tot_len_;
+    if (file_hdr->compress_) {
+        assert(pos >= 0 && pos <= size);
+        bool in_place = !overflow_ && pos >= first_stored() && size + n <= get_max_size();
+        for (int i = 0; in_place && i < n; i++) {
+            in_place = fits(key + i * key_len);
+        }
+        if (!in_place) {
+            std::vector<char> all_keys;
+            std::vector<Rid> all_rids;
+            decode_all(&all_keys, &all_rids);
+            all_keys.insert(all_keys.begin() + static_cast<size_t>(pos) * key_len, key,
+                            key + static_cast<size_t>(n) * key_len);
+            all_rids.insert(all_rids.begin() + pos, rid, rid + n);
+            encode_all(std::move(all_keys), std::move(all_rids));
+            return;
+        }
+        int prefix_len = page_hdr->prefix_len;
+        int key_width = page_hdr->key_width;
+        Rid *node_rids = compressed_rids();
+        memmove(slot(pos + n), slot(pos), static_cast<size_t>(size - pos) * key_width);
+        for (int i = 0; i < n; i++) {
+            memcpy(slot(pos + i), key + i * key_len + prefix_len, key_width);
+        }
+        memmove(node_rids + pos + n, node_rids + pos, static_cast<size_t>(size - pos) * sizeof(Rid));
+        memcpy(node_rids + pos, rid, static_cast<size_t>(n) * sizeof(Rid));
+        page_hdr->num_key = size + n;
+        return;
+    }
+    assert(pos >= 0 && pos <= size && size + n <= get_max_size());
+    memmove(get_key(pos + n), get_key(pos), static_cast<size_t>(size - pos) * key_len);
+    memcpy(get_key(pos), key, static_cast<size_t>(n) * key_len);
+    memmove(get_rid(pos + n), get_rid(pos), static_cast<size_t>(size - pos) * sizeof(Rid));
+    memcpy(get_rid(pos), rid, static_cast<size_t>(n) * sizeof(Rid));
+    set_size(size + n);
 }
 
 /**
@@ -103,13 +170,34 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * @return int 键值对数量
  */
 int IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
+    int pos = lower_bound(key);
+    if (pos < get_size() && key_search->compare(get_key(pos), key) == 0) {
+        return get_size();
+    }
+    insert_pair(pos, key, value);
+    return get_size();
+}
 
-    return -1;
+/**
+ * @brief 叶结点插入key之后是否仍不需要分裂。压缩的结点按插入后的格式估计容量，估计偏保守
+ */
+bool IxNodeHandle::can_insert(const char *key) {
+    int size = get_size();
+    if (!file_hdr->compress_ || fits(key)) {
+        return size + 1 < get_max_size();
+    }
+    if (overflow_) {
+        return false;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    int prefix_len = page_hdr->prefix_len;
+    int end = prefix_len + page_hdr->key_width;
+    if (size > first_stored()) {
+        prefix_len = ix_common_prefix(key, keys, prefix_len);
+    }
+    end = std::max(end, ix_significant_len(key, key_len));
+    prefix_len = std::min(prefix_len, end);
+    return size + 1 < ix_compressed_capacity(*file_hdr, {prefix_len, end - prefix_len});
 }
 
 /**
@@ -118,11 +206,34 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos < size);
+    if (file_hdr->compress_ && !overflow_) {
+        // 删除key不会使格式失效，原地删除；内部结点删除第0个键值对时，第1个key成为不保存的第0个key
+        int from = std::max(pos, first_stored());
+        if (from < size) {
+            memmove(slot(from), slot(from + 1), static_cast<size_t>(size - from - 1) * page_hdr->key_width);
+        }
+        Rid *node_rids = compressed_rids();
+        memmove(node_rids + pos, node_rids + pos + 1, static_cast<size_t>(size - pos - 1) * sizeof(Rid));
+        page_hdr->num_key = size - 1;
+        return;
+    }
+    if (overflow_) {
+        std::vector<char> all_keys;
+        std::vector<Rid> all_rids;
+        decode_all(&all_keys, &all_rids);
+        int key_len = file_hdr->col_tot_len_;
+        all_keys.erase(all_keys.begin() + static_cast<size_t>(pos) * key_len,
+                       all_keys.begin() + static_cast<size_t>(pos + 1) * key_len);
+        all_rids.erase(all_rids.begin() + pos);
+        encode_all(std::move(all_keys), std::move(all_rids));
+        return;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    memmove(get_key(pos), get_key(pos + 1), static_cast<size_t>(size - pos - 1) * key_len);
+    memmove(get_rid(pos), get_rid(pos + 1), static_cast<size_t>(size - pos - 1) * sizeof(Rid));
+    set_size(size - 1);
 }
 
 /**
@@ -132,46 +243,318 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量
  */
 int IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
+    int pos = lower_bound(key);
+    if (pos < get_size() && key_search->compare(get_key(pos), key) == 0) {
+        erase_pair(pos);
+    }
+    return get_size();
+}
+
+/**
+ * @brief 截断为前size个键值对。压缩的结点按截断后最紧凑的格式重新写入页面，结束overflow_状态
+ */
+void IxNodeHandle::set_size(int size) {
+    if (!file_hdr->compress_) {
+        page_hdr->num_key = size;
+        return;
+    }
+    std::vector<char> all_keys;
+    std::vector<Rid> all_rids;
+    decode_all(&all_keys, &all_rids);
+    all_keys.resize(static_cast<size_t>(size) * file_hdr->col_tot_len_);
+    all_rids.resize(size);
+    encode_all(std::move(all_keys), std::move(all_rids));
+}
+
+/**
+ * @brief 修改第key_idx个key。压缩的内部结点不保存第0个key；key不符合当前格式时重新写入，调用者需先检查can_set_key
+ */
+void IxNodeHandle::set_key(int key_idx, const char *key) {
+    int key_len = file_hdr->col_tot_len_;
+    if (!file_hdr->compress_) {
+        memcpy(keys + key_idx * key_len, key, key_len);
+        return;
+    }
+    if (key_idx < first_stored()) {
+        return;
+    }
+    if (!overflow_ && fits(key)) {
+        memcpy(slot(key_idx), key + page_hdr->prefix_len, page_hdr->key_width);
+        return;
+    }
+    std::vector<char> all_keys;
+    std::vector<Rid> all_rids;
+    decode_all(&all_keys, &all_rids);
+    memcpy(all_keys.data() + static_cast<size_t>(key_idx) * key_len, key, key_len);
+    encode_all(std::move(all_keys), std::move(all_rids));
+    assert(!overflow_);
+}
+
+bool IxNodeHandle::can_set_key(int key_idx, const char *key) {
+    if (!file_hdr->compress_ || key_idx < first_stored() || (!overflow_ && fits(key))) {
+        return true;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    std::vector<char> all_keys;
+    std::vector<Rid> all_rids;
+    decode_all(&all_keys, &all_rids);
+    memcpy(all_keys.data() + static_cast<size_t>(key_idx) * key_len, key, key_len);
+    IxKeyLayout new_layout = ix_key_layout(all_keys.data(), get_size(), first_stored(), key_len);
+    return get_size() <= ix_compressed_capacity(*file_hdr, new_layout);
+}
+
+/**
+ * @brief 压缩的结点：把第key_idx个key解码到key_buf_中，内部结点的第0个key解码为公共前缀补0
+ */
+char *IxNodeHandle::decode_key(int key_idx) const {
+    int key_len = file_hdr->col_tot_len_;
+    if (overflow_) {
+        memcpy(key_buf_, overflow_keys_.data() + static_cast<size_t>(key_idx) * key_len, key_len);
+        return key_buf_;
+    }
+    int prefix_len = page_hdr->prefix_len;
+    int key_width = page_hdr->key_width;
+    memcpy(key_buf_, keys, prefix_len);
+    if (key_idx >= first_stored()) {
+        memcpy(key_buf_ + prefix_len, slot(key_idx), key_width);
+    } else {
+        memset(key_buf_ + prefix_len, 0, key_width);
+    }
+    memset(key_buf_ + prefix_len + key_width, 0, key_len - prefix_len - key_width);
+    return key_buf_;
+}
+
+Rid *IxNodeHandle::compressed_rid(int rid_idx) const {
+    if (overflow_) {
+        return const_cast<Rid *>(&overflow_rids_[rid_idx]);
+    }
+    return compressed_rids() + rid_idx;
+}
+
+/**
+ * @brief 压缩的结点：key是否符合当前格式，即前缀相同且前缀之后key_width字节以外全为0
+ */
+bool IxNodeHandle::fits(const char *key) const {
+    int prefix_len = page_hdr->prefix_len;
+    return memcmp(key, keys, prefix_len) == 0 &&
+           ix_significant_len(key, file_hdr->col_tot_len_) <= prefix_len + page_hdr->key_width;
+}
 
-    return -1;
+/**
+ * @brief 取出结点中所有的键值对，压缩的结点中key解码为完整的格式
+ */
+void IxNodeHandle::decode_all(std::vector<char> *out_keys, std::vector<Rid> *out_rids) const {
+    int size = page_hdr->num_key;
+    int key_len = file_hdr->col_tot_len_;
+    out_keys->resize(static_cast<size_t>(size) * key_len);
+    out_rids->resize(size);
+    for (int i = 0; i < size; i++) {
+        memcpy(out_keys->data() + static_cast<size_t>(i) * key_len, get_key(i), key_len);
+    }
+    if (size > 0) {
+        memcpy(out_rids->data(), get_rid(0), static_cast<size_t>(size) * sizeof(Rid));
+    }
+}
+
+/**
+ * @brief 压缩的结点：按最紧凑的格式写入所有键值对，放不下时暂存在overflow_keys_/overflow_rids_中
+ */
+void IxNodeHandle::encode_all(std::vector<char> &&all_keys, std::vector<Rid> &&all_rids) {
+    int size = static_cast<int>(all_rids.size());
+    if (ix_pack_node(page->get_data(), *file_hdr, all_keys.data(), all_rids.data(), size)) {
+        overflow_ = false;
+        overflow_keys_.clear();
+        overflow_rids_.clear();
+    } else {
+        overflow_ = true;
+        overflow_keys_ = std::move(all_keys);
+        overflow_rids_ = std::move(all_rids);
+        page_hdr->num_key = size;
+    }
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
     char* buf = new char[PAGE_SIZE];
     memset(buf, 0, PAGE_SIZE);
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
-    
+    delete[] buf;
+    key_search_ = IxKeySearch(*file_hdr_);
+
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+}
+
+/**
+ * @brief 结点在执行operation之后是否一定不会分裂或合并，安全结点的祖先不会被修改，可以提前释放
+ *
+ * @param node 加了写锁的结点
+ * @param operation 要执行的操作
+ * @param is_root node是否为根结点
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, Operation operation, bool is_root) {
+    switch (operation) {
+        case Operation::INSERT:
+            // 压缩的结点插入一个key后格式可能变差，只有插入后不超过btree_order + 1个键值对时才一定放得下
+            return node->get_size() + 1 < std::min(node->get_max_size(), file_hdr_->btree_order_ + 1);
+        case Operation::DELETE:
+            if (is_root) {
+                // 根叶结点允许为空；根内部结点只剩一个孩子时才需要调整根结点
+                return node->is_leaf_page() || node->get_size() > 2;
+            }
+            return node->get_size() > node->get_min_size();
+        default:
+            return true;
+    }
 }
 
 /**
  * @brief 用于查找指定键所在的叶子结点
+ * 自上而下加读锁，拿到孩子结点的锁之后立即释放父结点(crabbing)；INSERT和DELETE是乐观下降，只在叶结点加写锁，
+ * 叶结点不安全时由调用者释放后调用find_leaf_pessimistic重新下降
+ *
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
  * @param transaction 事务参数，如果不需要则默认传入nullptr
- * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
+ * @param find_first 为true时忽略key，查找第一个叶结点
+ * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁，乐观下降总是会释放root_latch_
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                            Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+                                                            Transaction *transaction, bool find_first) const {
+    if (file_hdr_->blink_) {
+        return std::make_pair(blink_find_leaf(key, operation, nullptr, find_first), false);
+    }
+    // 结点是否为叶子在其生命周期内不会改变，可以在加锁之前读取
+    auto latch = [operation](IxNodeHandle *node) {
+        if (operation != Operation::FIND && node->is_leaf_page()) {
+            node->page->wlatch();
+        } else {
+            node->page->rlatch();
+        }
+    };
+    root_latch_.lock_shared();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    latch(node);
+    root_latch_.unlock_shared();
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(find_first ? node->value_at(0) : node->internal_lookup(key));
+        latch(child);
+        release_read(node);
+        node = child;
+    }
+    return std::make_pair(node, false);
+}
+
+/**
+ * @brief 悲观下降：独占root_latch_，从根结点开始自上而下加写锁，遇到安全结点时释放其所有祖先
+ * 返回时write_set->path的最后一个结点即为目标叶结点
+ *
+ * @param key 要查找的目标key值
+ * @param operation INSERT或DELETE
+ * @param write_set 记录持有的写锁，由调用者通过release_write_set释放
+ */
+void IxIndexHandle::find_leaf_pessimistic(const char *key, Operation operation, IxWriteSet *write_set) {
+    root_latch_.lock();
+    write_set->root_latched = true;
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    node->page->wlatch();
+    write_set->path.push_back(node);
+    if (is_safe(node, operation, true)) {
+        release_ancestors(write_set);
+    }
+    while (!node->is_leaf_page()) {
+        IxNodeHandle *child = fetch_node(node->internal_lookup(key));
+        child->page->wlatch();
+        write_set->path.push_back(child);
+        if (is_safe(child, operation, false)) {
+            release_ancestors(write_set);
+        }
+        node = child;
+    }
+}
 
-    return std::make_pair(nullptr, false);
+/**
+ * @brief path最后一个结点是安全结点，释放root_latch_和它的所有祖先；祖先没有被修改，不需要标记为脏页
+ */
+void IxIndexHandle::release_ancestors(IxWriteSet *write_set) {
+    if (write_set->root_latched) {
+        root_latch_.unlock();
+        write_set->root_latched = false;
+    }
+    auto &path = write_set->path;
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        path[i]->page->wunlatch();
+        buffer_pool_manager_->unpin_page(path[i]->get_page_id(), false);
+        delete path[i];
+    }
+    path.erase(path.begin(), path.end() - 1);
+}
+
+/**
+ * @brief 分裂或合并向node这一层传播之前调用，释放path中node以下的结点以及下面一层额外加锁的结点
+ */
+void IxIndexHandle::release_below(IxWriteSet *write_set, IxNodeHandle *node) {
+    auto &path = write_set->path;
+    auto it = std::find(path.begin(), path.end(), node);
+    assert(it != path.end());
+    std::vector<IxNodeHandle *> below(it + 1, path.end());
+    path.erase(it + 1, path.end());
+    below.insert(below.end(), write_set->others.begin(), write_set->others.end());
+    write_set->others.clear();
+    for (auto child : below) {
+        child->page->wunlatch();
+        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
+    }
+}
+
+/**
+ * @brief 释放悲观写操作持有的所有锁，并从缓冲池中删除合并掉的结点
+ */
+void IxIndexHandle::release_write_set(IxWriteSet *write_set) {
+    if (write_set->root_latched) {
+        root_latch_.unlock();
+        write_set->root_latched = false;
+    }
+    for (auto nodes : {&write_set->path, &write_set->others}) {
+        for (auto node : *nodes) {
+            node->page->wunlatch();
+            buffer_pool_manager_->unpin_page(node->get_page_id(), true);
+            delete node;
+        }
+        nodes->clear();
+    }
+    // 结点已从父结点中删除，除了仍停留在旧位置的叶子扫描外不会再被访问，扫描仍pin着的页面由缓冲池正常淘汰
+    for (page_id_t page_no : write_set->deleted) {
+        buffer_pool_manager_->delete_page(PageId{fd_, page_no});
+    }
+    write_set->deleted.clear();
+}
+
+/**
+ * @brief 释放加了读锁的结点
+ */
+void IxIndexHandle::release_read(IxNodeHandle *node) const {
+    node->page->runlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+    delete node;
+}
+
+/**
+ * @brief 在path中找到node的父结点。node不安全时其父结点一定仍被持有
+ */
+IxNodeHandle *IxIndexHandle::held_parent(IxWriteSet *write_set, IxNodeHandle *node) {
+    auto &path = write_set->path;
+    auto it = std::find(path.begin(), path.end(), node);
+    assert(it != path.end() && it != path.begin());
+    IxNodeHandle *parent = *(it - 1);
+    assert(parent->get_page_no() == node->get_parent_page_no());
+    return parent;
 }
 
 /**
@@ -183,31 +566,86 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-
-    return false;
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, key_buf);
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+    Rid *rid;
+    bool found = leaf->leaf_lookup(key, &rid);
+    if (found) {
+        result->push_back(*rid);
+    }
+    release_read(leaf);
+    return found;
 }
 
 /**
  * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
- * @param node 需要拆分的结点
- * @return 拆分得到的new_node
- * @note need to unpin the new node outside
- * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
- */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+ * @param node 需要拆分的结点，已加写锁
+ * @param write_set 新结点加写锁后放入write_set->others；B-link树传入nullptr，由调用者释放新结点
+ * @param[out] sep 要插入父结点的分隔key，即new_node的第一个key；压缩的索引中叶结点分裂时截断为最短的分隔key
+ * @return 拆分得到的new_node，已加写锁
+ */
+IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node, IxWriteSet *write_set, char *sep) {
+    IxNodeHandle *new_node = create_node();
+    // 新叶结点链入叶子链表后即可被扫描访问，先加写锁
+    new_node->page->wlatch();
+    if (write_set != nullptr) {
+        write_set->others.push_back(new_node);
+    }
+    *new_node->page_hdr = {
+        .next_free_page_no = IX_NO_PAGE,
+        .parent = node->get_parent_page_no(),
+        .num_key = 0,
+        .is_leaf = node->is_leaf_page(),
+        .prev_leaf = IX_NO_PAGE,
+        .next_leaf = IX_NO_PAGE,
+        .right_link = node->get_right_link(),
+    };
+    int size = node->get_size();
+    int mid = size / 2;
+    int key_len = file_hdr_->col_tot_len_;
+    if (file_hdr_->compress_) {
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        node->decode_all(&keys, &rids);
+        new_node->insert_pairs(0, keys.data() + static_cast<size_t>(mid) * key_len, rids.data() + mid, size - mid);
+        const char *first = keys.data() + static_cast<size_t>(mid) * key_len;
+        separator(node->is_leaf_page() ? first - key_len : nullptr, first, sep);
+    } else {
+        new_node->insert_pairs(0, node->get_key(mid), node->get_rid(mid), size - mid);
+        memcpy(sep, new_node->get_key(0), key_len);
+    }
+    node->set_size(mid);
+    if (file_hdr_->blink_) {
+        // 新结点继承node的右兄弟和high key，node的high key变为分隔key
+        if (node->get_right_link() != IX_NO_PAGE) {
+            new_node->set_high_key(node->get_high_key());
+        }
+        node->set_high_key(sep);
+        node->set_right_link(new_node->get_page_no());
+    }
 
-    return nullptr;
+    if (new_node->is_leaf_page()) {
+        // 右邻居的锁只在修改prev_leaf时短暂持有
+        IxNodeHandle *next = fetch_node(node->get_next_leaf());
+        next->page->wlatch();
+        new_node->set_prev_leaf(node->get_page_no());
+        new_node->set_next_leaf(next->get_page_no());
+        next->set_prev_leaf(new_node->get_page_no());
+        node->set_next_leaf(new_node->get_page_no());
+        next->page->wunlatch();
+        buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+        delete next;
+        if (new_node->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+            std::scoped_lock lock{hdr_latch_};
+            file_hdr_->last_leaf_ = new_node->get_page_no();
+        }
+    } else if (!file_hdr_->blink_) {
+        for (int i = 0; i < new_node->get_size(); i++) {
+            maintain_child(new_node, i);
+        }
+    }
+    return new_node;
 }
 
 /**
@@ -219,74 +657,185 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  *
  * @param (old_node, new_node) 原结点为old_node，old_node被分裂之后产生了新的右兄弟结点new_node
  * @param key 要插入parent的key
- * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
- * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
- * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
+ * @param write_set 悲观下降持有的写锁，old_node不安全，因此其父结点仍在write_set->path中
+ * @note 向父结点传播之后old_node和new_node的锁即被释放，调用者之后不能再访问它们
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
-                                     Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
+                                     IxWriteSet *write_set) {
+    if (old_node->is_root_page()) {
+        // 根结点不安全，悲观下降一直独占着root_latch_
+        assert(write_set->root_latched);
+        IxNodeHandle *root = create_node();
+        root->page->wlatch();
+        write_set->others.push_back(root);
+        *root->page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = false,
+            .prev_leaf = IX_NO_PAGE,
+            .next_leaf = IX_NO_PAGE,
+            .right_link = IX_NO_PAGE,
+        };
+        root->insert_pair(0, old_node->get_key(0), Rid{.page_no = old_node->get_page_no(), .slot_no = -1});
+        root->insert_pair(1, key, Rid{.page_no = new_node->get_page_no(), .slot_no = -1});
+        old_node->set_parent_page_no(root->get_page_no());
+        new_node->set_parent_page_no(root->get_page_no());
+        update_root_page_no(root->get_page_no());
+        return;
+    }
+
+    IxNodeHandle *parent = held_parent(write_set, old_node);
+    int pos = parent->find_child(old_node) + 1;
+    parent->insert_pair(pos, key, Rid{.page_no = new_node->get_page_no(), .slot_no = -1});
+    new_node->set_parent_page_no(parent->get_page_no());
+    release_below(write_set, parent);
+
+    if (parent->get_size() >= parent->get_max_size()) {
+        char sep[IX_MAX_COL_LEN];
+        IxNodeHandle *new_parent = split(parent, write_set, sep);
+        insert_into_parent(parent, sep, new_parent, write_set);
+    }
 }
 
 /**
  * @brief 将指定键值对插入到B+树中
+ * 先乐观下降，叶结点插入后不会分裂时只需要叶结点的写锁；否则从根结点开始悲观下降重新插入
+ *
  * @param (key, value) 要插入的键值对
  * @param transaction 事务指针
  * @return page_id_t 插入到的叶结点的page_no
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, key_buf);
+    if (file_hdr_->blink_) {
+        return blink_insert(key, value);
+    }
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::INSERT, transaction).first;
+    page_id_t page_no = leaf->get_page_no();
+    bool safe = leaf->can_insert(key);
+    bool inserted = false;
+    if (safe) {
+        int size = leaf->get_size();
+        inserted = leaf->insert(key, value) > size;
+    }
+    leaf->page->wunlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), inserted);
+    delete leaf;
+    if (safe) {
+        return page_no;
+    }
 
-    return -1;
+    IxWriteSet write_set;
+    find_leaf_pessimistic(key, Operation::INSERT, &write_set);
+    leaf = write_set.path.back();
+    page_no = leaf->get_page_no();
+    leaf->insert(key, value);
+    if (leaf->get_size() >= leaf->get_max_size()) {
+        char sep[IX_MAX_COL_LEN];
+        IxNodeHandle *new_leaf = split(leaf, &write_set, sep);
+        if (key_search_.compare(key, sep) >= 0) {
+            page_no = new_leaf->get_page_no();
+        }
+        insert_into_parent(leaf, sep, new_leaf, &write_set);
+    }
+    release_write_set(&write_set);
+    return page_no;
 }
 
 /**
  * @brief 用于删除B+树中含有指定key的键值对
+ * 先乐观下降，叶结点删除后不会下溢(或key不存在)时只需要叶结点的写锁；否则从根结点开始悲观下降重新删除
+ *
  * @param key 要删除的key值
  * @param transaction 事务指针
+ * @return 是否删除了键值对
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, key_buf);
+    if (file_hdr_->blink_) {
+        return blink_delete(key);
+    }
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::DELETE, transaction).first;
+    Rid *rid;
+    bool found = leaf->leaf_lookup(key, &rid);
+    bool safe = !found || is_safe(leaf, Operation::DELETE, false);
+    if (found && safe) {
+        leaf->remove(key);
+    }
+    leaf->page->wunlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), found && safe);
+    delete leaf;
+    if (safe) {
+        return found;
+    }
 
-    return false;
+    IxWriteSet write_set;
+    find_leaf_pessimistic(key, Operation::DELETE, &write_set);
+    leaf = write_set.path.back();
+    int size = leaf->get_size();
+    bool deleted = leaf->remove(key) < size;
+    if (deleted) {
+        coalesce_or_redistribute(leaf, &write_set);
+    }
+    while (write_set.retry) {
+        // 左兄弟叶结点被其他线程持有，key已经删除，释放所有锁后重新下降，再调整仍不足半满的叶结点
+        release_write_set(&write_set);
+        write_set.retry = false;
+        std::this_thread::yield();
+        find_leaf_pessimistic(key, Operation::DELETE, &write_set);
+        coalesce_or_redistribute(write_set.path.back(), &write_set);
+    }
+    release_write_set(&write_set);
+    return deleted;
 }
 
 /**
  * @brief 用于处理合并和重分配的逻辑，用于删除键值对后调用
  *
  * @param node 执行完删除操作的结点
- * @param transaction 事务指针
- * @param root_is_latched 传出参数：根节点是否上锁，用于并发操作
+ * @param write_set 悲观下降持有的写锁，node不安全，因此其父结点仍在write_set->path中
  * @return 是否需要删除结点
  * @note User needs to first find the sibling of input page.
  * If sibling's size + input page's size >= 2 * page's minsize, then redistribute.
  * Otherwise, merge(Coalesce).
  */
-bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
-
-    return false;
+bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, IxWriteSet *write_set) {
+    if (node->is_root_page()) {
+        return adjust_root(node, write_set);
+    }
+    if (node->get_size() >= node->get_min_size()) {
+        return false;
+    }
+    IxNodeHandle *parent = held_parent(write_set, node);
+    if (parent->get_size() < 2) {
+        // 压缩的索引中重分配可能因为父结点放不下新的分隔key而放弃，父结点可能只剩node一个孩子
+        return false;
+    }
+    int index = parent->find_child(node);
+    // 优先选取前驱结点；兄弟结点与node的父结点相同，持有父结点写锁时其他线程不会再进入兄弟结点的子树
+    IxNodeHandle *neighbor = fetch_node(parent->value_at(index > 0 ? index - 1 : index + 1));
+    if (index > 0 && node->is_leaf_page()) {
+        // 扫描持有叶结点时等待后继的锁，持有node时只能尝试获取左兄弟的锁，失败时由调用者释放所有锁后重试
+        if (!neighbor->page->try_wlatch()) {
+            buffer_pool_manager_->unpin_page(neighbor->get_page_id(), false);
+            delete neighbor;
+            write_set->retry = true;
+            return false;
+        }
+    } else {
+        neighbor->page->wlatch();
+    }
+    write_set->others.push_back(neighbor);
+    if (node->get_size() + neighbor->get_size() >= node->get_min_size() * 2) {
+        // 放弃重分配时node保持不足半满，之后删除时再尝试
+        redistribute(neighbor, node, parent, index, write_set);
+        return false;
+    }
+    coalesce(&neighbor, &node, &parent, index, write_set);
+    return true;
 }
 
 /**
@@ -294,14 +843,23 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @param old_root_node 原根节点
  * @return bool 根结点是否需要被删除
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
+ * 根叶结点变空时仍保留为根结点，B+树为空时root_page_仍指向一个空的叶结点
  */
-bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
-    // Todo:
-    // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    // 3. 除了上述两种情况，不需要进行操作
-
-    return false;
+bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node, IxWriteSet *write_set) {
+    if (old_root_node->is_leaf_page() || old_root_node->get_size() > 1) {
+        return false;
+    }
+    // 根结点不安全，悲观下降一直独占着root_latch_
+    assert(write_set->root_latched);
+    IxNodeHandle *child = fetch_node(old_root_node->remove_and_return_only_child());
+    child->page->wlatch();
+    child->set_parent_page_no(IX_NO_PAGE);
+    update_root_page_no(child->get_page_no());
+    child->page->wunlatch();
+    buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+    delete child;
+    release_node_handle(*old_root_node, write_set);
+    return true;
 }
 
 /**
@@ -313,17 +871,47 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
  * @param node input from method coalesceOrRedistribute()
  * @param parent the parent of "node" and "neighbor_node"
  * @param index node在parent中的rid_idx
+ * @return 是否进行了重分配。压缩的索引中父结点放不下新的分隔key时放弃，不修改任何结点
  * @note node是之前刚被删除过一个key的结点
  * index=0，则neighbor是node后继结点，表示：node(left)      neighbor(right)
  * index>0，则neighbor是node前驱结点，表示：neighbor(left)  node(right)
  * 注意更新parent结点的相关kv对
+ * 内部结点的第0个key不参与查找，移动时以父结点中的分隔key为准
  */
-void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩字结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
+bool IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index,
+                                 IxWriteSet *write_set) {
+    int key_len = file_hdr_->col_tot_len_;
+    char moved[IX_MAX_COL_LEN];
+    char sep[IX_MAX_COL_LEN];
+    if (index == 0) {
+        // neighbor的第一个键值对移到node末尾，neighbor原来的第1个key成为父结点中新的分隔key
+        memcpy(moved, node->is_leaf_page() ? neighbor_node->get_key(0) : parent->get_key(1), key_len);
+        separator(node->is_leaf_page() ? moved : nullptr, neighbor_node->get_key(1), sep);
+        if (!parent->can_set_key(1, sep)) {
+            return false;
+        }
+        node->insert_pair(node->get_size(), moved, *neighbor_node->get_rid(0));
+        neighbor_node->erase_pair(0);
+        parent->set_key(1, sep);
+        maintain_child(node, node->get_size() - 1);
+    } else {
+        // neighbor的最后一个键值对移到node开头，它的key成为父结点中新的分隔key
+        int last = neighbor_node->get_size() - 1;
+        memcpy(moved, neighbor_node->get_key(last), key_len);
+        separator(node->is_leaf_page() ? neighbor_node->get_key(last - 1) : nullptr, moved, sep);
+        if (!parent->can_set_key(index, sep)) {
+            return false;
+        }
+        node->insert_pair(0, moved, *neighbor_node->get_rid(last));
+        if (!node->is_leaf_page()) {
+            // node原来的第0个key移到了位置1，它应为父结点中原来的分隔key
+            node->set_key(1, parent->get_key(index));
+        }
+        neighbor_node->erase_pair(last);
+        parent->set_key(index, sep);
+        maintain_child(node, 0);
+    }
+    return true;
 }
 
 /**
@@ -341,14 +929,213 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  * @note Assume that *neighbor_node is the left sibling of *node (neighbor -> node)
  */
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
-                             Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
+                             IxWriteSet *write_set) {
+    if (index == 0) {
+        std::swap(*neighbor_node, *node);
+        index = 1;
+    }
+    IxNodeHandle *left = *neighbor_node;
+    IxNodeHandle *right = *node;
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    right->decode_all(&keys, &rids);
+    if (!right->is_leaf_page()) {
+        // 右结点的第0个key取父结点中的分隔key
+        memcpy(keys.data(), (*parent)->get_key(index), file_hdr_->col_tot_len_);
+    }
+    int left_size = left->get_size();
+    left->insert_pairs(left_size, keys.data(), rids.data(), right->get_size());
+    for (int i = left_size; i < left->get_size(); i++) {
+        maintain_child(left, i);
+    }
+    if (right->is_leaf_page()) {
+        erase_leaf(right);
+    }
+    release_node_handle(*right, write_set);
+    (*parent)->erase_pair(index);
+    release_below(write_set, *parent);
+    return coalesce_or_redistribute(*parent, write_set);
+}
+
+/**
+ * @brief B-link树的下降：每次只持有一个结点的锁，释放父结点之后再对孩子结点加锁。
+ * 结点在释放父结点之后可能被分裂，key已不在其范围内时沿right_link向右移动
+ *
+ * @param key 要查找的目标key值
+ * @param operation INSERT和DELETE对叶结点加写锁，FIND加读锁
+ * @param[out] stack 不为nullptr时记录每层最后访问的内部结点，用于分裂时找到父结点
+ * @param find_first 为true时忽略key，查找第一个叶结点
+ * @return 加了锁的叶结点
+ */
+IxNodeHandle *IxIndexHandle::blink_find_leaf(const char *key, Operation operation, std::vector<page_id_t> *stack,
+                                             bool find_first) const {
+    root_latch_.lock_shared();
+    page_id_t page_no = file_hdr_->root_page_;
+    root_latch_.unlock_shared();
+    while (true) {
+        IxNodeHandle *node = fetch_node(page_no);
+        bool exclusive = operation != Operation::FIND && node->is_leaf_page();
+        if (exclusive) {
+            node->page->wlatch();
+        } else {
+            node->page->rlatch();
+        }
+        if (!find_first) {
+            node = move_right(node, key, exclusive);
+        }
+        if (node->is_leaf_page()) {
+            return node;
+        }
+        if (stack != nullptr) {
+            stack->push_back(node->get_page_no());
+        }
+        page_no = find_first ? node->value_at(0) : node->internal_lookup(key);
+        release_read(node);
+    }
+}
+
+/**
+ * @brief 沿right_link向右移动，直到key位于结点的范围内。先对右兄弟加锁再释放当前结点
+ *
+ * @param node 加了锁的结点
+ * @param exclusive node加的是否为写锁，右兄弟加同样的锁
+ * @return 包含key的结点
+ */
+IxNodeHandle *IxIndexHandle::move_right(IxNodeHandle *node, const char *key, bool exclusive) const {
+    while (node->need_move_right(key)) {
+        IxNodeHandle *right = fetch_node(node->get_right_link());
+        if (exclusive) {
+            right->page->wlatch();
+            release_write(node, false);
+        } else {
+            right->page->rlatch();
+            release_read(node);
+        }
+        node = right;
+    }
+    return node;
+}
+
+/**
+ * @brief B-link树分裂时获取child的父结点的写锁，调用时持有child的写锁
+ * 父结点取自下降时记录的路径，它可能在此之后分裂过，因此再按key向右移动；
+ * 路径为空说明下降时child是根结点，若根结点此后已经分裂，则从新的根结点重新下降找到child的上一层
+ *
+ * @param child 刚分裂的结点
+ * @param key 要插入父结点的key，即child分裂出的新结点的第一个key
+ * @param stack 下降时记录的路径，取出的结点会被弹出
+ * @return 加了写锁的父结点；child仍是根结点时返回nullptr，此时root_latch_被独占，由调用者创建新的根结点后释放
+ */
+IxNodeHandle *IxIndexHandle::blink_lock_parent(IxNodeHandle *child, const char *key, std::vector<page_id_t> *stack) {
+    page_id_t page_no;
+    if (!stack->empty()) {
+        page_no = stack->back();
+        stack->pop_back();
+    } else {
+        root_latch_.lock();
+        if (file_hdr_->root_page_ == child->get_page_no()) {
+            return nullptr;
+        }
+        page_no = file_hdr_->root_page_;
+        root_latch_.unlock();
+        while (true) {
+            IxNodeHandle *node = fetch_node(page_no);
+            node->page->rlatch();
+            node = move_right(node, key, false);
+            assert(!node->is_leaf_page());
+            page_id_t child_page_no = node->internal_lookup(key);
+            if (child_page_no == child->get_page_no()) {
+                page_no = node->get_page_no();
+                release_read(node);
+                break;
+            }
+            page_no = child_page_no;
+            release_read(node);
+        }
+    }
+    IxNodeHandle *parent = fetch_node(page_no);
+    parent->page->wlatch();
+    return move_right(parent, key, true);
+}
+
+/**
+ * @brief 向B-link树中插入键值对。叶结点没有满时只需要叶结点的写锁；
+ * 分裂自下而上传播，持有孩子结点的写锁获取父结点的写锁，之后即可释放孩子结点
+ *
+ * @param (key, value) 要插入的键值对
+ * @return page_id_t 插入到的叶结点的page_no
+ */
+page_id_t IxIndexHandle::blink_insert(const char *key, const Rid &value) {
+    std::vector<page_id_t> stack;
+    IxNodeHandle *node = blink_find_leaf(key, Operation::INSERT, &stack, false);
+    page_id_t page_no = node->get_page_no();
+    int size = node->get_size();
+    if (node->insert(key, value) == size || node->get_size() < node->get_max_size()) {
+        release_write(node, node->get_size() > size);
+        return page_no;
+    }
 
-    return false;
+    std::vector<char> sep(file_hdr_->col_tot_len_);
+    while (node->get_size() >= node->get_max_size()) {
+        IxNodeHandle *new_node = split(node, nullptr, sep.data());
+        page_id_t new_page_no = new_node->get_page_no();
+        if (new_node->is_leaf_page() && key_search_.compare(key, sep.data()) >= 0) {
+            page_no = new_page_no;
+        }
+        IxNodeHandle *parent = blink_lock_parent(node, sep.data(), &stack);
+        if (parent == nullptr) {
+            // node仍是根结点，新的根结点在root_latch_释放之前不会被其他线程访问
+            IxNodeHandle *root = create_node();
+            *root->page_hdr = {
+                .next_free_page_no = IX_NO_PAGE,
+                .parent = IX_NO_PAGE,
+                .num_key = 0,
+                .is_leaf = false,
+                .prev_leaf = IX_NO_PAGE,
+                .next_leaf = IX_NO_PAGE,
+                .right_link = IX_NO_PAGE,
+            };
+            root->insert_pair(0, node->get_key(0), Rid{.page_no = node->get_page_no(), .slot_no = -1});
+            root->insert_pair(1, sep.data(), Rid{.page_no = new_page_no, .slot_no = -1});
+            update_root_page_no(root->get_page_no());
+            root_latch_.unlock();
+            buffer_pool_manager_->unpin_page(root->get_page_id(), true);
+            delete root;
+            release_write(new_node, true);
+            release_write(node, true);
+            return page_no;
+        }
+        int pos = parent->find_child(node) + 1;
+        release_write(new_node, true);
+        release_write(node, true);
+        parent->insert_pair(pos, sep.data(), Rid{.page_no = new_page_no, .slot_no = -1});
+        node = parent;
+    }
+    release_write(node, true);
+    return page_no;
+}
+
+/**
+ * @brief 从B-link树中删除键值对，只修改叶结点，不合并结点
+ *
+ * @param key 要删除的key值
+ * @return 是否删除了键值对
+ */
+bool IxIndexHandle::blink_delete(const char *key) {
+    IxNodeHandle *leaf = blink_find_leaf(key, Operation::DELETE, nullptr, false);
+    int size = leaf->get_size();
+    bool deleted = leaf->remove(key) < size;
+    release_write(leaf, deleted);
+    return deleted;
+}
+
+/**
+ * @brief 释放加了写锁的结点
+ */
+void IxIndexHandle::release_write(IxNodeHandle *node, bool is_dirty) const {
+    node->page->wunlatch();
+    buffer_pool_manager_->unpin_page(node->get_page_id(), is_dirty);
+    delete node;
 }
 
 /**
@@ -362,11 +1149,14 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
     IxNodeHandle *node = fetch_node(iid.page_no);
+    node->page->rlatch();
     if (iid.slot_no >= node->get_size()) {
+        release_read(node);
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    Rid rid = *node->get_rid(iid.slot_no);
+    release_read(node);
+    return rid;
 }
 
 /**
@@ -378,8 +1168,10 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-
-    return Iid{-1, -1};
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, key_buf);
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    return leaf_iid(leaf, leaf->lower_bound(key), key, false);
 }
 
 /**
@@ -389,8 +1181,11 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    return Iid{-1, -1};
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, key_buf);
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    // 叶结点的第0个key也参与比较
+    return leaf_iid(leaf, leaf->upper_bound(key, 0), key, true);
 }
 
 /**
@@ -400,9 +1195,15 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    page_id_t last_leaf;
+    {
+        std::scoped_lock lock{hdr_latch_};
+        last_leaf = file_hdr_->last_leaf_;
+    }
+    IxNodeHandle *node = fetch_node(last_leaf);
+    node->page->rlatch();
+    Iid iid = {.page_no = last_leaf, .slot_no = node->get_size()};
+    release_read(node);
     return iid;
 }
 
@@ -413,10 +1214,87 @@ Iid IxIndexHandle::leaf_end() const {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_begin() const {
-    Iid iid = {.page_no = file_hdr_->first_leaf_, .slot_no = 0};
+    IxNodeHandle *leaf = fetch_node(file_hdr_->first_leaf_);
+    leaf->page->rlatch();
+    return leaf_iid(leaf, 0, nullptr, false);
+}
+
+/**
+ * @brief 把叶结点中的位置转换为Iid，位于叶结点末尾时指向后面第一个非空叶结点的开头，
+ * 最后一个叶结点的末尾即leaf_end()。B-link树删除时不合并结点，叶子链表中可能有空的叶结点。
+ * 没能获取后继的锁时按key从根结点重新定位：释放leaf之后其他线程可能把后继的键值对移入leaf或合并掉leaf
+ *
+ * @param leaf 加了读锁的叶结点，返回前释放
+ * @param pos 键值对在leaf中的位置
+ * @param key 结点中格式的key，pos是leaf中第一个大于(upper为false时不小于)key的位置；为nullptr时pos是第一个叶结点的开头
+ * @return Iid
+ */
+Iid IxIndexHandle::leaf_iid(IxNodeHandle *leaf, int pos, const char *key, bool upper) const {
+    while (pos == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        IxNodeHandle *next = latch_next_leaf(leaf);
+        if (next != nullptr) {
+            leaf = next;
+            pos = 0;
+            continue;
+        }
+        leaf = find_leaf_page(key, Operation::FIND, nullptr, key == nullptr).first;
+        if (key == nullptr) {
+            pos = 0;
+        } else {
+            pos = upper ? leaf->upper_bound(key, 0) : leaf->lower_bound(key);
+        }
+    }
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = pos};
+    release_read(leaf);
     return iid;
 }
 
+/**
+ * @brief 从叶结点leaf移动到叶子链表中的后继。持有leaf时只尝试对后继加读锁，不会与持有后继、
+ * 等待左兄弟的删除操作死锁；失败时释放leaf，等持有后继的写操作完成后返回nullptr，由调用者重新定位
+ *
+ * @param leaf 加了读锁的叶结点，返回前释放
+ * @return 加了读锁的后继，或nullptr
+ */
+IxNodeHandle *IxIndexHandle::latch_next_leaf(IxNodeHandle *leaf) const {
+    IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
+    bool latched = next->page->try_rlatch();
+    release_read(leaf);
+    if (latched) {
+        return next;
+    }
+    next->page->rlatch();
+    release_read(next);
+    return nullptr;
+}
+
+/**
+ * @brief 压缩的索引把上层传入的key转换为结点中保存的格式，否则原样返回
+ *
+ * @param buf 转换结果的缓冲区，至少col_tot_len字节
+ */
+const char *IxIndexHandle::encode_key(const char *key, char *buf) const {
+    if (!file_hdr_->compress_) {
+        return key;
+    }
+    ix_encode_key(*file_hdr_, key, buf);
+    return buf;
+}
+
+/**
+ * @brief 相邻两个叶结点之间的分隔key，压缩的索引中截断为最短的分隔key，否则为右结点的第一个key
+ *
+ * @param left 左结点的最后一个key，内部结点传入nullptr
+ * @param right 右结点的第一个key
+ */
+void IxIndexHandle::separator(const char *left, const char *right, char *sep) const {
+    if (file_hdr_->compress_ && left != nullptr) {
+        ix_shortest_separator(left, right, file_hdr_->col_tot_len_, sep);
+    } else {
+        memcpy(sep, right, file_hdr_->col_tot_len_);
+    }
+}
+
 /**
  * @brief 获取一个指定结点
  *
@@ -426,7 +1304,7 @@ Iid IxIndexHandle::leaf_begin() const {
  */
 IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
     Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
-    IxNodeHandle *node = new IxNodeHandle(file_hdr_, page);
+    IxNodeHandle *node = new IxNodeHandle(file_hdr_, &key_search_, page);
     
     return node;
 }
@@ -443,12 +1321,15 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
  */
 IxNodeHandle *IxIndexHandle::create_node() {
     IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+    {
+        std::scoped_lock lock{hdr_latch_};
+        file_hdr_->num_pages_++;
+    }
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     Page *page = buffer_pool_manager_->new_page(&new_page_id);
-    node = new IxNodeHandle(file_hdr_, page);
+    node = new IxNodeHandle(file_hdr_, &key_search_, page);
     return node;
 }
 
@@ -478,6 +1359,7 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
 
 /**
  * @brief 要删除leaf之前调用此函数，更新leaf前驱结点的next指针和后继结点的prev指针
+ * leaf是合并中的右结点，其前驱是同一父结点下已加写锁的左结点；后继的锁只在修改prev_leaf时短暂持有
  *
  * @param leaf 要删除的leaf
  */
@@ -487,30 +1369,44 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
     buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
 
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
+    next->page->wlatch();
     next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
+    next->page->wunlatch();
     buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
+
+    if (leaf->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+        std::scoped_lock lock{hdr_latch_};
+        file_hdr_->last_leaf_ = leaf->get_prev_leaf();
+    }
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时调用，node的锁释放后再从缓冲池中删除
+ * 页号不回收，file_hdr_.num_pages始终是已分配页号的上界，重新打开索引时据此设置fd2pageno
  *
  * @param node
  */
-void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
-    file_hdr_->num_pages_--;
+void IxIndexHandle::release_node_handle(IxNodeHandle &node, IxWriteSet *write_set) {
+    write_set->deleted.push_back(node.get_page_no());
 }
 
 /**
  * @brief 将node的第child_idx个孩子结点的父节点置为node
+ * 调用时下面各层的锁已经释放，孩子结点需要重新加写锁
  */
 void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
     if (!node->is_leaf_page()) {
         //  Current node is inner node, load its child and set its parent to current node
         int child_page_no = node->value_at(child_idx);
         IxNodeHandle *child = fetch_node(child_page_no);
+        child->page->wlatch();
         child->set_parent_page_no(node->get_page_no());
+        child->page->wunlatch();
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        delete child;
     }
-}
\ No newline at end of file
+}
@@ -10,7 +10,11 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "ix_defs.h"
+#include "ix_key_compress.h"
+#include "ix_key_search.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
@@ -46,34 +50,51 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
-/* 管理B+树中的每个节点 */
+/* 管理B+树中的每个节点
+ * file_hdr->compress_为true时结点按ix_key_compress.h中的格式压缩存放，get_key()把key解码到key_buf_中返回；
+ * 插入后当前格式放不下时，键值对暂存在overflow_keys_/overflow_rids_中，get_max_size()等于get_size()，
+ * 调用者随后必须split该结点，set_size()截断后重新写回页面 */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
+    const IxKeySearch *key_search;  // 结点内key的比较与查找，由IxIndexHandle在打开索引时按key格式选定
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
     char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
+                                    // 压缩的结点中指向公共前缀
+    Rid *rids;                      // page->data的第三部分，指针指向首地址；压缩的结点中随格式变化，由compressed_rids()计算
+
+    bool overflow_ = false;             // 压缩的结点插入后放不下，等待分裂
+    std::vector<char> overflow_keys_;
+    std::vector<Rid> overflow_rids_;
+    mutable char key_buf_[IX_MAX_COL_LEN];  // 压缩的结点中get_key()返回的解码后的key，下一次get_key()或修改结点后失效
 
    public:
     IxNodeHandle() = default;
 
-    IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
+    IxNodeHandle(const IxFileHdr *file_hdr_, const IxKeySearch *key_search_, Page *page_)
+        : file_hdr(file_hdr_), key_search(key_search_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        if (file_hdr->compress_) {
+            keys = page->get_data() + ix_compressed_offset(*file_hdr);
+            rids = nullptr;
+        } else {
+            keys = page->get_data() + sizeof(IxPageHdr);
+            rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        }
     }
 
     int get_size() { return page_hdr->num_key; }
 
-    void set_size(int size) { page_hdr->num_key = size; }
+    void set_size(int size);
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    // 键值对数量达到max_size时必须分裂
+    int get_max_size() { return file_hdr->compress_ ? compressed_max_size() : file_hdr->btree_order_ + 1; }
 
-    int get_min_size() { return get_max_size() / 2; }
+    int get_min_size() { return (file_hdr->btree_order_ + 1) / 2; }
 
     int key_at(int i) { return *(int *)get_key(i); }
 
@@ -100,20 +121,47 @@ class IxNodeHandle {
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    page_id_t get_right_link() { return page_hdr->right_link; }
+
+    void set_right_link(page_id_t page_no) { page_hdr->right_link = page_no; }
+
+    /* B-link树的high key存放在keys区域的末尾(压缩的结点中紧跟页头)，只在right_link有效时有意义 */
+    char *get_high_key() const {
+        if (file_hdr->compress_) {
+            return page->get_data() + sizeof(IxPageHdr);
+        }
+        return keys + file_hdr->keys_size_ - file_hdr->col_tot_len_;
+    }
+
+    void set_high_key(const char *key) { memcpy(get_high_key(), key, file_hdr->col_tot_len_); }
+
+    /* key不小于high key时不在本结点的范围内(结点在此之前分裂过)，需要沿right_link向右移动 */
+    bool need_move_right(const char *key) const {
+        return page_hdr->right_link != IX_NO_PAGE && key_search->compare(key, get_high_key()) >= 0;
+    }
+
+    char *get_key(int key_idx) const {
+        return file_hdr->compress_ ? decode_key(key_idx) : keys + key_idx * file_hdr->col_tot_len_;
+    }
+
+    Rid *get_rid(int rid_idx) const { return file_hdr->compress_ ? compressed_rid(rid_idx) : &rids[rid_idx]; }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    void set_key(int key_idx, const char *key);
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    // 压缩的结点set_key之后是否仍能放下
+    bool can_set_key(int key_idx, const char *key);
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
 
     int lower_bound(const char *target) const;
 
-    int upper_bound(const char *target) const;
+    int upper_bound(const char *target, int begin = 1) const;
 
     void insert_pairs(int pos, const char *key, const Rid *rid, int n);
 
+    // 插入key之后是否不需要分裂
+    bool can_insert(const char *key);
+
     page_id_t internal_lookup(const char *key);
 
     bool leaf_lookup(const char *key, Rid **value);
@@ -155,9 +203,60 @@ class IxNodeHandle {
         assert(rid_idx < page_hdr->num_key);
         return rid_idx;
     }
+
+   private:
+    // 压缩的结点
+    int first_stored() const { return page_hdr->is_leaf ? 0 : 1; }
+
+    IxKeyLayout layout() const { return {page_hdr->prefix_len, page_hdr->key_width}; }
+
+    char *slot(int key_idx) const { return keys + page_hdr->prefix_len + (key_idx - first_stored()) * page_hdr->key_width; }
+
+    Rid *compressed_rids() const {
+        return reinterpret_cast<Rid *>(keys + page_hdr->prefix_len +
+                                       ix_compressed_capacity(*file_hdr, layout()) * page_hdr->key_width);
+    }
+
+    int compressed_max_size() const {
+        return overflow_ ? page_hdr->num_key : ix_compressed_capacity(*file_hdr, layout());
+    }
+
+    char *decode_key(int key_idx) const;
+
+    Rid *compressed_rid(int rid_idx) const;
+
+    bool fits(const char *key) const;
+
+    int compressed_search(const char *target, int begin, bool upper) const;
+
+    void decode_all(std::vector<char> *out_keys, std::vector<Rid> *out_rids) const;
+
+    void encode_all(std::vector<char> &&all_keys, std::vector<Rid> &&all_rids);
 };
 
-/* B+树 */
+/* 一次悲观写操作(可能分裂或合并结点)在B+树上持有的写锁 */
+struct IxWriteSet {
+    bool root_latched = false;            // 是否仍独占root_latch_，只有可能修改root_page_时才保留
+    std::vector<IxNodeHandle *> path;     // 从上到下加了写锁的结点；安全结点之上的祖先已被提前释放
+    std::vector<IxNodeHandle *> others;   // 当前层额外加了写锁的结点：分裂出的新结点、合并/重分配的兄弟结点
+    std::vector<page_id_t> deleted;       // 合并后被删除的结点，释放写锁后再从缓冲池中删除
+    bool retry = false;                   // 没能获取左兄弟叶结点的锁而放弃了调整，需要释放所有锁后重新下降
+};
+
+/* B+树
+ * 并发控制采用latch crabbing：结点页面的读写锁为Page::rwlatch_，root_latch_保护根结点的页号。
+ * 查找自上而下加读锁，拿到孩子的锁后立即释放父结点；插入和删除先以同样的方式乐观下降，只在叶结点加写锁，
+ * 叶结点不会分裂或合并时直接修改；否则释放所有锁，从根结点开始悲观地加写锁重新下降，
+ * 遇到不会分裂或合并的安全结点时释放其所有祖先。
+ * 分裂或合并向上一层传播之前，先释放下面各层的锁，因此等待兄弟结点或孩子结点的锁时不会持有叶结点。
+ * 同一层的叶结点之间只允许自左向右等待锁：扫描持有当前叶结点时只尝试对后继加锁，失败时释放当前叶结点，
+ * 等后继的锁释放后按key重新下降；删除时持有叶结点只尝试对左兄弟加锁，失败时释放所有锁重新下降再调整。
+ * file_hdr_->blink_为true时是B-link树(Lehman-Yao)：每层结点通过right_link串联并带有high key，
+ * 下降时每次只持有一个结点的锁，与分裂并发时沿right_link向右移动即可；插入只对叶结点加写锁，
+ * 分裂时持有孩子结点的写锁再获取父结点(由下降时记录的路径得到)的写锁，加锁顺序为自下而上、同层自左向右。
+ * B-link树删除键值对时不合并结点，也不维护结点的parent。
+ * file_hdr_->compress_为true时结点中的key是压缩的(见ix_key_compress.h)，公有接口传入的key先由encode_key转换格式，
+ * find_leaf_page等内部函数使用的都是转换后的key */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
@@ -167,7 +266,9 @@ class IxIndexHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    IxKeySearch key_search_;                    // 按file_hdr_中的key格式选定的比较器，所有结点共用
+    mutable std::shared_mutex root_latch_;      // 保护file_hdr_->root_page_，读者和乐观写者共享持有，可能修改根结点的悲观写者独占持有
+    mutable std::mutex hdr_latch_;              // 保护file_hdr_中的num_pages_和last_leaf_
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -176,26 +277,27 @@ class IxIndexHandle {
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
     std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                 bool find_first = false);
+                                                 bool find_first = false) const;
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    IxNodeHandle *split(IxNodeHandle *node, IxWriteSet *write_set, char *sep);
 
-    void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
+    void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, IxWriteSet *write_set);
 
     // for delete
     bool delete_entry(const char *key, Transaction *transaction);
 
-    bool coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction = nullptr,
-                                bool *root_is_latched = nullptr);
-    bool adjust_root(IxNodeHandle *old_root_node);
+    bool coalesce_or_redistribute(IxNodeHandle *node, IxWriteSet *write_set);
+
+    bool adjust_root(IxNodeHandle *old_root_node, IxWriteSet *write_set);
 
-    void redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
+    bool redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index,
+                      IxWriteSet *write_set);
 
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
-                  Transaction *transaction, bool *root_is_latched);
+                  IxWriteSet *write_set);
 
     Iid lower_bound(const char *key);
 
@@ -211,6 +313,44 @@ class IxIndexHandle {
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    // for key compression
+    const char *encode_key(const char *key, char *buf) const;
+
+    void separator(const char *left, const char *right, char *sep) const;
+
+    // for latch crabbing
+    bool is_safe(IxNodeHandle *node, Operation operation, bool is_root);
+
+    void find_leaf_pessimistic(const char *key, Operation operation, IxWriteSet *write_set);
+
+    void release_ancestors(IxWriteSet *write_set);
+
+    void release_write_set(IxWriteSet *write_set);
+
+    void release_read(IxNodeHandle *node) const;
+
+    void release_below(IxWriteSet *write_set, IxNodeHandle *node);
+
+    IxNodeHandle *held_parent(IxWriteSet *write_set, IxNodeHandle *node);
+
+    // for B-link tree
+    IxNodeHandle *blink_find_leaf(const char *key, Operation operation, std::vector<page_id_t> *stack,
+                                  bool find_first) const;
+
+    IxNodeHandle *move_right(IxNodeHandle *node, const char *key, bool exclusive) const;
+
+    IxNodeHandle *blink_lock_parent(IxNodeHandle *child, const char *key, std::vector<page_id_t> *stack);
+
+    page_id_t blink_insert(const char *key, const Rid &value);
+
+    bool blink_delete(const char *key);
+
+    void release_write(IxNodeHandle *node, bool is_dirty) const;
+
+    Iid leaf_iid(IxNodeHandle *leaf, int pos, const char *key, bool upper) const;
+
+    IxNodeHandle *latch_next_leaf(IxNodeHandle *leaf) const;
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
@@ -221,10 +361,10 @@ class IxIndexHandle {
 
     void erase_leaf(IxNodeHandle *leaf);
 
-    void release_node_handle(IxNodeHandle &node);
+    void release_node_handle(IxNodeHandle &node, IxWriteSet *write_set);
 
     void maintain_child(IxNodeHandle *node, int child_idx);
 
     // for index test
     Rid get_rid(const Iid &iid) const;
-};
\ No newline at end of file
+};
@@ -0,0 +1,125 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+#include "ix_key_compress.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 按大端写出，memcmp的顺序即为无符号整数的顺序
+void store_big_endian(uint32_t v, char *out) {
+    for (int i = 3; i >= 0; i--) {
+        out[i] = static_cast<char>(v & 0xff);
+        v >>= 8;
+    }
+}
+
+}  // namespace
+
+void ix_encode_key(const IxFileHdr &file_hdr, const char *key, char *out) {
+    int offset = 0;
+    for (int i = 0; i < file_hdr.col_num_; i++) {
+        int len = file_hdr.col_lens_[i];
+        uint32_t bits;
+        switch (file_hdr.col_types_[i]) {
+            case TYPE_INT:
+                // 翻转符号位后负数排在正数之前
+                memcpy(&bits, key + offset, sizeof(bits));
+                store_big_endian(bits ^ 0x80000000u, out + offset);
+                break;
+            case TYPE_FLOAT: {
+                float f;
+                memcpy(&f, key + offset, sizeof(f));
+                if (f == 0.0f) {
+                    f = 0.0f;  // -0.0与0.0相等
+                }
+                memcpy(&bits, &f, sizeof(bits));
+                // 负数翻转所有位(绝对值越大越小)，非负数只翻转符号位
+                store_big_endian((bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u, out + offset);
+                break;
+            }
+            default:
+                memmove(out + offset, key + offset, len);
+                break;
+        }
+        offset += len;
+    }
+}
+
+int ix_common_prefix(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+int ix_significant_len(const char *key, int len) {
+    while (len > 0 && key[len - 1] == 0) {
+        len--;
+    }
+    return len;
+}
+
+void ix_shortest_separator(const char *left, const char *right, int len, char *sep) {
+    int n = ix_common_prefix(left, right, len) + 1;
+    assert(n <= len);
+    memcpy(sep, right, n);
+    memset(sep + n, 0, len - n);
+}
+
+IxKeyLayout ix_key_layout(const char *keys, int n, int first, int key_len) {
+    if (n <= first) {
+        return {0, 0};
+    }
+    const char *lo = keys + static_cast<size_t>(first) * key_len;
+    const char *hi = keys + static_cast<size_t>(n - 1) * key_len;
+    // 有序的key共同的前缀就是第一个和最后一个key的公共前缀
+    int prefix_len = ix_common_prefix(lo, hi, key_len);
+    int end = 0;
+    for (int i = first; i < n; i++) {
+        end = std::max(end, ix_significant_len(keys + static_cast<size_t>(i) * key_len, key_len));
+    }
+    // 前缀末尾的0同样不需要保存
+    prefix_len = std::min(prefix_len, end);
+    return {prefix_len, end - prefix_len};
+}
+
+int ix_compressed_capacity(const IxFileHdr &file_hdr, const IxKeyLayout &layout) {
+    int space = static_cast<int>(Page::OFFSET_CHECKSUM - ix_compressed_offset(file_hdr)) - layout.prefix_len;
+    int max_entries = 2 * (file_hdr.btree_order_ + 1) - 1;
+    return std::min(max_entries, space / (layout.key_width + static_cast<int>(sizeof(Rid))));
+}
+
+bool ix_pack_node(char *page_data, const IxFileHdr &file_hdr, const char *keys, const Rid *rids, int n) {
+    auto page_hdr = reinterpret_cast<IxPageHdr *>(page_data);
+    int key_len = file_hdr.col_tot_len_;
+    int first = page_hdr->is_leaf ? 0 : 1;
+    IxKeyLayout layout = ix_key_layout(keys, n, first, key_len);
+    int capacity = ix_compressed_capacity(file_hdr, layout);
+    if (n > capacity) {
+        return false;
+    }
+    char *prefix = page_data + ix_compressed_offset(file_hdr);
+    char *slots = prefix + layout.prefix_len;
+    if (n > first) {
+        memcpy(prefix, keys + static_cast<size_t>(first) * key_len, layout.prefix_len);
+    }
+    for (int i = first; i < n; i++) {
+        memcpy(slots + static_cast<size_t>(i - first) * layout.key_width,
+               keys + static_cast<size_t>(i) * key_len + layout.prefix_len, layout.key_width);
+    }
+    memcpy(slots + static_cast<size_t>(capacity) * layout.key_width, rids, static_cast<size_t>(n) * sizeof(Rid));
+    page_hdr->num_key = n;
+    page_hdr->prefix_len = static_cast<uint16_t>(layout.prefix_len);
+    page_hdr->key_width = static_cast<uint16_t>(layout.key_width);
+    return true;
+}
@@ -0,0 +1,69 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+#pragma once
+
+#include "ix_defs.h"
+
+/**
+ * B+树结点内key的压缩，IxFileHdr::compress_为true的索引使用。
+ * 上层传入的key先由ix_encode_key转换为可以直接memcmp比较的格式：INT按大端存放并翻转符号位，FLOAT按IEEE 754的
+ * 位模式做同样的保序变换，CHAR不变。这样结点中有序的key共享的前缀只需保存一次(prefix compression)，
+ * 每个key末尾全为0的部分(CHAR字段的填充)也不保存，即每个key只保存[prefix_len, prefix_len + key_width)这一段，
+ * 解码时补上前缀并用0填充。叶结点分裂时，父结点中的分隔key只保留区分左右两个结点所需的最短前缀(suffix truncation)。
+ *
+ * 压缩的结点格式：| IxPageHdr | high key(B-link树) | prefix | key_width * capacity | Rid * capacity |
+ * prefix_len和key_width记录在IxPageHdr中，capacity由二者算出，最多为2 * (btree_order + 1) - 1个键值对，
+ * 保证放不下的结点分裂后每一半都不超过btree_order + 1个，任何格式下都能放下。内部结点的第0个key不参与查找，不保存
+ */
+
+/* 压缩的结点中key的格式 */
+struct IxKeyLayout {
+    int prefix_len;     // 所有key共同的前缀长度
+    int key_width;      // 每个key在前缀之后保存的字节数，其后全为0
+};
+
+/* 压缩的结点中prefix在页面中的偏移，B-link树的high key放在它之前 */
+inline size_t ix_compressed_offset(const IxFileHdr &file_hdr) {
+    return sizeof(IxPageHdr) + (file_hdr.blink_ ? file_hdr.col_tot_len_ : 0);
+}
+
+/**
+ * @description: 把上层传入的key转换为memcmp保序的格式
+ * @param {char*} key 按字段类型存放的key，长度为col_tot_len
+ * @param {char*} out 转换后的key，可以与key相同
+ */
+void ix_encode_key(const IxFileHdr &file_hdr, const char *key, char *out);
+
+/** @description: a和b的最长公共前缀的长度 */
+int ix_common_prefix(const char *a, const char *b, int len);
+
+/** @description: 去掉末尾的0之后key的长度 */
+int ix_significant_len(const char *key, int len);
+
+/**
+ * @description: 满足left < sep <= right的最短的分隔key：right的前ix_common_prefix(left, right) + 1个字节，其余补0
+ * @param {char*} left 左结点的最后一个key
+ * @param {char*} right 右结点的第一个key，必须大于left
+ */
+void ix_shortest_separator(const char *left, const char *right, int len, char *sep);
+
+/** @description: keys[first, n)按memcmp有序，求能保存所有key的最紧凑的格式 */
+IxKeyLayout ix_key_layout(const char *keys, int n, int first, int key_len);
+
+/** @description: 格式为layout的压缩结点最多能保存的键值对数量 */
+int ix_compressed_capacity(const IxFileHdr &file_hdr, const IxKeyLayout &layout);
+
+/**
+ * @description: 以最紧凑的格式把n个键值对写入压缩的结点，设置页头的num_key、prefix_len和key_width
+ * @return {bool} 放不下时返回false，不修改页面
+ * @param {char*} page_data 结点的页面，页头的is_leaf已经设置好
+ * @param {char*} keys 解码后的n个key，内部结点的第0个key被忽略
+ */
+bool ix_pack_node(char *page_data, const IxFileHdr &file_hdr, const char *keys, const Rid *rids, int n);
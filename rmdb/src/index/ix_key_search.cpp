@@ -0,0 +1,215 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+#include "ix_key_search.h"
+
+#include <cstring>
+
+#include "ix_index_handle.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template <typename T>
+inline T load(const char *p) {
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template <typename T>
+inline int compare_value(T a, T b) {
+    return (a > b) - (a < b);
+}
+
+/* 单个INT或FLOAT字段 */
+template <typename T>
+struct ScalarKey {
+    using Value = T;
+    static constexpr bool SIMD = true;
+    explicit ScalarKey(const IxKeySearch *) {}
+    int len() const { return sizeof(T); }
+    int compare(const char *a, const char *b) const { return compare_value(load<T>(a), load<T>(b)); }
+    bool less(const char *a, const char *b) const { return load<T>(a) < load<T>(b); }
+};
+
+/* N个INT字段，逐个比较，循环次数在编译期确定 */
+template <int N>
+struct IntsKey {
+    static constexpr bool SIMD = false;
+    explicit IntsKey(const IxKeySearch *) {}
+    int len() const { return N * sizeof(int); }
+    int compare(const char *a, const char *b) const {
+        for (int i = 0; i < N; i++) {
+            int res = compare_value(load<int>(a + i * sizeof(int)), load<int>(b + i * sizeof(int)));
+            if (res != 0) {
+                return res;
+            }
+        }
+        return 0;
+    }
+    bool less(const char *a, const char *b) const { return compare(a, b) < 0; }
+};
+
+/* 全部为CHAR字段：定长字段依次拼接，逐字段memcmp等价于整个key一次memcmp */
+struct StringKey {
+    static constexpr bool SIMD = false;
+    int len_;
+    explicit StringKey(const IxKeySearch *s) : len_(s->key_len()) {}
+    int len() const { return len_; }
+    int compare(const char *a, const char *b) const { return memcmp(a, b, len_); }
+    bool less(const char *a, const char *b) const { return memcmp(a, b, len_) < 0; }
+};
+
+/* 其他格式逐字段比较 */
+struct GenericKey {
+    static constexpr bool SIMD = false;
+    const IxKeySearch *s_;
+    explicit GenericKey(const IxKeySearch *s) : s_(s) {}
+    int len() const { return s_->key_len(); }
+    int compare(const char *a, const char *b) const { return ix_compare(a, b, s_->col_types(), s_->col_lens()); }
+    bool less(const char *a, const char *b) const { return compare(a, b) < 0; }
+};
+
+#if defined(__x86_64__)
+const bool has_avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}();
+
+/**
+ * keys[0, n)中小于(OrEqual时为小于等于)target的key的个数。keys有序，个数即为第一个不满足条件的key的下标
+ */
+template <bool OrEqual>
+__attribute__((target("avx2"))) int simd_count(const int *keys, int n, int target) {
+    __m256i t = _mm256_set1_epi32(target);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        // key < target即target > key；key <= target即!(key > target)
+        __m256i m = OrEqual ? _mm256_cmpgt_epi32(v, t) : _mm256_cmpgt_epi32(t, v);
+        int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+        count += OrEqual ? 8 - bits : bits;
+    }
+    for (; i < n; i++) {
+        count += OrEqual ? keys[i] <= target : keys[i] < target;
+    }
+    return count;
+}
+
+template <bool OrEqual>
+__attribute__((target("avx2"))) int simd_count(const float *keys, int n, float target) {
+    __m256 t = _mm256_set1_ps(target);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(keys + i);
+        __m256 m = OrEqual ? _mm256_cmp_ps(v, t, _CMP_LE_OQ) : _mm256_cmp_ps(v, t, _CMP_LT_OQ);
+        count += __builtin_popcount(_mm256_movemask_ps(m));
+    }
+    for (; i < n; i++) {
+        count += OrEqual ? keys[i] <= target : keys[i] < target;
+    }
+    return count;
+}
+#else
+const bool has_avx2 = false;
+#endif
+
+}  // namespace
+
+/**
+ * 比较器Key对应的比较与查找函数，作为IxKeySearch中的函数指针
+ */
+template <typename Key>
+struct IxKeyOps {
+    static int compare(const IxKeySearch *s, const char *a, const char *b) { return Key(s).compare(a, b); }
+
+    /**
+     * 无分支的二分查找：答案始终在[base, base + n]中，每轮把n减半，比较结果只决定base是否前移。
+     * UpperBound为false时查找第一个>=target的key，为true时查找第一个>target的key
+     */
+    template <bool UpperBound>
+    static int search(const IxKeySearch *s, const char *keys, int begin, int end, const char *target) {
+        Key key(s);
+        int len = key.len();
+        // pred(k)为true的key都排在答案之前
+        auto pred = [&](const char *k) { return UpperBound ? !key.less(target, k) : key.less(k, target); };
+        int base = begin;
+        int n = end - begin;
+        int stop = 1;
+#if defined(__x86_64__)
+        if constexpr (Key::SIMD) {
+            stop = s->use_simd() ? IX_SIMD_SEARCH_KEYS : 1;
+        }
+#endif
+        while (n > stop) {
+            int half = n / 2;
+            base = pred(keys + (base + half) * len) ? base + half : base;
+            n -= half;
+        }
+#if defined(__x86_64__)
+        if constexpr (Key::SIMD) {
+            if (n > 1) {
+                using T = typename Key::Value;
+                return base + simd_count<UpperBound>(reinterpret_cast<const T *>(keys + base * len), n, load<T>(target));
+            }
+        }
+#endif
+        return base + (n == 1 && pred(keys + base * len));
+    }
+};
+
+template <typename Key>
+void IxKeySearch::bind() {
+    compare_ = &IxKeyOps<Key>::compare;
+    lower_bound_ = &IxKeyOps<Key>::template search<false>;
+    upper_bound_ = &IxKeyOps<Key>::template search<true>;
+}
+
+/**
+ * @description: 按索引的key格式选择比较器
+ * @param {IxFileHdr&} file_hdr 索引文件头
+ */
+IxKeySearch::IxKeySearch(const IxFileHdr &file_hdr)
+    : key_len_(file_hdr.col_tot_len_), col_types_(file_hdr.col_types_), col_lens_(file_hdr.col_lens_) {
+    auto all_of_type = [&](ColType type) {
+        for (ColType t : col_types_) {
+            if (t != type) {
+                return false;
+            }
+        }
+        return true;
+    };
+    size_t num_cols = col_types_.size();
+    if (file_hdr.compress_) {
+        // 压缩的索引中key已经转换为memcmp保序的格式
+        bind<StringKey>();
+    } else if (num_cols == 1 && col_types_[0] == TYPE_INT) {
+        bind<ScalarKey<int>>();
+        use_simd_ = has_avx2;
+    } else if (num_cols == 1 && col_types_[0] == TYPE_FLOAT) {
+        bind<ScalarKey<float>>();
+        use_simd_ = has_avx2;
+    } else if (num_cols == 2 && all_of_type(TYPE_INT)) {
+        bind<IntsKey<2>>();
+    } else if (num_cols == 3 && all_of_type(TYPE_INT)) {
+        bind<IntsKey<3>>();
+    } else if (num_cols == 4 && all_of_type(TYPE_INT)) {
+        bind<IntsKey<4>>();
+    } else if (num_cols > 0 && all_of_type(TYPE_STRING)) {
+        bind<StringKey>();
+    } else {
+        bind<GenericKey>();
+    }
+}
@@ -0,0 +1,77 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+#pragma once
+
+#include <vector>
+
+#include "ix_defs.h"
+
+// 单个INT/FLOAT字段的key：二分查找把范围缩小到不超过这么多个key(4个cache line)后，用AVX2一次比较8个key
+constexpr int IX_SIMD_SEARCH_KEYS = 64;
+
+/**
+ * 结点内的key比较与查找。打开索引时按key的格式(字段类型和长度)选定一个模板特化的比较器，
+ * 查找时不再逐字段switch ColType、遍历col_types_/col_lens_：
+ * 单个INT/FLOAT字段、2~4个INT字段、全部为CHAR字段(整体memcmp)各有专门的比较器，其余格式逐字段比较；
+ * 压缩的索引中key已是memcmp保序的格式，同样整体memcmp。
+ * 查找使用无分支的二分查找(比较结果只用于条件赋值，编译为cmov)，单个INT/FLOAT字段在CPU支持AVX2时
+ * 最后一段改为SIMD顺序比较
+ */
+class IxKeySearch {
+   public:
+    IxKeySearch() = default;
+
+    explicit IxKeySearch(const IxFileHdr &file_hdr);
+
+    /** @description: 比较两个key，返回值的符号与ix_compare()相同 */
+    int compare(const char *a, const char *b) const { return compare_(this, a, b); }
+
+    /**
+     * @description: 在keys[begin, end)中查找第一个>=target的key
+     * @return {int} key的下标，所有key都小于target时返回end
+     * @param {char*} keys 有序的key数组，每个key长度为col_tot_len
+     * @param {char*} target 目标key
+     */
+    int lower_bound(const char *keys, int begin, int end, const char *target) const {
+        return lower_bound_(this, keys, begin, end, target);
+    }
+
+    /**
+     * @description: 在keys[begin, end)中查找第一个>target的key
+     * @return {int} key的下标，所有key都不大于target时返回end
+     */
+    int upper_bound(const char *keys, int begin, int end, const char *target) const {
+        return upper_bound_(this, keys, begin, end, target);
+    }
+
+    int key_len() const { return key_len_; }
+
+    const std::vector<ColType> &col_types() const { return col_types_; }
+
+    const std::vector<int> &col_lens() const { return col_lens_; }
+
+    /** @description: 是否使用了AVX2顺序查找 */
+    bool use_simd() const { return use_simd_; }
+
+   private:
+    using CompareFn = int (*)(const IxKeySearch *, const char *, const char *);
+    using SearchFn = int (*)(const IxKeySearch *, const char *, int, int, const char *);
+
+    template <typename Key>
+    void bind();
+
+    int key_len_ = 0;                   // key的总长度col_tot_len
+    std::vector<ColType> col_types_;    // 逐字段比较时使用
+    std::vector<int> col_lens_;
+    bool use_simd_ = false;
+    CompareFn compare_ = nullptr;
+    SearchFn lower_bound_ = nullptr;
+    SearchFn upper_bound_ = nullptr;
+};
@@ -54,12 +54,17 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    // blink为true时创建B-link树(Lehman-Yao)，每个结点多占用一个key的空间存放high key；
+    // compress为true时压缩结点中的key(前缀压缩和分隔key的后缀截断)，btree_order仍按不压缩的key计算，是每个结点容量的下限
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool blink = false,
+                      bool compress = false) {
         std::string ix_name = get_index_name(filename, index_cols);
         // Create index file
         disk_manager_->create_file(ix_name);
         // Open index file
         int fd = disk_manager_->open_file(ix_name);
+        bool checksums = disk_manager_->page_checksums();
+        disk_manager_->set_file_checksums(fd, checksums);
 
         // Create file header and write to file
         // Theoretically we have: |page_hdr| + (|attr| + |rid|) * n <= PAGE_SIZE
@@ -73,15 +78,17 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
+        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE - |checksum| 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        int high_key_len = blink ? col_tot_len : 0;
+        int btree_order = static_cast<int>((Page::OFFSET_CHECKSUM - sizeof(IxPageHdr) - high_key_len) /
+                                           (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
         IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
-                                col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
-                                IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
+                                col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len + high_key_len,
+                                IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE, blink, compress, checksums);
         for(int i = 0; i < col_num; ++i) {
             fhdr->col_types_.push_back(index_cols[i].type);
             fhdr->col_lens_.push_back(index_cols[i].len);
@@ -107,6 +114,7 @@ class IxManager {
                 .is_leaf = true,
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
+                .right_link = IX_NO_PAGE,
             };
             disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
         }
@@ -122,6 +130,7 @@ class IxManager {
                 .is_leaf = true,
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
+                .right_link = IX_NO_PAGE,
             };
             // Must write PAGE_SIZE here in case of future fetch_node()
             disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
@@ -145,17 +154,39 @@ class IxManager {
 
     // 注意这里打开文件，创建并返回了index file handle的指针
     std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
+        int fd = open_index_file(get_index_name(filename, index_cols));
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
     std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
+        int fd = open_index_file(get_index_name(filename, index_cols));
         return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
     }
 
+    /**
+     * @description: 打开索引文件，先不校验地读出文件头，按其中的记录设置文件是否使用页面校验和。
+     *              格式版本不是IX_LAYOUT_VERSION的文件(结点格式不同)会被拒绝。IxBulkLoader等直接读写索引文件的地方也通过这里打开
+     * @return {int} 文件句柄
+     */
+    int open_index_file(const std::string &ix_name) {
+        int fd = disk_manager_->open_file(ix_name);
+        std::vector<char> buf(PAGE_SIZE);
+        disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf.data(), PAGE_SIZE);
+        IxFileHdr file_hdr;
+        file_hdr.deserialize(buf.data());
+        if (file_hdr.layout_version_ != IX_LAYOUT_VERSION) {
+            disk_manager_->close_file(fd);
+            throw InternalError("IxManager: " + ix_name + " has unsupported index layout version " +
+                                std::to_string(file_hdr.layout_version_));
+        }
+        if (file_hdr.page_checksums_ && !reserves_checksum(file_hdr)) {
+            disk_manager_->close_file(fd);
+            throw InternalError("IxManager: " + ix_name + " has page checksums but no space reserved for them");
+        }
+        disk_manager_->set_file_checksums(fd, file_hdr.page_checksums_);
+        return fd;
+    }
+
     void close_index(const IxIndexHandle *ih) {
         char* data = new char[ih->file_hdr_->tot_len_];
         ih->file_hdr_->serialize(data);
@@ -164,4 +195,16 @@ class IxManager {
         buffer_pool_manager_->flush_all_pages(ih->fd_);
         disk_manager_->close_file(ih->fd_);
     }
+
+   private:
+    /**
+     * @description: 文件头记录的结点格式是否在页尾为校验和留出了空间，压缩的结点总是按Page::OFFSET_CHECKSUM计算容量
+     */
+    static bool reserves_checksum(const IxFileHdr &file_hdr) {
+        if (file_hdr.compress_) {
+            return true;
+        }
+        size_t node_end = sizeof(IxPageHdr) + file_hdr.keys_size_ + (file_hdr.btree_order_ + 1) * sizeof(Rid);
+        return node_end <= Page::OFFSET_CHECKSUM;
+    }
 };
\ No newline at end of file
@@ -11,21 +11,29 @@ See the Mulan PSL v2 for more details. */
 #include "ix_scan.h"
 
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个键值对，读取叶结点时加读锁
  */
 void IxScan::next() {
     assert(!is_end());
     IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
+    node->page->rlatch();
     assert(node->is_leaf_page());
     assert(iid_.slot_no < node->get_size());
+    // 刚进入一个叶子结点时，异步预读叶子链表中的下一个叶子结点
+    if (iid_.slot_no == 0 && node->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        bpm_->prefetch_page(PageId{ih_->fd_, node->get_next_leaf()});
+    }
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
-        // go to next leaf
-        iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+    // go to next leaf，跳过B-link树中删空的叶结点；最后一个叶结点的后继是叶子链表的头结点
+    // 没能获取后继的锁时，按刚读过的key重新定位到第一个比它大的键值对
+    if (iid_.slot_no == node->get_size() && node->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        char key[IX_MAX_COL_LEN];
+        memcpy(key, node->get_key(iid_.slot_no - 1), ih_->file_hdr_->col_tot_len_);
+        iid_ = ih_->leaf_iid(node, iid_.slot_no, key, true);
+        return;
     }
+    ih_->release_read(node);
 }
 
 Rid IxScan::rid() const {
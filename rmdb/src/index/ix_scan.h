@@ -17,7 +17,7 @@ See the Mulan PSL v2 for more details. */
 
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 每次只对当前叶结点加读锁，读完即释放
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
     Iid iid_;  // 初始为lower（用于遍历的指针）
@@ -41,6 +41,9 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
+        } else if (auto x = std::dynamic_pointer_cast<ast::VerifyTable>(query->parse)) {
+            // verify table;
+            return std::make_shared<OtherPlan>(T_VerifyTable, x->tab_name);
         } else if (auto x = std::dynamic_pointer_cast<ast::TxnBegin>(query->parse)) {
             // begin;
             return std::make_shared<OtherPlan>(T_Transaction_begin, std::string());
@@ -55,7 +58,7 @@ class Optimizer {
             return std::make_shared<OtherPlan>(T_Transaction_rollback, std::string());
         } else if (auto x = std::dynamic_pointer_cast<ast::SetStmt>(query->parse)) {
             // Set Knob Plan
-            return std::make_shared<SetKnobPlan>(x->set_knob_type_, x->bool_val_);
+            return std::make_shared<SetKnobPlan>(x->set_knob_type_, x->bool_val_, x->int_val_);
         } else {
             return planner_->do_planner(query, context);
         }
@@ -24,6 +24,7 @@ typedef enum PlanTag{
     T_Help,
     T_ShowTable,
     T_DescTable,
+    T_VerifyTable,
     T_CreateTable,
     T_DropTable,
     T_CreateIndex,
@@ -160,17 +161,24 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                bool pax = false, bool blink = false, bool compress = false)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            pax_ = pax;
+            blink_ = blink;
+            compress_ = compress;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        bool pax_;                  // create table ... with (layout = pax)
+        bool blink_;                // create index ... with (tree = blink)
+        bool compress_;             // create index ... with (compression = prefix)
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -190,13 +198,15 @@ class OtherPlan : public Plan
 class SetKnobPlan : public Plan
 {
     public:
-        SetKnobPlan(ast::SetKnobType knob_type, bool bool_value) {
+        SetKnobPlan(ast::SetKnobType knob_type, bool bool_value, int int_value = 0) {
             Plan::tag = T_SetKnob;
             set_knob_type_ = knob_type;
             bool_value_ = bool_value;
+            int_value_ = int_value;
         }
     ast::SetKnobType set_knob_type_;
     bool bool_value_;
+    int int_value_;
 };
 
 class plannerInfo{
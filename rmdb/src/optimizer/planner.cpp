@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "planner.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "execution/executor_delete.h"
@@ -316,19 +317,52 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             if (auto sv_col_def = std::dynamic_pointer_cast<ast::ColDef>(field)) {
                 ColDef col_def = {.name = sv_col_def->col_name,
                                   .type = interp_sv_type(sv_col_def->type_len->type),
-                                  .len = sv_col_def->type_len->len};
+                                  .len = sv_col_def->type_len->len,
+                                  .varlen = sv_col_def->type_len->varlen};
                 col_defs.push_back(col_def);
             } else {
                 throw InternalError("Unexpected field type");
             }
         }
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        // 存储选项WITH (layout = row | pax)，选项名和取值不区分大小写
+        auto lower = [](std::string str) {
+            std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+            return str;
+        };
+        bool pax = false;
+        if (!x->option_name.empty()) {
+            std::string value = lower(x->option_value);
+            if (lower(x->option_name) != "layout" || (value != "row" && value != "pax")) {
+                throw InternalError("Unsupported table option: " + x->option_name + " = " + x->option_value);
+            }
+            pax = value == "pax";
+        }
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs, pax);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropTable>(query->parse)) {
         // drop table;
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        // 索引选项WITH (tree = btree | blink, compression = none | prefix)，选项名和取值不区分大小写
+        auto lower = [](std::string str) {
+            std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+            return str;
+        };
+        bool blink = false;
+        bool compress = false;
+        for (auto &[option_name, option_value] : x->options) {
+            std::string name = lower(option_name);
+            std::string value = lower(option_value);
+            if (name == "tree" && (value == "btree" || value == "blink")) {
+                blink = value == "blink";
+            } else if (name == "compression" && (value == "none" || value == "prefix")) {
+                compress = value == "prefix";
+            } else {
+                throw InternalError("Unsupported index option: " + option_name + " = " + option_value);
+            }
+        }
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>(),
+                                                false, blink, compress);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
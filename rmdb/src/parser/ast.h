@@ -33,7 +33,7 @@ enum OrderByDir {
 };
 
 enum SetKnobType {
-    EnableNestLoop, EnableSortMerge
+    EnableNestLoop, EnableSortMerge, BufferPoolSize
 };
 
 // Base class for tree nodes
@@ -62,8 +62,9 @@ struct TxnRollback : public TreeNode {
 struct TypeLen : public TreeNode {
     SvType type;
     int len;
+    bool varlen;    // VARCHAR(n)
 
-    TypeLen(SvType type_, int len_) : type(type_), len(len_) {}
+    TypeLen(SvType type_, int len_, bool varlen_ = false) : type(type_), len(len_), varlen(varlen_) {}
 };
 
 struct Field : public TreeNode {
@@ -80,9 +81,13 @@ struct ColDef : public Field {
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    std::string option_name;    // WITH (option_name = option_value)，目前只支持layout = row | pax
+    std::string option_value;
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_,
+                std::string option_name_ = "", std::string option_value_ = "") :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)),
+            option_name(std::move(option_name_)), option_value(std::move(option_value_)) {}
 };
 
 struct DropTable : public TreeNode {
@@ -97,12 +102,21 @@ struct DescTable : public TreeNode {
     DescTable(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
 };
 
+struct VerifyTable : public TreeNode {
+    std::string tab_name;
+
+    VerifyTable(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    // WITH (name = value [, name = value])，目前支持tree = btree | blink和compression = none | prefix
+    std::vector<std::pair<std::string, std::string>> options;
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_,
+                std::vector<std::pair<std::string, std::string>> options_ = {}) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), options(std::move(options_)) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -235,13 +249,17 @@ struct SelectStmt : public TreeNode {
             }
 };
 
-// set enable_nestloop
+// set enable_nestloop = true / set buffer_pool_size = 65536
 struct SetStmt : public TreeNode {
     SetKnobType set_knob_type_;
-    bool bool_val_;
+    bool bool_val_ = false;
+    int int_val_ = 0;
 
     SetStmt(SetKnobType &type, bool bool_value) : 
         set_knob_type_(type), bool_val_(bool_value) { }
+
+    SetStmt(SetKnobType type, int int_value) :
+        set_knob_type_(type), int_val_(int_value) { }
 };
 
 // Semantic value
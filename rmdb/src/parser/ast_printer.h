@@ -89,6 +89,9 @@ private:
         } else if (auto x = std::dynamic_pointer_cast<DescTable>(node)) {
             std::cout << "DESC_TABLE\n";
             print_val(x->tab_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<VerifyTable>(node)) {
+            std::cout << "VERIFY_TABLE\n";
+            print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<CreateIndex>(node)) {
             std::cout << "CREATE_INDEX\n";
             print_val(x->tab_name, offset);
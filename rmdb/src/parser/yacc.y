@@ -1,6 +1,7 @@
 %{
 #include "ast.h"
 #include "yacc.tab.h"
+#include <strings.h>
 #include <iostream>
 #include <memory>
 
@@ -21,8 +22,8 @@ using namespace ast;
 %define parse.error verbose
 
 // keywords
-%token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
-WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE
+%token SHOW TABLES CREATE TABLE WITH DROP DESC VERIFY INSERT INTO VALUES DELETE FROM ASC ORDER BY
+WHERE UPDATE SET SELECT INT CHAR VARCHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY ENABLE_NESTLOOP ENABLE_SORTMERGE
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -42,7 +43,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_val> value
 %type <sv_vals> valueList
 %type <sv_str> tbName colName
-%type <sv_strs> tableList colNameList
+%type <sv_strs> tableList colNameList optionList
 %type <sv_col> col
 %type <sv_cols> colList selector
 %type <sv_set_clause> setClause
@@ -116,6 +117,15 @@ setStmt:
     {
         $$ = std::make_shared<SetStmt>($2, $4);
     }
+    |   SET IDENTIFIER '=' VALUE_INT
+    {
+        // 数值型参数不是关键字，按名字区分
+        if (strcasecmp($2.c_str(), "buffer_pool_size") != 0) {
+            yyerror(&@2, ("unknown knob " + $2).c_str());
+            YYERROR;
+        }
+        $$ = std::make_shared<SetStmt>(BufferPoolSize, $4);
+    }
     ;
 
 ddl:
@@ -123,6 +133,10 @@ ddl:
     {
         $$ = std::make_shared<CreateTable>($3, $5);
     }
+    |   CREATE TABLE tbName '(' fieldList ')' WITH '(' IDENTIFIER '=' IDENTIFIER ')'
+    {
+        $$ = std::make_shared<CreateTable>($3, $5, $9, $11);
+    }
     |   DROP TABLE tbName
     {
         $$ = std::make_shared<DropTable>($3);
@@ -131,10 +145,23 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
+    |   VERIFY TABLE tbName
+    {
+        $$ = std::make_shared<VerifyTable>($3);
+    }
     |   CREATE INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<CreateIndex>($3, $5);
     }
+    |   CREATE INDEX tbName '(' colNameList ')' WITH '(' optionList ')'
+    {
+        // optionList中选项名和取值交替排列
+        std::vector<std::pair<std::string, std::string>> options;
+        for (size_t i = 0; i + 1 < $9.size(); i += 2) {
+            options.emplace_back($9[i], $9[i + 1]);
+        }
+        $$ = std::make_shared<CreateIndex>($3, $5, options);
+    }
     |   DROP INDEX tbName '(' colNameList ')'
     {
         $$ = std::make_shared<DropIndex>($3, $5);
@@ -182,6 +209,18 @@ colNameList:
     }
     ;
 
+optionList:
+        IDENTIFIER '=' IDENTIFIER
+    {
+        $$ = std::vector<std::string>{$1, $3};
+    }
+    | optionList ',' IDENTIFIER '=' IDENTIFIER
+    {
+        $$.push_back($3);
+        $$.push_back($5);
+    }
+    ;
+
 field:
         colName type
     {
@@ -198,6 +237,10 @@ type:
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3);
     }
+    |   VARCHAR '(' VALUE_INT ')'
+    {
+        $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3, true);
+    }
     |   FLOAT
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
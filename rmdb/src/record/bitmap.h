@@ -10,12 +10,23 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RMDB_BITMAP_AVX2 1
+#endif
+
 static constexpr int BITMAP_WIDTH = 8;
 static constexpr unsigned BITMAP_HIGHEST_BIT = 0x80u;  // 128 (2^7)
 
+/**
+ * 位图中第pos位位于第pos / 8个字节，字节内从最高位开始编号。
+ * next_bit/first_bit每次处理一个64位字：按大端序读入8个字节后，第pos位恰好是字的第pos % 64个最高位，
+ * 用clz定位第一个为1的位；CPU支持AVX2且剩余的位较多时，先每次比较32个字节跳过全0(或全1)的部分。
+ */
 class Bitmap {
    public:
     // 从地址bm开始的size个字节全部置0
@@ -39,6 +50,25 @@ class Bitmap {
      * @return 找到了就返回偏移位置，没找到就返回max_n
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
+        // 大多数查找在起点所在的字中就能找到，只有需要跳过很长一段时才使用AVX2
+        int word_end = std::min(max_n, ((curr + 1) / WORD_BITS + 1) * WORD_BITS);
+        int pos = next_bit_word(bit, bm, word_end, curr);
+        if (pos < word_end || word_end >= max_n) {
+            return pos < word_end ? pos : max_n;
+        }
+#ifdef RMDB_BITMAP_AVX2
+        if (max_n - word_end > AVX2_MIN_BITS && has_avx2()) {
+            return next_bit_avx2(bit, bm, max_n, word_end - 1);
+        }
+#endif
+        return next_bit_word(bit, bm, max_n, word_end - 1);
+    }
+
+    // 找第一个为0 or 1的位
+    static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
+
+    // 逐位查找的next_bit，作为其他实现的参照，用于测试和性能对比
+    static int next_bit_bitwise(bool bit, const char *bm, int max_n, int curr) {
         for (int i = curr + 1; i < max_n; i++) {
             if (is_set(bm, i) == bit) {
                 return i;
@@ -47,14 +77,119 @@ class Bitmap {
         return max_n;
     }
 
-    // 找第一个为0 or 1的位
-    static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
+    // 每次处理一个64位字的next_bit
+    static int next_bit_word(bool bit, const char *bm, int max_n, int curr) {
+        int start = curr + 1;
+        if (start >= max_n) {
+            return max_n;
+        }
+        // 记录较满时扫描的下一个记录往往就在下一个slot，先单独检查
+        if (is_set(bm, start) == bit) {
+            return start;
+        }
+        uint64_t flip = bit ? 0 : ~0ULL;
+        int word = start / WORD_BITS;
+        uint64_t w = (load_word(bm, max_n, word) ^ flip) & (~0ULL >> (start % WORD_BITS));
+        while (w == 0) {
+            if (++word * WORD_BITS >= max_n) {
+                return max_n;
+            }
+            w = load_word(bm, max_n, word) ^ flip;
+        }
+        // 找0时最后一个字节中超出max_n的位取反后为1，可能被找到，因此需要与max_n比较
+        return std::min(word * WORD_BITS + __builtin_clzll(w), max_n);
+    }
+
+#ifdef RMDB_BITMAP_AVX2
+    // 先在起点所在的64位字中查找，再每次比较32个字节跳过全0(找1时)或全1(找0时)的字节，然后在第一个不满足的字节处查找
+    __attribute__((target("avx2"))) static int next_bit_avx2(bool bit, const char *bm, int max_n, int curr) {
+        int start = curr + 1;
+        if (start >= max_n) {
+            return max_n;
+        }
+        int word_end = std::min(max_n, (start / WORD_BITS + 1) * WORD_BITS);
+        int pos = next_bit_word(bit, bm, word_end, curr);
+        if (pos < word_end || word_end == max_n) {
+            return pos < word_end ? pos : max_n;
+        }
+        const __m256i skip = bit ? _mm256_setzero_si256() : _mm256_set1_epi8(static_cast<char>(0xff));
+        int byte = word_end / BITMAP_WIDTH;
+        int full_bytes = max_n / BITMAP_WIDTH;
+        for (; byte + 32 <= full_bytes; byte += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bm + byte));
+            uint32_t same = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, skip)));
+            if (same != 0xffffffffu) {
+                byte += __builtin_ctz(~same);
+                break;
+            }
+        }
+        return next_bit_word(bit, bm, max_n, byte * BITMAP_WIDTH - 1);
+    }
+
+    // CPU是否支持AVX2，只检测一次
+    static bool has_avx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+
+    /**
+     * @brief 把[0, max_n)中所有为1的位的位置按从小到大的顺序写入positions，用于一次取出页面中所有记录的slot号
+     * @param positions 至少能容纳max_n个元素
+     * @return 为1的位的个数
+     */
+    static int get_set_bits(const char *bm, int max_n, int *positions) {
+        int n = 0;
+        for (int word = 0; word * WORD_BITS < max_n; word++) {
+            uint64_t w = load_word(bm, max_n, word) & tail_mask(max_n, word);
+            while (w != 0) {
+                int offset = __builtin_clzll(w);
+                positions[n++] = word * WORD_BITS + offset;
+                w &= ~(HIGHEST_WORD_BIT >> offset);
+            }
+        }
+        return n;
+    }
+
+    // [0, max_n)中为1的位的个数
+    static int count(const char *bm, int max_n) {
+        int n = 0;
+        for (int word = 0; word * WORD_BITS < max_n; word++) {
+            n += __builtin_popcountll(load_word(bm, max_n, word) & tail_mask(max_n, word));
+        }
+        return n;
+    }
 
     // for example:
     // rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page,
     // rid_.slot_no); int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
 
    private:
+    static constexpr int WORD_BITS = 64;
+    static constexpr uint64_t HIGHEST_WORD_BIT = 1ULL << 63;
+    static constexpr int AVX2_MIN_BITS = 512;  // 剩余的位少于这个数时AVX2不比逐字查找快
+
+    // 按大端序读入第word个64位字，位图只有(max_n + 7) / 8个字节，超出的部分补0
+    static uint64_t load_word(const char *bm, int max_n, int word) {
+        int bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH - word * 8;
+        uint64_t w = 0;
+        if (bytes >= 8) {
+            memcpy(&w, bm + word * 8, 8);  // 定长的memcpy会被编译为一次读取
+        } else {
+            memcpy(&w, bm + word * 8, bytes);
+        }
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        w = __builtin_bswap64(w);
+#endif
+        return w;
+    }
+
+    // 第word个字中位置小于max_n的位
+    static uint64_t tail_mask(int max_n, int word) {
+        int bits = max_n - word * WORD_BITS;
+        return bits >= WORD_BITS ? ~0ULL : ~(~0ULL >> bits);
+    }
+
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
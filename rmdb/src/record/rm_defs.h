@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+
 #include "defs.h"
 #include "storage/buffer_pool_manager.h"
 
@@ -17,26 +19,91 @@ constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_INSERT_TARGETS = 16;       // 每个表的插入目标数，插入线程按线程号哈希到其中一个
+const std::string RM_FSM_SUFFIX = ".fsm";   // 空闲空间映射(FSM)文件名的后缀
+// FSM页面中每个表项为一个uint16_t，记录对应数据页面的空闲空间：定长页面为空闲slot的个数，slotted页面为可用的空闲字节数；
+// 页头的LSN和页尾的校验和保留不用
+constexpr int RM_FSM_ENTRIES_PER_PAGE =
+    static_cast<int>(Page::OFFSET_CHECKSUM - Page::OFFSET_PAGE_HDR) / sizeof(uint16_t);
+constexpr int RM_MAX_VAR_COLS = 16;         // 每个表最多的VARCHAR字段数
+constexpr int RM_MAX_PAX_COLS = 64;         // PAX格式的表最多的字段数
+constexpr int RM_MAX_ZONE_COLS = 16;        // 每个表最多维护zone map的数值字段数
+// VARCHAR字段在页面中以2字节长度加实际内容存储，这是一条记录编码后的最大长度
+constexpr int RM_MAX_ENCODED_SIZE = RM_MAX_RECORD_SIZE + RM_MAX_VAR_COLS * static_cast<int>(sizeof(uint16_t));
+
+/* 表数据文件的页面格式 */
+enum RmLayout : int {
+    RM_LAYOUT_FIXED = 0,    // 定长slot：bitmap之后是num_records_per_page个record_size大小的slot
+    RM_LAYOUT_SLOTTED = 1,  // slotted page：bitmap之后是slot目录，记录变长编码后从页尾向前存放，表中有VARCHAR字段时使用
+    RM_LAYOUT_PAX = 2,      // PAX：bitmap之后每个字段占一段连续的minipage，依次存放页面中所有slot的该字段，
+                            // 字段在定长记录中的offset为k时，minipage从num_records_per_page * k开始
+};
+
+/* 字段在定长记录中的位置。执行器看到的记录始终是定长的，VARCHAR(n)占n字节、不足补0，只有写入slotted页面时才去掉补齐 */
+struct RmColPos {
+    int offset;
+    int len;
+};
+
+/* 维护zone map(页面内的最小/最大值)的数值字段 */
+struct RmZoneCol {
+    int offset;
+    ColType type;   // TYPE_INT或TYPE_FLOAT
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
-    int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
+    int record_size;            // 表中每条记录(定长格式)的大小，初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
-    int num_records_per_page;   // 每个页面最多能存储的元组个数
-    int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
+    int num_records_per_page;   // 每个页面最多能存储的元组个数，slotted页面为slot目录的最大长度
+    int first_free_page_no;     // 保持为-1，不再使用：包含空闲空间的页面由FSM文件记录
     int bitmap_size;            // 每个页面bitmap大小
+    int layout;                 // 页面格式，RmLayout
+    int num_var_cols;           // VARCHAR字段数
+    RmColPos var_cols[RM_MAX_VAR_COLS];     // VARCHAR字段，按offset升序
+    int num_pax_cols;           // PAX格式的字段数
+    RmColPos pax_cols[RM_MAX_PAX_COLS];     // PAX格式的全部字段，按offset升序
+    int num_zone_cols;          // 维护zone map的字段数
+    RmZoneCol zone_cols[RM_MAX_ZONE_COLS];  // 维护zone map的字段
+    // 数据文件和FSM文件的页面是否带有校验和，创建时确定；旧的数据文件为false，页面格式也没有为校验和留出空间
+    bool page_checksums;
 };
+static_assert(sizeof(RmFileHdr) <= Page::OFFSET_CHECKSUM, "RmFileHdr must fit in the header page");
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
 struct RmPageHdr {
-    int next_free_page_no;  // 当前页面满了之后，下一个包含空闲空间的页面号（初始化为-1）
+    int next_free_page_no;  // 保持为-1，不再使用：包含空闲空间的页面由FSM文件记录
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
+/* slotted页面在bitmap之后的页头，其后紧跟num_slots个RmSlot组成的slot目录 */
+struct RmSlottedHdr {
+    uint16_t num_slots;     // slot目录的长度，末尾的空闲slot在删除时被截掉
+    uint16_t heap_start;    // 记录区的起始偏移，记录区为[heap_start, Page::OFFSET_CHECKSUM)，始终是紧凑的
+};
+
+/**
+ * slot目录项。offset为记录在页面中的偏移，高两位为标志：
+ * RM_SLOT_FORWARD：记录更新后变长、本页放不下而搬到了其他页面，这里只存放目标位置的Rid，记录的rid保持不变
+ * RM_SLOT_MOVED：从其他页面搬来的记录，只能通过原rid访问，扫描时跳过
+ * bitmap中未置位的slot为空闲slot，目录项为0
+ */
+struct RmSlot {
+    uint16_t offset;
+    uint16_t len;
+};
+
+constexpr uint16_t RM_SLOT_FORWARD = 0x8000;
+constexpr uint16_t RM_SLOT_MOVED = 0x4000;
+constexpr uint16_t RM_SLOT_OFFSET_MASK = 0x3fff;
+// 每条记录至少占这么多字节，保证任何记录都能原地换成RM_SLOT_FORWARD的目标Rid
+constexpr int RM_MIN_PAYLOAD = sizeof(Rid);
+static_assert(PAGE_SIZE <= RM_SLOT_OFFSET_MASK + 1, "slot offset must fit in RmSlot::offset");
+
 /* 表中的记录 */
 struct RmRecord {
-    char* data;  // 记录的数据
-    int size;    // 记录的大小
+    char* data = nullptr;       // 记录的数据
+    int size = 0;               // 记录的大小
     bool allocated_ = false;    // 是否已经为数据分配空间
 
     RmRecord() = default;
@@ -48,28 +115,56 @@ struct RmRecord {
         allocated_ = true;
     };
 
+    RmRecord(RmRecord&& other) noexcept : data(other.data), size(other.size), allocated_(other.allocated_) {
+        other.data = nullptr;
+        other.allocated_ = false;
+    }
+
     RmRecord &operator=(const RmRecord& other) {
+        if (this == &other) {
+            return *this;
+        }
+        // 大小相同时复用已分配的空间，否则释放旧空间再重新分配
+        if (!allocated_ || size != other.size) {
+            if (allocated_) {
+                delete[] data;
+            }
+            data = new char[other.size];
+            allocated_ = true;
+        }
         size = other.size;
-        data = new char[size];
         memcpy(data, other.data, size);
-        allocated_ = true;
         return *this;
     };
 
+    RmRecord &operator=(RmRecord&& other) noexcept {
+        if (this != &other) {
+            if (allocated_) {
+                delete[] data;
+            }
+            data = other.data;
+            size = other.size;
+            allocated_ = other.allocated_;
+            other.data = nullptr;
+            other.allocated_ = false;
+        }
+        return *this;
+    }
+
     RmRecord(int size_) {
         size = size_;
         data = new char[size_];
         allocated_ = true;
     }
 
-    RmRecord(int size_, char* data_) {
+    RmRecord(int size_, const char* data_) {
         size = size_;
         data = new char[size_];
         memcpy(data, data_, size_);
         allocated_ = true;
     }
 
-    void SetData(char* data_) {
+    void SetData(const char* data_) {
         memcpy(data, data_, size);
     }
 
@@ -80,6 +175,7 @@ struct RmRecord {
         }
         data = new char[size];
         memcpy(data, data_ + sizeof(int), size);
+        allocated_ = true;
     }
 
     ~RmRecord() {
@@ -90,3 +186,65 @@ struct RmRecord {
         data = nullptr;
     }
 };
+
+/* 持有缓冲池中一个页面的pin，析构或release()时unpin。只能移动，不能复制 */
+class RmPageGuard {
+   public:
+    RmPageGuard() = default;
+
+    RmPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    RmPageGuard(RmPageGuard &&other) noexcept : bpm_(other.bpm_), page_(other.page_) { other.page_ = nullptr; }
+
+    RmPageGuard &operator=(RmPageGuard &&other) noexcept {
+        if (this != &other) {
+            release();
+            bpm_ = other.bpm_;
+            page_ = other.page_;
+            other.page_ = nullptr;
+        }
+        return *this;
+    }
+
+    RmPageGuard(const RmPageGuard &) = delete;
+    RmPageGuard &operator=(const RmPageGuard &) = delete;
+
+    ~RmPageGuard() { release(); }
+
+    void release() {
+        if (page_ != nullptr) {
+            bpm_->unpin_page(page_->get_page_id(), false);
+            page_ = nullptr;
+        }
+    }
+
+    Page *page() const { return page_; }
+
+   private:
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;
+};
+
+/**
+ * @description: 记录的只读视图，不拥有数据，在执行器之间传递时不分配内存也不复制。
+ * data指向缓冲池中的页面时由guard持有该页面的pin；guard为空时data指向产生它的算子内部的缓冲区或扫描器pin住的页面，
+ * 在该算子下一次nextTuple()之前有效。需要在此之后继续保留记录的算子调用materialize()复制出RmRecord
+ */
+struct RmRecordView {
+    const char *data = nullptr;     // 记录的数据
+    int size = 0;                   // 记录的大小
+    RmPageGuard guard;              // 记录所在页面的pin，可以为空
+    std::unique_ptr<RmRecord> owned;    // 记录不能直接引用页面(如slotted页面中变长编码的记录)时，data指向解码到这里的副本
+
+    RmRecordView() = default;
+
+    RmRecordView(const char *data_, int size_, RmPageGuard guard_ = RmPageGuard())
+        : data(data_), size(size_), guard(std::move(guard_)) {}
+
+    explicit RmRecordView(std::unique_ptr<RmRecord> owned_)
+        : data(owned_->data), size(owned_->size), owned(std::move(owned_)) {}
+
+    explicit operator bool() const { return data != nullptr; }
+
+    std::unique_ptr<RmRecord> materialize() const { return std::make_unique<RmRecord>(size, data); }
+};
@@ -10,6 +10,10 @@ See the Mulan PSL v2 for more details. */
 
 #include "rm_file_handle.h"
 
+#include <algorithm>
+#include <cstring>
+#include <thread>  // NOLINT
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -20,17 +24,35 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-
-    if (Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        auto record = std::make_unique<RmRecord>(page_handle.file_hdr->record_size);
-        char* slot_data = page_handle.get_slot(rid.slot_no);
-        record->SetData(slot_data);
+    RmRecordView view = get_record_view(rid, context);
+    if (!view) {
+        return nullptr;
+    }
+    if (view.owned != nullptr) {
+        return std::move(view.owned);
+    }
+    return view.materialize();
+}
 
-        //buffer_pool_manager_->unpin_page({fd_, rid.page_no}, false);
-        return record;
+/**
+ * @description: 获取当前表中记录号为rid的记录的只读视图，不复制记录：视图直接指向缓冲池中的页面，并持有该页面的pin直到视图析构
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {Context*} context
+ * @return {RmRecordView} rid对应的记录视图，rid处没有记录时为空视图
+ */
+RmRecordView RmFileHandle::get_record_view(const Rid& rid, Context* context) const {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    RmPageGuard guard(buffer_pool_manager_, page_handle.page);
+    if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        return RmRecordView();
+    }
+    if (file_hdr_.layout != RM_LAYOUT_FIXED) {
+        // slotted页面中的记录是变长编码的，PAX页面中的记录按字段分散存放，只能拼出一份副本
+        auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+        read_record(page_handle, rid.slot_no, record->data);
+        return RmRecordView(std::move(record));
     }
-    return nullptr;
+    return RmRecordView(page_handle.get_slot(rid.slot_no), file_hdr_.record_size, std::move(guard));
 }
 
 /**
@@ -45,23 +67,59 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     // 2. 在page handle中找到空闲slot位置
     // 3. 将buf复制到空闲slot位置
     // 4. 更新page_handle.page_hdr中的数据结构
-    // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
-    // 1. 获取当前未满的page handle
-    RmPageHandle page_handle = create_page_handle();
-    // 2. 在page handle中找到空闲slot位置
-    int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
+    // 注意考虑插入一条记录后页面已满的情况，需要让出该页面并更新FSM
+    Rid rid;
+    if (!is_slotted()) {
+        rid = insert_payload(buf, file_hdr_.record_size, 0);
+    } else {
+        char data[RM_MAX_ENCODED_SIZE];
+        int len = encode_record(buf, data);
+        rid = insert_payload(data, len, 0);
+    }
+    zone_map_.on_write(rid.page_no, buf, false);
+    return rid;
+}
 
-    // 3. 将buf复制到空闲slot位置
-    char* slot_data = page_handle.get_slot(slot_no);
-    memcpy(slot_data, buf, page_handle.file_hdr->record_size);
+/**
+ * @description: 把一条已经是页面格式的记录插入到当前线程的插入目标页面中
+ * @param {char*} data 记录在页面中的数据，定长页面为定长记录，slotted页面为encode_record()的结果
+ * @param {int} len data的长度
+ * @param {uint16_t} flags slotted页面中slot目录项的标志
+ * @return {Rid} 插入的位置
+ */
+Rid RmFileHandle::insert_payload(const char* data, int len, uint16_t flags) {
+    // 1. 获取当前线程的插入目标独占的、放得下这条记录的page handle
+    RmInsertTarget &target = get_insert_target();
+    std::scoped_lock target_lock{target.latch};
+    RmPageHandle page_handle = create_page_handle(target, len);
+    // 2. 在page handle中找到空闲slot位置，3. 将记录复制到slot中
+    int slot_no;
+    if (!is_slotted()) {
+        slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
+        if (is_pax()) {
+            write_pax_record(page_handle, slot_no, data);
+        } else {
+            memcpy(page_handle.get_slot(slot_no), data, file_hdr_.record_size);
+        }
+    } else {
+        slot_no = page_handle.alloc_slot();
+        page_handle.put_payload(slot_no, data, len, flags);
+    }
 
     // 4. 更新page_handle.page_hdr中的数据结构
     Bitmap::set(page_handle.bitmap, slot_no);
     page_handle.page_hdr->num_records++;
-    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+    // 插入页面由目标独占，FSM中它的表项在页面满了、目标换到其他页面时才更新
+    if (page_free_space(page_handle) == 0) {
+        Page *fsm_page = fsm_pin_page(target.page_no);
+        {
+            std::scoped_lock lock{fsm_latch_};
+            fsm_set(fsm_page, target.page_no, 0);
+            target.page_no = RM_NO_PAGE;
+        }
+        buffer_pool_manager_->unpin_page(fsm_page->get_page_id(), true);
     }
-//buffer_pool_manager_->unpin_page({fd_, page_handle.page->get_page_id().page_no}, true);
+    buffer_pool_manager_->unpin_page({fd_, page_handle.page->get_page_id().page_no}, true);
     return Rid{page_handle.page->get_page_id().page_no, slot_no};
 }
 
@@ -72,11 +130,37 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-    char* slot_data = page_handle.get_slot(rid.slot_no);
-    memcpy(slot_data, buf, page_handle.file_hdr->record_size);
+    if (is_pax()) {
+        write_pax_record(page_handle, rid.slot_no, buf);
+    } else if (!is_slotted()) {
+        char* slot_data = page_handle.get_slot(rid.slot_no);
+        memcpy(slot_data, buf, page_handle.file_hdr->record_size);
+    } else {
+        char data[RM_MAX_ENCODED_SIZE];
+        int len = encode_record(buf, data);
+        RmSlottedHdr *hdr = page_handle.slotted_hdr();
+        int dir_bytes = std::max(0, rid.slot_no + 1 - hdr->num_slots) * static_cast<int>(sizeof(RmSlot));
+        if (page_handle.free_bytes() < dir_bytes + RM_MIN_PAYLOAD) {
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            throw InternalError("RmFileHandle: no room to insert record at the given rid");
+        }
+        for (; hdr->num_slots <= rid.slot_no; hdr->num_slots++) {
+            page_handle.slot_dir()[hdr->num_slots] = RmSlot{0, 0};
+        }
+        if (page_handle.can_put(len, false)) {
+            page_handle.put_payload(rid.slot_no, data, len, 0);
+        } else {
+            // 原位置放不下整条记录时搬到其他页面，原位置只保存目标Rid
+            Rid target = insert_payload(data, len, RM_SLOT_MOVED);
+            page_handle.put_payload(rid.slot_no, reinterpret_cast<const char*>(&target), sizeof(Rid),
+                                    RM_SLOT_FORWARD);
+        }
+    }
     Bitmap::set(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records++;
-    //buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    update_free_space(page_handle);
+    zone_map_.on_write(rid.page_no, buf, false);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
 /**
@@ -88,14 +172,38 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新page_handle.page_hdr中的数据结构
-    // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
+    // 注意考虑删除一条记录后页面未满的情况，需要调用update_free_space()更新FSM
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        release_page_handle(page_handle);
+    if (is_slotted()) {
+        // slotted页面删除时立即整理，空出的空间马上可以重新使用
+        if (page_handle.slot_dir()[rid.slot_no].offset & RM_SLOT_FORWARD) {
+            Rid target;
+            memcpy(&target, page_handle.get_payload(rid.slot_no), sizeof(Rid));
+            delete_moved_record(target);
+        }
+        page_handle.remove_payload(rid.slot_no);
     }
     Bitmap::reset(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records--;
-    //buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    if (is_slotted()) {
+        page_handle.trim_slot_dir();
+    }
+    update_free_space(page_handle);
+    zone_map_.on_delete(rid.page_no);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+}
+
+/**
+ * @description: 删除从其他页面搬来的记录(slot带RM_SLOT_MOVED标志)
+ */
+void RmFileHandle::delete_moved_record(const Rid& rid) {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    page_handle.remove_payload(rid.slot_no);
+    Bitmap::reset(page_handle.bitmap, rid.slot_no);
+    page_handle.page_hdr->num_records--;
+    page_handle.trim_slot_dir();
+    update_free_space(page_handle);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
 
@@ -109,10 +217,165 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新记录
+    if (is_slotted()) {
+        char data[RM_MAX_ENCODED_SIZE];
+        int len = encode_record(buf, data);
+        update_slotted_record(rid, data, len);
+        zone_map_.on_write(rid.page_no, buf, true);
+        return;
+    }
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-    char* slot_data = page_handle.get_slot(rid.slot_no);
-    memcpy(slot_data, buf, page_handle.file_hdr->record_size);
-//buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    if (is_pax()) {
+        write_pax_record(page_handle, rid.slot_no, buf);
+    } else {
+        char* slot_data = page_handle.get_slot(rid.slot_no);
+        memcpy(slot_data, buf, page_handle.file_hdr->record_size);
+    }
+    zone_map_.on_write(rid.page_no, buf, true);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+}
+
+/**
+ * @description: 更新slotted页面中的记录。新记录在原页面放得下时原地整理页面后写入；放不下时搬到其他页面，
+ *              原位置只保存目标Rid，rid保持不变。已经搬走的记录再次更新时优先写回当前的目标位置
+ * @param {Rid&} rid 要更新的记录的记录号
+ * @param {char*} data 编码后的新记录
+ * @param {int} len data的长度
+ */
+void RmFileHandle::update_slotted_record(const Rid& rid, const char* data, int len) {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    RmSlot slot = page_handle.slot_dir()[rid.slot_no];
+    if (slot.offset & RM_SLOT_FORWARD) {
+        Rid target;
+        memcpy(&target, page_handle.get_payload(rid.slot_no), sizeof(Rid));
+        RmPageHandle target_handle = fetch_page_handle(target.page_no);
+        if (target_handle.free_bytes() + target_handle.slot_dir()[target.slot_no].len >= len) {
+            target_handle.remove_payload(target.slot_no);
+            target_handle.put_payload(target.slot_no, data, len, RM_SLOT_MOVED);
+            update_free_space(target_handle);
+            buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), true);
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            return;
+        }
+        buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), false);
+        Rid new_target = insert_payload(data, len, RM_SLOT_MOVED);
+        delete_moved_record(target);
+        memcpy(page_handle.get_payload(rid.slot_no), &new_target, sizeof(Rid));
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+        return;
+    }
+    if (page_handle.free_bytes() + slot.len >= len) {
+        page_handle.remove_payload(rid.slot_no);
+        page_handle.put_payload(rid.slot_no, data, len, 0);
+    } else {
+        // 每条记录至少RM_MIN_PAYLOAD字节，移走原记录后一定放得下目标Rid
+        Rid target = insert_payload(data, len, RM_SLOT_MOVED);
+        page_handle.remove_payload(rid.slot_no);
+        page_handle.put_payload(rid.slot_no, reinterpret_cast<const char*>(&target), sizeof(Rid), RM_SLOT_FORWARD);
+    }
+    update_free_space(page_handle);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+}
+
+/**
+ * @description: 把定长记录编码为slotted页面中的格式：定长字段原样复制，VARCHAR字段写入2字节长度和去掉补齐后的内容。
+ *              编码结果不足RM_MIN_PAYLOAD字节时补0
+ * @param {char*} buf 定长记录
+ * @param {char*} out 编码结果，至少RM_MAX_ENCODED_SIZE字节
+ * @return {int} 编码结果的长度
+ */
+int RmFileHandle::encode_record(const char* buf, char* out) const {
+    int pos = 0;
+    int len = 0;
+    for (int i = 0; i < file_hdr_.num_var_cols; i++) {
+        const RmColPos &col = file_hdr_.var_cols[i];
+        memcpy(out + len, buf + pos, col.offset - pos);
+        len += col.offset - pos;
+        auto n = static_cast<uint16_t>(strnlen(buf + col.offset, col.len));
+        memcpy(out + len, &n, sizeof(n));
+        memcpy(out + len + sizeof(n), buf + col.offset, n);
+        len += sizeof(n) + n;
+        pos = col.offset + col.len;
+    }
+    memcpy(out + len, buf + pos, file_hdr_.record_size - pos);
+    len += file_hdr_.record_size - pos;
+    if (len < RM_MIN_PAYLOAD) {
+        memset(out + len, 0, RM_MIN_PAYLOAD - len);
+        len = RM_MIN_PAYLOAD;
+    }
+    return len;
+}
+
+/**
+ * @description: 把encode_record()的结果还原为定长记录，VARCHAR字段补0
+ * @param {char*} data 编码后的记录
+ * @param {int} len data的长度
+ * @param {char*} out 定长记录，record_size字节
+ */
+void RmFileHandle::decode_record(const char* data, int len, char* out) const {
+    int pos = 0;
+    int in = 0;
+    for (int i = 0; i < file_hdr_.num_var_cols; i++) {
+        const RmColPos &col = file_hdr_.var_cols[i];
+        memcpy(out + pos, data + in, col.offset - pos);
+        in += col.offset - pos;
+        uint16_t n;
+        memcpy(&n, data + in, sizeof(n));
+        memcpy(out + col.offset, data + in + sizeof(n), n);
+        memset(out + col.offset + n, 0, col.len - n);
+        in += sizeof(n) + n;
+        pos = col.offset + col.len;
+    }
+    memcpy(out + pos, data + in, file_hdr_.record_size - pos);
+    assert(in + file_hdr_.record_size - pos <= len);
+}
+
+/**
+ * @description: 把slotted页面中slot_no处的记录解码为定长记录，记录已搬到其他页面时读取目标位置
+ * @param {RmPageHandle&} page_handle 记录的原始页面，调用者持有pin
+ * @param {int} slot_no 记录的slot号
+ * @param {char*} out 定长记录，record_size字节
+ */
+void RmFileHandle::read_slotted_record(const RmPageHandle& page_handle, int slot_no, char* out) const {
+    const RmSlot &slot = page_handle.slot_dir()[slot_no];
+    if (!(slot.offset & RM_SLOT_FORWARD)) {
+        decode_record(page_handle.get_payload(slot_no), slot.len, out);
+        return;
+    }
+    Rid target;
+    memcpy(&target, page_handle.get_payload(slot_no), sizeof(Rid));
+    RmPageHandle target_handle = fetch_page_handle(target.page_no);
+    decode_record(target_handle.get_payload(target.slot_no), target_handle.slot_dir()[target.slot_no].len, out);
+    buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), false);
+}
+
+/**
+ * @description: 把页面中slot_no处的记录按定长格式复制到out，slotted页面解码，PAX页面从各字段的minipage拼回整条记录
+ * @param {RmPageHandle&} page_handle 记录所在的页面，调用者持有pin
+ * @param {int} slot_no 记录的slot号
+ * @param {char*} out 定长记录，record_size字节
+ */
+void RmFileHandle::read_record(const RmPageHandle& page_handle, int slot_no, char* out) const {
+    if (is_slotted()) {
+        read_slotted_record(page_handle, slot_no, out);
+    } else if (is_pax()) {
+        for (int i = 0; i < file_hdr_.num_pax_cols; i++) {
+            const RmColPos &col = file_hdr_.pax_cols[i];
+            memcpy(out + col.offset, page_handle.get_pax_value(col, slot_no), col.len);
+        }
+    } else {
+        memcpy(out, page_handle.get_slot(slot_no), file_hdr_.record_size);
+    }
+}
+
+/**
+ * @description: 把定长记录按字段拆开写入PAX页面中各字段的minipage
+ */
+void RmFileHandle::write_pax_record(const RmPageHandle& page_handle, int slot_no, const char* buf) {
+    for (int i = 0; i < file_hdr_.num_pax_cols; i++) {
+        const RmColPos &col = file_hdr_.pax_cols[i];
+        memcpy(page_handle.get_pax_value(col, slot_no), buf + col.offset, col.len);
+    }
 }
 
 /**
@@ -121,13 +384,14 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
 /**
  * @description: 获取指定页面的页面句柄
  * @param {int} page_no 页面号
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，顺序扫描时传入buffer ring
  * @return {RmPageHandle} 指定页面的句柄
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+RmPageHandle RmFileHandle::fetch_page_handle(int page_no, BufferAccessStrategy *strategy) const {
     // Todo:
     // 使用缓冲池获取指定页面，并生成page_handle返回给上层
     // if page_no is invalid, throw PageNotExistError exception
-    Page* page = buffer_pool_manager_->fetch_page({fd_, page_no});
+    Page* page = buffer_pool_manager_->fetch_page({fd_, page_no}, strategy);
     if (page==nullptr) {
         throw PageNotExistError("zyz",page_no);
     }
@@ -135,7 +399,7 @@ RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
 }
 
 /**
- * @description: 创建一个新的page handle
+ * @description: 创建一个新的page handle。不持有fsm_latch_调用，file_hdr_.num_pages由调用者在认领页面时更新
  * @return {RmPageHandle} 新的PageHandle
  */
 RmPageHandle RmFileHandle::create_new_page_handle() {
@@ -147,47 +411,326 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
     pid.fd = fd_;
     pid.page_no = INVALID_PAGE_ID;
     Page* new_page = buffer_pool_manager_->new_page(&pid);
-    // 初始化页面头信息
-/*     page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+    if (new_page == nullptr) {
+        throw InternalError("RmFileHandle: no free frame for a new page");
+    }
+    // 初始化页面头信息，new_page已将页面清零
+    RmPageHandle page_handle(&file_hdr_, new_page);
+    page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
     page_handle.page_hdr->num_records = 0;
-    Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
+    if (is_slotted()) {
+        page_handle.init_slotted();
+    }
+    zone_map_.init_page(pid.page_no);
+    return page_handle;
+}
+
+/**
+ * @description: 当前线程使用的插入目标，按线程号哈希选择
  */
-file_hdr_.first_free_page_no=pid.page_no;
-    // 更新文件头信息
-    file_hdr_.num_pages++;
-    return RmPageHandle(&file_hdr_, new_page);
+RmInsertTarget &RmFileHandle::get_insert_target() {
+    return insert_targets_[std::hash<std::thread::id>()(std::this_thread::get_id()) % RM_INSERT_TARGETS];
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
+ * @brief 获取插入目标独占的一个放得下len字节记录的页面：优先使用目标当前的页面，放不下时在FSM中查找其他插入目标未占用的
+ * 空闲页面，都没有时创建新页面。FSM中的表项已过时(页面实际放不下)时将其更正后继续查找。调用者需持有target.latch
+ * 查找FSM、分配新页面和pin FSM页面时不持有fsm_latch_，只在认领页面、写入它的FSM表项时短暂持有
  *
+ * @param len 要插入的记录在页面中的长度
  * @return RmPageHandle 返回生成的空闲page handle
  * @note pin the page, remember to unpin it outside!
  */
-RmPageHandle RmFileHandle::create_page_handle() {
+RmPageHandle RmFileHandle::create_page_handle(RmInsertTarget &target, int len) {
     // Todo:
     // 1. 判断file_hdr_中是否还有空闲页
     //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
     //     1.2 有空闲页：直接获取第一个空闲页
     // 2. 生成page handle并返回给上层
-    if (file_hdr_.first_free_page_no == RM_NO_PAGE||file_hdr_.first_free_page_no ==file_hdr_.num_pages) {
-        auto page_handle = create_new_page_handle();
-        page_handle.page_hdr->next_free_page_no=file_hdr_.num_pages;
-        return page_handle;
-    } 
-     Page *page=buffer_pool_manager_->fetch_page({fd_,file_hdr_.first_free_page_no});
-    
-    return RmPageHandle(&file_hdr_, page);
+    while (true) {
+        // target.page_no只由持有target.latch的线程修改，这里读取不需要fsm_latch_
+        int page_no = target.page_no;
+        if (page_no == RM_NO_PAGE) {
+            page_no = fsm_find_page(target, len);
+            if (page_no == RM_NO_PAGE) {
+                RmPageHandle page_handle = create_new_page_handle();
+                page_no = page_handle.page->get_page_id().page_no;
+                Page *fsm_page = fsm_pin_page(page_no);
+                {
+                    std::scoped_lock lock{fsm_latch_};
+                    // 多分区缓冲池分配失败时会跳过页号，以实际分配到的页号为准
+                    file_hdr_.num_pages = std::max(file_hdr_.num_pages, page_no + 1);
+                    target.page_no = page_no;
+                    // 先按整页空闲记入FSM：偏大的表项会在使用时被更正，偏小则会丢失空闲空间
+                    fsm_set(fsm_page, page_no, page_free_space(page_handle));
+                }
+                buffer_pool_manager_->unpin_page(fsm_page->get_page_id(), true);
+                return page_handle;
+            }
+            std::scoped_lock lock{fsm_latch_};
+            // 查找时没有持有fsm_latch_，其他插入目标可能刚刚认领了这个页面，此时重新查找
+            if (page_claimed(page_no)) {
+                continue;
+            }
+            target.page_no = page_no;
+        }
+        RmPageHandle page_handle = fetch_page_handle(page_no);
+        if (page_has_room(page_handle, len)) {
+            return page_handle;
+        }
+        int free_space = page_free_space(page_handle);
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        Page *fsm_page = fsm_pin_page(page_no);
+        {
+            std::scoped_lock lock{fsm_latch_};
+            fsm_set(fsm_page, page_no, free_space);
+            target.page_no = RM_NO_PAGE;
+        }
+        buffer_pool_manager_->unpin_page(fsm_page->get_page_id(), true);
+    }
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: 页面中是否放得下一条在页面中长度为len的记录
  */
-void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
-    // Todo:
-    // 当page从已满变成未满，考虑如何更新：
-    // 1. page_handle.page_hdr->next_free_page_no
-    // 2. file_hdr_.first_free_page_no
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
-}
\ No newline at end of file
+bool RmFileHandle::page_has_room(const RmPageHandle &page_handle, int len) const {
+    if (page_handle.page_hdr->num_records >= file_hdr_.num_records_per_page) {
+        return false;
+    }
+    // 没有空闲的slot目录项时，还要为新的目录项留出空间
+    return !is_slotted() ||
+           page_handle.can_put(len, page_handle.page_hdr->num_records == page_handle.slotted_hdr()->num_slots);
+}
+
+/**
+ * @description: 页面在FSM中的空闲空间：定长页面为空闲slot数，slotted页面为还能放下的最长记录的长度，放不下任何记录时为0
+ */
+int RmFileHandle::page_free_space(const RmPageHandle &page_handle) const {
+    int free_slots = file_hdr_.num_records_per_page - page_handle.page_hdr->num_records;
+    if (!is_slotted() || free_slots == 0) {
+        return free_slots;
+    }
+    int free_bytes = page_handle.free_bytes();
+    if (page_handle.page_hdr->num_records == page_handle.slotted_hdr()->num_slots) {
+        free_bytes -= sizeof(RmSlot);
+    }
+    return free_bytes < RM_MIN_PAYLOAD ? 0 : free_bytes;
+}
+
+/**
+ * @description: 页面中的记录变化后，把它的空闲空间写入FSM
+ */
+void RmFileHandle::update_free_space(RmPageHandle &page_handle) {
+    int page_no = page_handle.page->get_page_id().page_no;
+    Page *fsm_page = fsm_pin_page(page_no);
+    {
+        std::scoped_lock lock{fsm_latch_};
+        fsm_set(fsm_page, page_no, page_free_space(page_handle));
+    }
+    buffer_pool_manager_->unpin_page(fsm_page->get_page_id(), true);
+}
+
+/**
+ * @description: 在FSM中为插入目标查找一个空闲空间不小于min_free、且未被其他插入目标占用的页面。从target.search_from开始向后查找，
+ *              到文件末尾后再从第一个数据页面找到起点。不持有fsm_latch_调用，找到的页面可能随后被其他插入目标认领，
+ *              调用者认领前需用page_claimed()再次检查
+ * @return {int} 找到的页号，没有时返回RM_NO_PAGE
+ */
+int RmFileHandle::fsm_find_page(RmInsertTarget &target, int min_free) {
+    int num_pages;
+    {
+        std::scoped_lock lock{fsm_latch_};
+        num_pages = file_hdr_.num_pages;
+    }
+    int num_record_pages = num_pages - RM_FIRST_RECORD_PAGE;
+    if (num_record_pages <= 0) {
+        return RM_NO_PAGE;
+    }
+    int start = target.search_from;
+    if (start < RM_FIRST_RECORD_PAGE || start >= num_pages) {
+        // 第一次查找时各目标的起点均匀分布在整个文件中
+        int64_t target_no = &target - insert_targets_;
+        start = RM_FIRST_RECORD_PAGE + static_cast<int>(target_no * num_record_pages / RM_INSERT_TARGETS);
+    }
+    // 定长页面的表项是空闲slot数，有一个空闲slot即可
+    min_free = is_slotted() ? min_free : 1;
+    int page_no = fsm_search(start, num_pages, min_free);
+    if (page_no == RM_NO_PAGE) {
+        page_no = fsm_search(RM_FIRST_RECORD_PAGE, start, min_free);
+    }
+    if (page_no != RM_NO_PAGE) {
+        target.search_from = page_no + 1;
+    }
+    return page_no;
+}
+
+/**
+ * @description: 在FSM中查找页号在[begin, end)内第一个空闲空间不小于min_free、且未被插入目标占用的页面。
+ *              读取FSM页面时持有其读latch，与fsm_set()的修改互斥
+ * @return {int} 找到的页号，没有时返回RM_NO_PAGE
+ */
+int RmFileHandle::fsm_search(int begin, int end, int min_free) {
+    int fsm_num_pages = disk_manager_->get_fd2pageno(fsm_fd_);
+    for (int page_no = begin; page_no < end;) {
+        int fsm_page_no = page_no / RM_FSM_ENTRIES_PER_PAGE;
+        if (fsm_page_no >= fsm_num_pages) {
+            break;
+        }
+        Page *page = buffer_pool_manager_->fetch_page({fsm_fd_, fsm_page_no});
+        if (page == nullptr) {
+            throw PageNotExistError(disk_manager_->get_file_name(fsm_fd_), fsm_page_no);
+        }
+        auto entries = reinterpret_cast<const uint16_t *>(page->get_data() + Page::OFFSET_PAGE_HDR);
+        int fsm_end = std::min(end, (fsm_page_no + 1) * RM_FSM_ENTRIES_PER_PAGE);
+        int found = RM_NO_PAGE;
+        page->rlatch();
+        for (; page_no < fsm_end && found == RM_NO_PAGE; page_no++) {
+            if (entries[page_no % RM_FSM_ENTRIES_PER_PAGE] >= min_free && !page_claimed(page_no)) {
+                found = page_no;
+            }
+        }
+        page->runlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+        if (found != RM_NO_PAGE) {
+            return found;
+        }
+    }
+    return RM_NO_PAGE;
+}
+
+/**
+ * @description: 页面是否是某个插入目标当前独占的插入页面。持有fsm_latch_时结果是准确的，否则只作为提示
+ */
+bool RmFileHandle::page_claimed(int page_no) const {
+    for (auto &target : insert_targets_) {
+        if (target.page_no == page_no) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: pin住记录数据页面page_no的FSM表项所在的FSM页面，FSM文件不够大时先扩展。不持有fsm_latch_调用，
+ *              这样缓冲池分配帧、读盘时不会阻塞其他线程对FSM表项的修改
+ * @return {Page*} pin住的FSM页面，调用者写入表项后需以脏页unpin
+ * @param {int} page_no 数据页面的页号
+ */
+Page *RmFileHandle::fsm_pin_page(int page_no) {
+    int fsm_page_no = page_no / RM_FSM_ENTRIES_PER_PAGE;
+    if (disk_manager_->get_fd2pageno(fsm_fd_) <= fsm_page_no) {
+        // 并发扩展时只由一个线程分配，避免多分配FSM页面
+        std::scoped_lock lock{fsm_extend_latch_};
+        while (disk_manager_->get_fd2pageno(fsm_fd_) <= fsm_page_no) {
+            PageId pid = {fsm_fd_, INVALID_PAGE_ID};
+            if (buffer_pool_manager_->new_page(&pid) == nullptr) {
+                throw InternalError("RmFileHandle: no free frame for a free space map page");
+            }
+            buffer_pool_manager_->unpin_page(pid, true);
+        }
+    }
+    Page *page = buffer_pool_manager_->fetch_page({fsm_fd_, fsm_page_no});
+    if (page == nullptr) {
+        throw PageNotExistError(disk_manager_->get_file_name(fsm_fd_), fsm_page_no);
+    }
+    return page;
+}
+
+/**
+ * @description: 把数据页面page_no的空闲空间写入已由fsm_pin_page()pin住的FSM页面。调用者需持有fsm_latch_
+ * @param {Page*} fsm_page page_no的表项所在的FSM页面
+ * @param {int} page_no 数据页面的页号
+ * @param {int} free_slots 该页面的空闲空间，见page_free_space()
+ */
+void RmFileHandle::fsm_set(Page *fsm_page, int page_no, int free_slots) {
+    auto entries = reinterpret_cast<uint16_t *>(fsm_page->get_data() + Page::OFFSET_PAGE_HDR);
+    fsm_page->wlatch();
+    entries[page_no % RM_FSM_ENTRIES_PER_PAGE] = static_cast<uint16_t>(free_slots);
+    fsm_page->wunlatch();
+}
+
+/**
+ * @description: 扫描所有数据页面重建FSM，用于打开没有FSM文件的旧数据文件
+ */
+void RmFileHandle::rebuild_fsm() {
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+        RmPageHandle page_handle = fetch_page_handle(page_no);
+        int free_slots = page_free_space(page_handle);
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        Page *fsm_page = fsm_pin_page(page_no);
+        {
+            std::scoped_lock lock{fsm_latch_};
+            fsm_set(fsm_page, page_no, free_slots);
+        }
+        buffer_pool_manager_->unpin_page(fsm_page->get_page_id(), true);
+    }
+}
+
+/**
+ * @description: 初始化新的slotted页面：slot目录为空，记录区从页尾开始
+ */
+void RmPageHandle::init_slotted() {
+    slotted_hdr()->num_slots = 0;
+    slotted_hdr()->heap_start = Page::OFFSET_CHECKSUM;
+}
+
+/**
+ * @description: 分配一个slot：优先复用slot目录中的空闲项，没有时在目录末尾追加一项。调用者需先用can_put()检查空间
+ * @return {int} 分配的slot号
+ */
+int RmPageHandle::alloc_slot() {
+    RmSlottedHdr *hdr = slotted_hdr();
+    int slot_no = Bitmap::first_bit(false, bitmap, hdr->num_slots);
+    if (slot_no == hdr->num_slots) {
+        slot_dir()[slot_no] = RmSlot{0, 0};
+        hdr->num_slots++;
+    }
+    return slot_no;
+}
+
+/**
+ * @description: 空闲空间能否放下len字节的记录
+ * @param {bool} new_slot 是否还要在slot目录末尾追加一项
+ */
+bool RmPageHandle::can_put(int len, bool new_slot) const {
+    return free_bytes() >= len + (new_slot ? static_cast<int>(sizeof(RmSlot)) : 0);
+}
+
+/**
+ * @description: 把len字节的记录写到记录区的最前面，并让slot_no的目录项指向它
+ */
+void RmPageHandle::put_payload(int slot_no, const char *data, int len, uint16_t flags) {
+    RmSlottedHdr *hdr = slotted_hdr();
+    hdr->heap_start -= len;
+    memcpy(page->get_data() + hdr->heap_start, data, len);
+    slot_dir()[slot_no] = RmSlot{static_cast<uint16_t>(hdr->heap_start | flags), static_cast<uint16_t>(len)};
+}
+
+/**
+ * @description: 从记录区中移除slot_no的记录：把它前面的记录整体后移填补空洞，保持记录区紧凑，slot_no的目录项清零
+ */
+void RmPageHandle::remove_payload(int slot_no) {
+    RmSlottedHdr *hdr = slotted_hdr();
+    RmSlot *dir = slot_dir();
+    int offset = dir[slot_no].offset & RM_SLOT_OFFSET_MASK;
+    int len = dir[slot_no].len;
+    char *data = page->get_data();
+    memmove(data + hdr->heap_start + len, data + hdr->heap_start, offset - hdr->heap_start);
+    for (int i = 0; i < hdr->num_slots; i++) {
+        if (i != slot_no && Bitmap::is_set(bitmap, i) && (dir[i].offset & RM_SLOT_OFFSET_MASK) < offset) {
+            dir[i].offset += len;
+        }
+    }
+    hdr->heap_start += len;
+    dir[slot_no] = RmSlot{0, 0};
+}
+
+/**
+ * @description: 截掉slot目录末尾的空闲项
+ */
+void RmPageHandle::trim_slot_dir() {
+    RmSlottedHdr *hdr = slotted_hdr();
+    while (hdr->num_slots > 0 && !Bitmap::is_set(bitmap, hdr->num_slots - 1)) {
+        hdr->num_slots--;
+    }
+}
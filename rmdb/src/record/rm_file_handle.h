@@ -12,11 +12,15 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_zone_map.h"
 
 class RmManager;
 
@@ -38,9 +42,57 @@ struct RmPageHandle {
     char* get_slot(int slot_no) const {
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // PAX页面中slot_no处记录的字段col的地址
+    char *get_pax_value(const RmColPos &col, int slot_no) const {
+        return slots + file_hdr->num_records_per_page * col.offset + slot_no * col.len;
+    }
+
+    /* 以下函数只用于RM_LAYOUT_SLOTTED格式的页面，slots指向RmSlottedHdr */
+
+    RmSlottedHdr *slotted_hdr() const { return reinterpret_cast<RmSlottedHdr *>(slots); }
+
+    RmSlot *slot_dir() const { return reinterpret_cast<RmSlot *>(slots + sizeof(RmSlottedHdr)); }
+
+    // slot_no处记录在页面中的地址
+    char *get_payload(int slot_no) const {
+        return page->get_data() + (slot_dir()[slot_no].offset & RM_SLOT_OFFSET_MASK);
+    }
+
+    // slot目录末尾与记录区之间的空闲字节数
+    int free_bytes() const {
+        return slotted_hdr()->heap_start - static_cast<int>(slots + sizeof(RmSlottedHdr) - page->get_data()) -
+               slotted_hdr()->num_slots * static_cast<int>(sizeof(RmSlot));
+    }
+
+    void init_slotted();
+
+    int alloc_slot();
+
+    bool can_put(int len, bool new_slot) const;
+
+    void put_payload(int slot_no, const char *data, int len, uint16_t flags);
+
+    void remove_payload(int slot_no);
+
+    void trim_slot_dir();
 };
 
-/* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
+/* 插入目标：插入线程按线程号哈希到某个目标，每个目标独占一个当前插入页面，因此并发的插入分散在不同页面上 */
+struct RmInsertTarget {
+    std::mutex latch;               // 同一目标上的插入串行执行
+    // 该目标当前独占的插入页面，只在持有RmFileHandle::fsm_latch_时修改；在FSM中查找空闲页面时不加锁读取，只作为提示
+    std::atomic<int> page_no{RM_NO_PAGE};
+    int search_from = RM_NO_PAGE;   // 下次在FSM中查找空闲页面的起点，各目标从文件的不同位置开始查找
+};
+
+/* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中
+ * 数据文件中各页面的空闲空间记录在同名的FSM文件(filename + RM_FSM_SUFFIX)中，FSM页面经过缓冲池读写，
+ * 随其他页面一起持久化。FSM只是提示：插入前总会检查页面本身，过时的表项在使用时被更正
+ * 有VARCHAR字段的表使用slotted页面：记录写入时由encode_record()去掉VARCHAR的补齐，读出时由decode_record()还原成定长记录，
+ * 页面在删除和更新时原地整理，rid在记录的整个生命周期内不变
+ * 以layout = pax创建的表使用PAX页面：记录按字段拆开写入各字段的minipage，读出整条记录时再拼回定长格式
+ * 插入、更新、删除记录时按rid所在的页面维护内存中的zone map，扫描据此跳过页面 */
 class RmFileHandle {      
     friend class RmScan;    
     friend class RmManager;
@@ -49,30 +101,66 @@ class RmFileHandle {
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
+    int fsm_fd_;    // FSM文件的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    std::mutex fsm_latch_;  // 保护FSM表项的修改、file_hdr_.num_pages和各插入目标对页面的认领，持有期间不调用缓冲池
+    std::mutex fsm_extend_latch_;   // 扩展FSM文件时持有
+    RmInsertTarget insert_targets_[RM_INSERT_TARGETS];
+    mutable RmZoneMap zone_map_;    // 各页面数值字段的最小/最大值，扫描时计算范围未知的页面
 
    public:
-    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
-        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, int fsm_fd)
+        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd), fsm_fd_(fsm_fd),
+          zone_map_(&file_hdr_) {
         // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
         // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
         // init file_hdr_
-        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+        read_file_hdr(disk_manager_, fd, &file_hdr_);
+        // 文件头中的num_pages只在关闭文件时写回，崩溃后可能小于文件中实际的页数，取二者中较大的，
+        // 避免把已经写到磁盘上的页面再分配一次
+        int file_pages = disk_manager_->get_file_size(disk_manager_->get_file_name(fd)) / PAGE_SIZE;
+        file_hdr_.num_pages = std::max(file_hdr_.num_pages, file_pages);
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        // FSM文件没有文件头，页数由文件大小决定
+        disk_manager_->set_fd2pageno(fsm_fd, disk_manager_->get_file_size(disk_manager_->get_file_name(fsm_fd)) / PAGE_SIZE);
+    }
+
+    /**
+     * @description: 读出数据文件的文件头。旧的空数据文件只有旧的文件头那么大，之后加入的字段保持为0
+     */
+    static void read_file_hdr(DiskManager *disk_manager, int fd, RmFileHdr *file_hdr) {
+        *file_hdr = {};
+        int file_size = disk_manager->get_file_size(disk_manager->get_file_name(fd));
+        int hdr_len = std::min(static_cast<int>(sizeof(RmFileHdr)), file_size);
+        disk_manager->read_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(file_hdr), hdr_len);
     }
 
     RmFileHdr get_file_hdr() const { return file_hdr_; }
+    bool is_slotted() const { return file_hdr_.layout == RM_LAYOUT_SLOTTED; }
+    bool is_pax() const { return file_hdr_.layout == RM_LAYOUT_PAX; }
     int GetFd() { return fd_; }
 
+    // offset处的字段在zone map中的下标，没有zone map时为-1
+    int get_zone_col(int offset) const { return zone_map_.find_col(offset); }
+
+    RmZoneState get_zone_state(int page_no) const { return zone_map_.get_state(page_no); }
+
     /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
     bool is_record(const Rid &rid) const {
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        bool is_set = Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        if (is_set && is_slotted()) {
+            is_set = !(page_handle.slot_dir()[rid.slot_no].offset & RM_SLOT_MOVED);
+        }
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        return is_set;
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    RmRecordView get_record_view(const Rid &rid, Context *context) const;
+
     Rid insert_record(char *buf, Context *context);
 
     void insert_record(const Rid &rid, char *buf);
@@ -83,10 +171,44 @@ class RmFileHandle {
 
     RmPageHandle create_new_page_handle();
 
-    RmPageHandle fetch_page_handle(int page_no) const;
+    RmPageHandle fetch_page_handle(int page_no, BufferAccessStrategy *strategy = nullptr) const;
+
+    int encode_record(const char *buf, char *out) const;
+
+    void decode_record(const char *data, int len, char *out) const;
+
+    void read_slotted_record(const RmPageHandle &page_handle, int slot_no, char *out) const;
+
+    void read_record(const RmPageHandle &page_handle, int slot_no, char *out) const;
+
+    void write_pax_record(const RmPageHandle &page_handle, int slot_no, const char *buf);
 
    private:
-    RmPageHandle create_page_handle();
+    RmInsertTarget &get_insert_target();
+
+    RmPageHandle create_page_handle(RmInsertTarget &target, int len);
+
+    Rid insert_payload(const char *data, int len, uint16_t flags);
+
+    void update_slotted_record(const Rid &rid, const char *data, int len);
+
+    void delete_moved_record(const Rid &rid);
+
+    bool page_has_room(const RmPageHandle &page_handle, int len) const;
+
+    int page_free_space(const RmPageHandle &page_handle) const;
+
+    void update_free_space(RmPageHandle &page_handle);
+
+    int fsm_find_page(RmInsertTarget &target, int min_free);
+
+    bool page_claimed(int page_no) const;
+
+    int fsm_search(int begin, int end, int min_free);
+
+    Page *fsm_pin_page(int page_no);
+
+    void fsm_set(Page *fsm_page, int page_no, int free_slots);
 
-    void release_page_handle(RmPageHandle &page_handle);
+    void rebuild_fsm();
 };
\ No newline at end of file
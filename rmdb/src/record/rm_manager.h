@@ -12,11 +12,15 @@ See the Mulan PSL v2 for more details. */
 
 #include <assert.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "bitmap.h"
 #include "rm_defs.h"
 #include "rm_file_handle.h"
 
-/* 记录管理器，用于管理表的数据文件，进行文件的创建、打开、删除、关闭 */
+/* 记录管理器，用于管理表的数据文件，进行文件的创建、打开、删除、关闭
+ * 每个数据文件filename都有一个记录各页面空闲空间的FSM文件filename + RM_FSM_SUFFIX，二者一起创建、打开、关闭和删除 */
 class RmManager {
    private:
     DiskManager *disk_manager_;
@@ -30,35 +34,82 @@ class RmManager {
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
      * @param {int} record_size 表中记录的大小
+     * @param {vector<RmColPos>&} var_cols 表中的VARCHAR字段，按offset升序；非空时数据文件使用slotted页面
+     * @param {vector<RmColPos>&} pax_cols 表中的全部字段，按offset升序；非空时数据文件使用PAX页面，VARCHAR字段按定长存储
+     * @param {vector<RmZoneCol>&} zone_cols 维护zone map的数值字段，扫描时据此跳过不可能满足条件的页面
      */ 
-    void create_file(const std::string& filename, int record_size) {
+    void create_file(const std::string& filename, int record_size, const std::vector<RmColPos>& var_cols = {},
+                     const std::vector<RmColPos>& pax_cols = {}, const std::vector<RmZoneCol>& zone_cols = {}) {
         if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
             throw InvalidRecordSizeError(record_size);
         }
+        if (var_cols.size() > RM_MAX_VAR_COLS) {
+            throw InternalError("RmManager: too many VARCHAR columns");
+        }
+        if (pax_cols.size() > RM_MAX_PAX_COLS) {
+            throw InternalError("RmManager: too many columns for layout = pax");
+        }
+        if (zone_cols.size() > RM_MAX_ZONE_COLS) {
+            throw InternalError("RmManager: too many zone map columns");
+        }
+        bool slotted = pax_cols.empty() && !var_cols.empty();
         disk_manager_->create_file(filename);
         int fd = disk_manager_->open_file(filename);
+        bool checksums = disk_manager_->page_checksums();
+        disk_manager_->set_file_checksums(fd, checksums);
 
         // 初始化file header
         RmFileHdr file_hdr{};
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+        if (!pax_cols.empty()) {
+            file_hdr.layout = RM_LAYOUT_PAX;
+            file_hdr.num_pax_cols = static_cast<int>(pax_cols.size());
+            std::copy(pax_cols.begin(), pax_cols.end(), file_hdr.pax_cols);
+        } else if (slotted) {
+            file_hdr.layout = RM_LAYOUT_SLOTTED;
+            file_hdr.num_var_cols = static_cast<int>(var_cols.size());
+            std::copy(var_cols.begin(), var_cols.end(), file_hdr.var_cols);
+        } else {
+            file_hdr.layout = RM_LAYOUT_FIXED;
+        }
+        file_hdr.num_zone_cols = static_cast<int>(zone_cols.size());
+        std::copy(zone_cols.begin(), zone_cols.end(), file_hdr.zone_cols);
+        // 每个slot占用的空间：定长和PAX页面为一条记录；slotted页面按最短的记录估计，加上一个slot目录项
+        int slot_size = record_size;
+        int page_space = static_cast<int>(Page::OFFSET_CHECKSUM - Page::OFFSET_PAGE_HDR - sizeof(RmPageHdr));
+        if (slotted) {
+            slot_size = record_size + file_hdr.num_var_cols * static_cast<int>(sizeof(uint16_t));
+            for (auto &col : var_cols) {
+                slot_size -= col.len;
+            }
+            slot_size = std::max(slot_size, RM_MIN_PAYLOAD) + static_cast<int>(sizeof(RmSlot));
+            page_space -= sizeof(RmSlottedHdr);
+        }
+        // We have: (n + 7) / 8 + n * slot_size <= page_space
+        file_hdr.num_records_per_page = (BITMAP_WIDTH * page_space) / (1 + slot_size * BITMAP_WIDTH);
         file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.page_checksums = checksums;
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
         disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
         disk_manager_->close_file(fd);
+        // FSM文件初始为空，第一次记录空闲空间时再分配FSM页面
+        disk_manager_->create_file(filename + RM_FSM_SUFFIX);
     }
 
     /**
      * @description: 删除表的数据文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        if (disk_manager_->is_file(filename + RM_FSM_SUFFIX)) {
+            disk_manager_->destroy_file(filename + RM_FSM_SUFFIX);
+        }
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
@@ -68,7 +119,26 @@ class RmManager {
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        // 先不校验地读出文件头，按其中的记录设置数据文件和FSM文件是否使用校验和
+        RmFileHdr file_hdr;
+        RmFileHandle::read_file_hdr(disk_manager_, fd, &file_hdr);
+        if (file_hdr.page_checksums && !reserves_checksum(file_hdr)) {
+            disk_manager_->close_file(fd);
+            throw InternalError("RmManager: " + filename + " has page checksums but no space reserved for them");
+        }
+        disk_manager_->set_file_checksums(fd, file_hdr.page_checksums);
+        // 没有FSM文件的旧数据文件在第一次打开时扫描全部页面重建FSM
+        bool rebuild_fsm = !disk_manager_->is_file(filename + RM_FSM_SUFFIX);
+        if (rebuild_fsm) {
+            disk_manager_->create_file(filename + RM_FSM_SUFFIX);
+        }
+        int fsm_fd = disk_manager_->open_file(filename + RM_FSM_SUFFIX);
+        disk_manager_->set_file_checksums(fsm_fd, file_hdr.page_checksums);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd, fsm_fd);
+        if (rebuild_fsm) {
+            file_handle->rebuild_fsm();
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
@@ -79,6 +149,23 @@ class RmManager {
                                   sizeof(file_handle->file_hdr_));
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
+        buffer_pool_manager_->flush_all_pages(file_handle->fsm_fd_);
         disk_manager_->close_file(file_handle->fd_);
+        disk_manager_->close_file(file_handle->fsm_fd_);
+    }
+
+   private:
+    /**
+     * @description: 文件头记录的页面格式是否在页尾为校验和留出了空间：定长和PAX页面的slot、slotted页面的slot目录
+     *              都在Page::OFFSET_CHECKSUM之前结束(slotted页面的记录区总是在OFFSET_CHECKSUM处结束)
+     */
+    static bool reserves_checksum(const RmFileHdr &file_hdr) {
+        int entry_size = file_hdr.record_size;
+        int page_end = static_cast<int>(Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr)) + file_hdr.bitmap_size;
+        if (file_hdr.layout == RM_LAYOUT_SLOTTED) {
+            entry_size = sizeof(RmSlot);
+            page_end += sizeof(RmSlottedHdr);
+        }
+        return page_end + file_hdr.num_records_per_page * entry_size <= static_cast<int>(Page::OFFSET_CHECKSUM);
     }
 };
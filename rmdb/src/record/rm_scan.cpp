@@ -9,62 +9,168 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "rm_scan.h"
+
+#include <algorithm>
+
 #include "rm_file_handle.h"
 
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @param zone_preds 用于跳过页面的谓词，只有记录满足所有谓词时才需要扫描出来
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, std::vector<RmZonePred> zone_preds)
+    : file_handle_(file_handle), prefetch_next_(1), zone_preds_(std::move(zone_preds)) {
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
     // 初始化rid_，找到第一个存放了记录的位置
-// 获取文件头信息
-auto file_header = file_handle_->file_hdr_;
-
-// 初始化页号和插槽号为无效值
-page_id_t page_no = -1;
-int slot_no = -1;
-
-// 循环遍历文件的每一页，寻找第一个非空闲插槽
-for (page_no = 1; page_no < file_header.num_pages; ++page_no) {
-    auto page_handle = file_handle->fetch_page_handle(page_no); // 获取当前页的页面句柄
-    int first_free_slot = Bitmap::first_bit(true, page_handle.bitmap, file_header.num_records_per_page);// 查找页面中第一个空闲插槽的位置
-    file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
-    // 如果找到了空闲插槽，则记录页号和插槽号，并结束循环
-    if (first_free_slot < file_header.num_records_per_page) {
-        slot_no = first_free_slot;
-        break;
+    // 表的页数超过缓冲池的一定比例时，使用buffer ring扫描，避免把其他页面挤出缓冲池
+    if (file_handle_->file_hdr_.num_pages >
+        static_cast<int>(file_handle_->buffer_pool_manager_->get_pool_size() / SCAN_RING_THRESHOLD_DIVISOR)) {
+        strategy_ = std::make_unique<BufferAccessStrategy>();
     }
+    page_slots_.reserve(file_handle_->file_hdr_.num_records_per_page);
+    if (file_handle_->file_hdr_.layout != RM_LAYOUT_FIXED) {
+        record_buf_.resize(file_handle_->file_hdr_.record_size);
+    }
+    // 第0页是文件头，从第1页的前一页开始，next_page()定位到第一个存放了记录的页面
+    rid_ = Rid{0, -1};
+    next_page();
 }
-if (slot_no == -1) {
-    page_no = -1;
-}
-rid_ = Rid{page_no, slot_no};
 
-}
+RmScan::~RmScan() { release_page(); }
 
 /**
- * @brief 找到文件中下一个存放了记录的位置
+ * @brief 找到文件中下一个存放了记录的位置；当前页面还有记录时不访问缓冲池
  */
 void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
-auto hdr = file_handle_->file_hdr_;
-int num_slot = hdr.num_records_per_page;
+    if (is_end()) {
+        return;
+    }
+    if (++slot_idx_ < page_slots_.size()) {
+        rid_.slot_no = page_slots_[slot_idx_];
+        return;
+    }
+    next_page();
+}
+
+/**
+ * @brief 放弃当前页面剩余的记录，unpin当前页面并移动到下一个存放了记录的页面，rid_指向该页面的第一条记录
+ * @return 是否还有页面，没有时扫描结束
+ */
+bool RmScan::next_page() {
+    release_page();
+    if (is_end()) {
+        return false;
+    }
+    const RmFileHdr &hdr = file_handle_->file_hdr_;
+    RmZoneMap &zone_map = file_handle_->zone_map_;
+    for (int page_no = rid_.page_no + 1; page_no < hdr.num_pages; ++page_no) {
+        if (!zone_preds_.empty() && !zone_map.may_match(page_no, zone_preds_)) {
+            continue;
+        }
+        prefetch(page_no);
+        RmPageHandle page_handle = file_handle_->fetch_page_handle(page_no, strategy_.get());
+        page_slots_.resize(hdr.num_records_per_page);
+        page_slots_.resize(Bitmap::get_set_bits(page_handle.bitmap, hdr.num_records_per_page, page_slots_.data()));
+        if (file_handle_->is_slotted()) {
+            // 搬来的记录通过原位置的RM_SLOT_FORWARD返回
+            const RmSlot *dir = page_handle.slot_dir();
+            page_slots_.erase(std::remove_if(page_slots_.begin(), page_slots_.end(),
+                                             [dir](int slot_no) { return dir[slot_no].offset & RM_SLOT_MOVED; }),
+                              page_slots_.end());
+        }
+        refresh_zone(page_handle);
+        if (!page_slots_.empty() && (zone_preds_.empty() || zone_map.may_match(page_no, zone_preds_))) {
+            page_ = page_handle.page;
+            slots_ = page_handle.slots;
+            slot_idx_ = 0;
+            rid_ = Rid{page_no, page_slots_[0]};
+            return true;
+        }
+        file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    }
+    rid_ = Rid{-1, -1};
+    return false;
+}
 
-for (int page_no = rid_.page_no; page_no < hdr.num_pages; ++page_no) {
-    auto page_handle = file_handle_->fetch_page_handle(page_no);
-    int slot_no = Bitmap::next_bit(true, page_handle.bitmap, num_slot, rid_.slot_no); // 找到此page内第一个记录
-    file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
-    if (slot_no < num_slot) {
-        rid_ = {page_no, slot_no};
+/**
+ * @brief unpin当前pin住的页面
+ */
+void RmScan::release_page() {
+    if (page_ != nullptr) {
+        file_handle_->buffer_pool_manager_->unpin_page(page_->get_page_id(), false);
+        page_ = nullptr;
+        slots_ = nullptr;
+    }
+    page_slots_.clear();
+}
+
+/**
+ * @brief 页面的zone范围不精确时，用页面上的全部记录(page_slots_)重新计算
+ */
+void RmScan::refresh_zone(const RmPageHandle &page_handle) {
+    RmZoneMap &zone_map = file_handle_->zone_map_;
+    int page_no = page_handle.page->get_page_id().page_no;
+    uint64_t version;
+    if (!zone_map.needs_refresh(page_no, version)) {
         return;
     }
-    rid_.slot_no = -1;
+    zone_bounds_.resize(2 * file_handle_->file_hdr_.num_zone_cols);
+    zone_map.reset_bounds(zone_bounds_.data());
+    for (int slot_no : page_slots_) {
+        if (file_handle_->file_hdr_.layout == RM_LAYOUT_FIXED) {
+            zone_map.add_record(zone_bounds_.data(), page_handle.get_slot(slot_no));
+        } else {
+            file_handle_->read_record(page_handle, slot_no, record_buf_.data());
+            zone_map.add_record(zone_bounds_.data(), record_buf_.data());
+        }
+    }
+    zone_map.finish_refresh(page_no, version, zone_bounds_.data());
+}
+
+/**
+ * @brief 当前页面上slot_no处记录的数据，指针在扫描器离开当前页面前有效；slotted和PAX页面的记录复制到record_buf_中，
+ * 指针在下一次调用前有效
+ */
+const char *RmScan::get_slot_data(int slot_no) const {
+    assert(page_ != nullptr);
+    if (file_handle_->file_hdr_.layout != RM_LAYOUT_FIXED) {
+        file_handle_->read_record(RmPageHandle(&file_handle_->file_hdr_, page_), slot_no, record_buf_.data());
+        return record_buf_.data();
+    }
+    return slots_ + slot_no * file_handle_->file_hdr_.record_size;
 }
-rid_ = {-1, -1};
 
+/**
+ * @brief 当前页面上一个字段的所有值：定长页面中按记录跨步访问，PAX页面中是字段连续的minipage
+ */
+RmColumnView RmScan::get_column(int offset, int len) const {
+    assert(page_ != nullptr && !file_handle_->is_slotted());
+    const RmFileHdr &hdr = file_handle_->file_hdr_;
+    if (file_handle_->is_pax()) {
+        return RmColumnView{slots_ + hdr.num_records_per_page * offset, len};
+    }
+    return RmColumnView{slots_ + offset, hdr.record_size};
+}
+
+/**
+ * @brief 扫描到page_no时，若已提交预读的页面不足SCAN_PREFETCH_DISTANCE的一半，
+ * 则异步预读到page_no + SCAN_PREFETCH_DISTANCE为止，使磁盘读取与记录处理重叠
+ */
+void RmScan::prefetch(int page_no) {
+    if (prefetch_next_ - page_no > SCAN_PREFETCH_DISTANCE / 2) {
+        return;
+    }
+    prefetch_next_ = std::max(prefetch_next_, page_no + 1);
+    int end = std::min(page_no + SCAN_PREFETCH_DISTANCE, file_handle_->file_hdr_.num_pages);
+    if (prefetch_next_ < end) {
+        file_handle_->buffer_pool_manager_->prefetch_pages(file_handle_->fd_, prefetch_next_, end - prefetch_next_,
+                                                           strategy_.get());
+        prefetch_next_ = end;
+    }
 }
 
 /**
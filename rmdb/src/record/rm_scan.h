@@ -10,19 +10,74 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "rm_defs.h"
+#include "rm_zone_map.h"
 
 class RmFileHandle;
+struct RmPageHandle;
+
+/* 当前页面上一个字段的所有值，slot_no处记录的该字段位于base + slot_no * stride */
+struct RmColumnView {
+    const char *base;
+    int stride;
+};
 
+/**
+ * @description: 按页扫描表中的记录。扫描器一次只pin住一个页面，进入页面时用位图一次性取出该页上所有记录的slot号，
+ * 页内的记录可以通过get_slot_data()/record_data()零拷贝地直接访问；离开页面(next_page()或析构)时才unpin。
+ * 返回的指针只在扫描器停留在当前页面期间有效。slotted页面中的记录是变长编码的，get_slot_data()把它解码到扫描器内部的
+ * 缓冲区中，返回的指针在下一次调用前有效；从其他页面搬来的记录只通过原rid返回一次。PAX页面中的记录同样拼到缓冲区中，
+ * 只需要个别字段时用get_column()直接访问字段的minipage。
+ * 给出zone_preds时，跳过zone map表明不可能有满足条件的记录的页面，这些页面不会被读取；扫描读到的范围不精确的页面顺便重新计算其范围。
+ */
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    std::unique_ptr<BufferAccessStrategy> strategy_;    // 大表扫描使用的buffer ring，小表为nullptr
+    int prefetch_next_;                                 // 下一个尚未提交预读的页号
+
+    Page *page_ = nullptr;              // 当前pin住的页面，扫描结束后为nullptr
+    const char *slots_ = nullptr;       // 当前页面slot区的首地址
+    std::vector<int> page_slots_;       // 当前页面上所有存放了记录的slot号，升序
+    size_t slot_idx_ = 0;               // rid_在page_slots_中的下标
+    mutable std::vector<char> record_buf_;  // slotted页面中解码出的记录或PAX页面中拼出的记录
+    std::vector<RmZonePred> zone_preds_;    // 用于跳过页面的谓词
+    std::vector<double> zone_bounds_;       // 重新计算页面范围时使用
+
+    void prefetch(int page_no);
+
+    void release_page();
+
+    void refresh_zone(const RmPageHandle &page_handle);
+
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, std::vector<RmZonePred> zone_preds = {});
+
+    ~RmScan();
+
+    RmScan(const RmScan &) = delete;
+    RmScan &operator=(const RmScan &) = delete;
 
     void next() override;
 
+    bool next_page();
+
     bool is_end() const override;
 
     Rid rid() const override;
+
+    // 当前页面上所有存放了记录的slot号
+    const std::vector<int> &page_slots() const { return page_slots_; }
+
+    // 当前页面上slot_no处记录的数据，直接指向缓冲池中的页面
+    const char *get_slot_data(int slot_no) const;
+
+    // rid_指向的记录的数据，直接指向缓冲池中的页面
+    const char *record_data() const { return get_slot_data(rid_.slot_no); }
+
+    // 当前页面上定长记录中[offset, offset + len)处字段的所有值，slotted页面中的字段不能直接访问
+    RmColumnView get_column(int offset, int len) const;
 };
@@ -0,0 +1,200 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "rm_zone_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+/**
+ * @description: 查找offset处的字段在zone_cols中的下标
+ * @return {int} 下标，该字段没有zone map时为-1
+ */
+int RmZoneMap::find_col(int offset) const {
+    for (int i = 0; i < num_cols(); i++) {
+        if (file_hdr_->zone_cols[i].offset == offset) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @description: 把bounds置为空范围(min = +inf, max = -inf)
+ */
+void RmZoneMap::reset_bounds(double *bounds) const {
+    for (int i = 0; i < num_cols(); i++) {
+        bounds[2 * i] = std::numeric_limits<double>::infinity();
+        bounds[2 * i + 1] = -std::numeric_limits<double>::infinity();
+    }
+}
+
+/**
+ * @description: 把定长记录buf中各zone字段的值并入bounds。int和float都能用double精确表示
+ */
+void RmZoneMap::add_record(double *bounds, const char *buf) const {
+    for (int i = 0; i < num_cols(); i++) {
+        const RmZoneCol &col = file_hdr_->zone_cols[i];
+        double val;
+        if (col.type == TYPE_INT) {
+            int x;
+            memcpy(&x, buf + col.offset, sizeof(x));
+            val = x;
+        } else {
+            float x;
+            memcpy(&x, buf + col.offset, sizeof(x));
+            val = x;
+        }
+        bounds[2 * i] = std::min(bounds[2 * i], val);
+        bounds[2 * i + 1] = std::max(bounds[2 * i + 1], val);
+    }
+}
+
+/**
+ * @description: 扩展entries_和bounds_使其包含page_no，调用者需持有latch_
+ */
+void RmZoneMap::ensure_page(int page_no) {
+    if (page_no >= static_cast<int>(entries_.size())) {
+        entries_.resize(page_no + 1);
+        bounds_.resize(entries_.size() * 2 * num_cols());
+    }
+}
+
+/**
+ * @description: 新分配的页面上没有记录，范围为空且精确
+ */
+void RmZoneMap::init_page(int page_no) {
+    if (!enabled()) {
+        return;
+    }
+    std::scoped_lock lock{latch_};
+    ensure_page(page_no);
+    reset_bounds(&bounds_[page_no * 2 * num_cols()]);
+    entries_[page_no].state = RM_ZONE_EXACT;
+    entries_[page_no].version++;
+}
+
+/**
+ * @description: 页面page_no上插入或更新了记录buf之后扩大页面的范围，范围未知的页面保持未知
+ * @param {bool} loose 更新时为true：旧值仍计在范围内，范围变为不精确
+ */
+void RmZoneMap::on_write(int page_no, const char *buf, bool loose) {
+    if (!enabled()) {
+        return;
+    }
+    std::scoped_lock lock{latch_};
+    ensure_page(page_no);
+    ZoneEntry &entry = entries_[page_no];
+    entry.version++;
+    if (entry.state == RM_ZONE_UNKNOWN) {
+        return;
+    }
+    add_record(&bounds_[page_no * 2 * num_cols()], buf);
+    if (loose) {
+        entry.state = RM_ZONE_LOOSE;
+    }
+}
+
+/**
+ * @description: 页面page_no上删除了记录，范围不变但不再精确
+ */
+void RmZoneMap::on_delete(int page_no) {
+    if (!enabled()) {
+        return;
+    }
+    std::scoped_lock lock{latch_};
+    ensure_page(page_no);
+    ZoneEntry &entry = entries_[page_no];
+    entry.version++;
+    if (entry.state == RM_ZONE_EXACT) {
+        entry.state = RM_ZONE_LOOSE;
+    }
+}
+
+/**
+ * @description: 页面的范围是否需要重新计算
+ * @param {uint64_t&} version 需要时返回页面当前的版本号，传给finish_refresh()
+ */
+bool RmZoneMap::needs_refresh(int page_no, uint64_t &version) {
+    if (!enabled()) {
+        return false;
+    }
+    std::scoped_lock lock{latch_};
+    ensure_page(page_no);
+    version = entries_[page_no].version;
+    return entries_[page_no].state != RM_ZONE_EXACT;
+}
+
+/**
+ * @description: 用扫描页面上全部记录得到的bounds替换页面的范围。页面的版本号不再是version，说明计算期间页面有写入，放弃bounds
+ */
+void RmZoneMap::finish_refresh(int page_no, uint64_t version, const double *bounds) {
+    std::scoped_lock lock{latch_};
+    ZoneEntry &entry = entries_[page_no];
+    if (entry.version != version) {
+        return;
+    }
+    std::copy(bounds, bounds + 2 * num_cols(), &bounds_[page_no * 2 * num_cols()]);
+    entry.state = RM_ZONE_EXACT;
+}
+
+/**
+ * @description: 页面page_no上是否可能有满足所有谓词的记录，范围未知的页面总是返回true
+ */
+bool RmZoneMap::may_match(int page_no, const std::vector<RmZonePred> &preds) {
+    std::scoped_lock lock{latch_};
+    if (page_no >= static_cast<int>(entries_.size()) || entries_[page_no].state == RM_ZONE_UNKNOWN) {
+        return true;
+    }
+    const double *bounds = &bounds_[page_no * 2 * num_cols()];
+    for (auto &pred : preds) {
+        double min = bounds[2 * pred.zone_col];
+        double max = bounds[2 * pred.zone_col + 1];
+        if (min > max) {
+            return false;   // 页面上没有记录
+        }
+        bool match;
+        switch (pred.op) {
+            case OP_EQ:
+                match = min <= pred.val && pred.val <= max;
+                break;
+            case OP_NE:
+                match = !(min == pred.val && max == pred.val);
+                break;
+            case OP_LT:
+                match = min < pred.val;
+                break;
+            case OP_LE:
+                match = min <= pred.val;
+                break;
+            case OP_GT:
+                match = max > pred.val;
+                break;
+            case OP_GE:
+                match = max >= pred.val;
+                break;
+            default:
+                match = true;
+        }
+        if (!match) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RmZoneState RmZoneMap::get_state(int page_no) {
+    std::scoped_lock lock{latch_};
+    if (page_no >= static_cast<int>(entries_.size())) {
+        return RM_ZONE_UNKNOWN;
+    }
+    return entries_[page_no].state;
+}
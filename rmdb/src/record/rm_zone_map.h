@@ -0,0 +1,78 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/common.h"
+#include "rm_defs.h"
+
+/* 用于跳过页面的谓词：zone字段 op val */
+struct RmZonePred {
+    int zone_col;   // 字段在RmFileHdr::zone_cols中的下标
+    CompOp op;
+    double val;
+};
+
+/* 页面的zone范围的状态 */
+enum RmZoneState : uint8_t {
+    RM_ZONE_UNKNOWN = 0,    // 打开文件后还没有扫描过该页面，不能用来跳过页面
+    RM_ZONE_EXACT,          // 范围恰好是页面上所有记录的最小/最大值
+    RM_ZONE_LOOSE,          // 删除或更新后范围可能比实际的大，仍可用来跳过页面，下一次扫描读到页面时重新计算
+};
+
+/**
+ * @description: 表数据文件中每个页面上数值字段(RmFileHdr::zone_cols)的最小/最大值，即zone map，扫描时跳过范围不可能满足谓词的页面。
+ * zone map只保存在内存中，打开文件时所有页面的范围未知，由扫描读到页面时计算(RmScan)；新分配的页面范围为空。
+ * 插入和更新只扩大页面的范围，删除不缩小范围，因此范围总是包含页面上所有记录的取值，只会少跳过页面、不会跳错。
+ * 页面范围的每次修改都会增加其版本号，扫描计算范围期间页面有写入时放弃计算结果
+ */
+class RmZoneMap {
+    struct ZoneEntry {
+        RmZoneState state = RM_ZONE_UNKNOWN;
+        uint64_t version = 0;
+    };
+
+    const RmFileHdr *file_hdr_;
+    std::mutex latch_;                  // 保护entries_和bounds_
+    std::vector<ZoneEntry> entries_;    // 按页号下标，超出的页面范围未知
+    std::vector<double> bounds_;        // 每个页面2 * num_zone_cols个值，依次为每个字段的min, max
+
+    int num_cols() const { return file_hdr_->num_zone_cols; }
+
+    void ensure_page(int page_no);
+
+   public:
+    explicit RmZoneMap(const RmFileHdr *file_hdr) : file_hdr_(file_hdr) {}
+
+    bool enabled() const { return num_cols() > 0; }
+
+    int find_col(int offset) const;
+
+    void reset_bounds(double *bounds) const;
+
+    void add_record(double *bounds, const char *buf) const;
+
+    void init_page(int page_no);
+
+    void on_write(int page_no, const char *buf, bool loose);
+
+    void on_delete(int page_no);
+
+    bool needs_refresh(int page_no, uint64_t &version);
+
+    void finish_refresh(int page_no, uint64_t version, const double *bounds);
+
+    bool may_match(int page_no, const std::vector<RmZonePred> &preds);
+
+    RmZoneState get_state(int page_no);
+};
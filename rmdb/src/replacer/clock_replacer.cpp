@@ -0,0 +1,95 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : in_replacer_(num_pages, 0), ref_bits_(num_pages, 0), hand_(0), size_(0), max_size_(num_pages) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * @description: 使用CLOCK策略选出一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回INVALID_FRAME_ID
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t* frame_id) {
+    std::scoped_lock lock{latch_};
+    if (size_ == 0) {
+        *frame_id = INVALID_FRAME_ID;
+        return false;
+    }
+    // 最多扫描两圈：第一圈清除引用位，第二圈一定能找到引用位为0的帧
+    while (true) {
+        if (in_replacer_[hand_]) {
+            if (ref_bits_[hand_]) {
+                ref_bits_[hand_] = 0;
+            } else {
+                *frame_id = static_cast<frame_id_t>(hand_);
+                in_replacer_[hand_] = 0;
+                size_--;
+                hand_ = (hand_ + 1) % max_size_;
+                return true;
+            }
+        }
+        hand_ = (hand_ + 1) % max_size_;
+    }
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 0;
+        size_--;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，并设置其引用位
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (!in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 1;
+        size_++;
+    }
+    ref_bits_[frame_id] = 1;
+}
+
+/**
+ * @description: 返回接下来最先被淘汰的至多num个frame，不修改引用位和时钟指针
+ *              从时钟指针开始扫描一圈，引用位为0的帧会在下一圈之前被淘汰，排在引用位为1的帧之前
+ * @param {size_t} num 最多返回的frame数量
+ * @param {vector<frame_id_t>*} frame_ids 输出的frame id
+ */
+void ClockReplacer::victim_candidates(size_t num, std::vector<frame_id_t>* frame_ids) {
+    std::scoped_lock lock{latch_};
+    for (int ref = 0; ref <= 1; ref++) {
+        for (size_t i = 0; i < max_size_ && frame_ids->size() < num; i++) {
+            size_t frame = (hand_ + i) % max_size_;
+            if (in_replacer_[frame] && ref_bits_[frame] == ref) {
+                frame_ids->push_back(static_cast<frame_id_t>(frame));
+            }
+        }
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return size_;
+}
@@ -0,0 +1,51 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK(二次机会)替换策略：
+每个帧对应一个引用位，unpin时置1；时钟指针扫描时遇到引用位为1的帧将其清0并跳过，遇到引用位为0的帧则将其淘汰。
+所有状态都保存在定长数组中，pin/unpin只修改数组元素，不进行内存分配
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量，帧号必须在[0, num_pages)内
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void victim_candidates(size_t num, std::vector<frame_id_t> *frame_ids);
+
+    size_t Size();
+
+   private:
+    std::mutex latch_;                  // 互斥锁
+    std::vector<char> in_replacer_;     // in_replacer_[i]为1表示帧i可以被淘汰(pin_count为0)
+    std::vector<char> ref_bits_;        // 每个帧的引用位
+    size_t hand_;                       // 时钟指针
+    size_t size_;                       // 当前可以被淘汰的帧数
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
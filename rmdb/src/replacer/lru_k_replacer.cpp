@@ -0,0 +1,130 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k),
+      current_timestamp_(0),
+      history_(num_pages * k, 0),
+      access_count_(num_pages, 0),
+      in_replacer_(num_pages, 0),
+      max_size_(num_pages) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 计算帧在evictable_中的排序键
+ *              访问不足k_次: (false, 最早一次访问时间)；否则: (true, 第k_近一次访问时间)
+ */
+LRUKReplacer::Key LRUKReplacer::get_key(frame_id_t frame_id) const {
+    size_t count = access_count_[frame_id];
+    const uint64_t *hist = &history_[frame_id * k_];
+    if (count < k_) {
+        return {{false, hist[0]}, frame_id};
+    }
+    // 环形缓冲区中下一个将被覆盖的位置就是第k_近一次访问
+    return {{true, hist[count % k_]}, frame_id};
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id。访问历史保留到帧中真正装入新页面时
+ *              (reset_history)才清除：缓冲池可能因帧正被乐观读者pin住而放弃淘汰，把它原样unpin回来
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回INVALID_FRAME_ID
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t* frame_id) {
+    std::scoped_lock lock{latch_};
+    if (evictable_.empty()) {
+        *frame_id = INVALID_FRAME_ID;
+        return false;
+    }
+    *frame_id = evictable_.begin()->second;
+    evictable_.erase(evictable_.begin());
+    in_replacer_[*frame_id] = 0;
+    return true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰。不记录访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        evictable_.erase(get_key(frame_id));
+        in_replacer_[frame_id] = 0;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (!in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 1;
+        evictable_.insert(get_key(frame_id));
+    }
+}
+
+/**
+ * @description: 记录对帧中页面的一次访问。帧可以被淘汰时同时调整它的淘汰顺序
+ * @param {frame_id_t} frame_id 被访问的frame的id
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        evictable_.erase(get_key(frame_id));
+    }
+    size_t &count = access_count_[frame_id];
+    history_[frame_id * k_ + count % k_] = ++current_timestamp_;
+    count++;
+    if (in_replacer_[frame_id]) {
+        evictable_.insert(get_key(frame_id));
+    }
+}
+
+/**
+ * @description: 帧中装入了新页面，清除旧页面的访问历史。还没有被访问过的页面按装入的时间排在访问不足k_次的帧中
+ * @param {frame_id_t} frame_id 装入新页面的frame的id
+ */
+void LRUKReplacer::reset_history(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        evictable_.erase(get_key(frame_id));
+    }
+    access_count_[frame_id] = 0;
+    history_[frame_id * k_] = ++current_timestamp_;
+    if (in_replacer_[frame_id]) {
+        evictable_.insert(get_key(frame_id));
+    }
+}
+
+/**
+ * @description: 按淘汰优先级返回接下来最先被淘汰的至多num个frame，不将其移出replacer
+ * @param {size_t} num 最多返回的frame数量
+ * @param {vector<frame_id_t>*} frame_ids 输出的frame id
+ */
+void LRUKReplacer::victim_candidates(size_t num, std::vector<frame_id_t>* frame_ids) {
+    std::scoped_lock lock{latch_};
+    for (auto it = evictable_.begin(); it != evictable_.end() && frame_ids->size() < num; ++it) {
+        frame_ids->push_back(it->second);
+    }
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return evictable_.size();
+}
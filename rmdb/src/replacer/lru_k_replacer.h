@@ -0,0 +1,67 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略：
+record_access记录对帧中页面的一次访问，保存最近K次访问的逻辑时间戳；pin/unpin只决定帧能否被淘汰，不算作访问，
+帧中装入新页面时由reset_history清除旧页面的访问历史。淘汰时选择后向K距离最大的帧：
+访问次数不足K次的帧后向K距离视为无穷大，优先淘汰，它们之间按最早一次访问的先后淘汰(FIFO)；
+其余帧按第K近一次访问的时间先后淘汰。
+全表扫描读入的页面通常只被访问一次，因此会先于反复访问的热点页面被淘汰(scan resistant)
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量，帧号必须在[0, num_pages)内
+     * @param {size_t} k 历史访问次数K
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void record_access(frame_id_t frame_id);
+
+    void reset_history(frame_id_t frame_id);
+
+    void victim_candidates(size_t num, std::vector<frame_id_t> *frame_ids);
+
+    size_t Size();
+
+   private:
+    using Key = std::pair<std::pair<bool, uint64_t>, frame_id_t>;   // ((访问次数是否已达K次, 排序时间戳), 帧号)
+
+    Key get_key(frame_id_t frame_id) const;
+
+    std::mutex latch_;                  // 互斥锁
+    size_t k_;
+    uint64_t current_timestamp_;        // 逻辑时钟，每次访问加一
+    std::vector<uint64_t> history_;     // 每个帧最近k_次访问的时间戳，帧i占用[i*k_, (i+1)*k_)，按环形缓冲区使用
+    std::vector<size_t> access_count_;  // 每个帧被记录的访问次数
+    std::vector<char> in_replacer_;     // in_replacer_[i]为1表示帧i可以被淘汰
+    std::set<Key> evictable_;           // 可淘汰帧按淘汰优先级排序，begin()为下一个victim
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
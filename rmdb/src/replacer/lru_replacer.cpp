@@ -72,6 +72,18 @@ void LRUReplacer::unpin(frame_id_t frame_id) {
         LRUhash_[frame_id] = LRUlist_.begin();
 }
 }
+/**
+ * @description: 按淘汰顺序(从链表尾部开始)返回接下来最先被淘汰的至多num个frame，不将其移出replacer
+ * @param {size_t} num 最多返回的frame数量
+ * @param {vector<frame_id_t>*} frame_ids 输出的frame id
+ */
+void LRUReplacer::victim_candidates(size_t num, std::vector<frame_id_t>* frame_ids) {
+    std::scoped_lock lock{latch_};
+    for (auto it = LRUlist_.rbegin(); it != LRUlist_.rend() && frame_ids->size() < num; ++it) {
+        frame_ids->push_back(*it);
+    }
+}
+
 /**
  * @description: 获取当前replacer中可以被淘汰的页面数量
  */
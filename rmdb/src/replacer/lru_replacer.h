@@ -37,6 +37,8 @@ class LRUReplacer : public Replacer {
 
     void unpin(frame_id_t frame_id);
 
+    void victim_candidates(size_t num, std::vector<frame_id_t> *frame_ids);
+
     size_t Size();
 
    private:
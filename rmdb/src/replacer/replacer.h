@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 /**
@@ -29,6 +31,7 @@ class Replacer {
 
     /**
      * Pins a frame, indicating that it should not be victimized until it is unpinned.
+     * Pinning is not an access; callers that read or create the page also call record_access().
      * @param frame_id the id of the frame to pin
      */
     virtual void pin(frame_id_t frame_id) = 0;
@@ -39,6 +42,26 @@ class Replacer {
      */
     virtual void unpin(frame_id_t frame_id) = 0;
 
+    /**
+     * Records an access to the page held by a frame. Replacers that only order frames by unpin time ignore it.
+     * @param frame_id the id of the accessed frame
+     */
+    virtual void record_access(frame_id_t frame_id) {}
+
+    /**
+     * Forgets the access history of a frame because a different page is being loaded into it.
+     * @param frame_id the id of the frame
+     */
+    virtual void reset_history(frame_id_t frame_id) {}
+
+    /**
+     * Collects the frames that would be victimized next, in eviction order, without removing them.
+     * The page cleaner uses this to write back dirty pages before they reach the victim end.
+     * @param num maximum number of frames to return
+     * @param[out] frame_ids candidate frames, nearest victim first
+     */
+    virtual void victim_candidates(size_t num, std::vector<frame_id_t> *frame_ids) = 0;
+
     /** @return the number of elements in the replacer that can be victimized */
     virtual size_t Size() = 0;
 };
@@ -29,21 +29,34 @@ See the Mulan PSL v2 for more details. */
 
 static bool should_exit = false;
 
-// 构建全局所需的管理器对象
-auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
-auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
-auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
-auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
-auto lock_manager = std::make_unique<LockManager>();
-auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
-auto planner = std::make_unique<Planner>(sm_manager.get());
-auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
-auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
-auto log_manager = std::make_unique<LogManager>(disk_manager.get());
-auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
-auto analyze = std::make_unique<Analyze>(sm_manager.get());
+// 启动参数，默认值见common/config.h，可通过命令行参数 --key=value 覆盖
+struct StartupOptions {
+    size_t buffer_pool_size = BUFFER_POOL_SIZE;               // --buffer-pool-size=N，可通过SET buffer_pool_size = N在线调整
+    size_t buffer_pool_max_size = BUFFER_POOL_MAX_SIZE;       // --buffer-pool-max-size=N，在线调整的上限
+    size_t buffer_pool_partitions = BUFFER_POOL_PARTITIONS;   // --buffer-pool-partitions=N
+    std::string replacer_type = REPLACER_TYPE;                // --replacer=LRU|CLOCK|LRU-K
+    size_t page_cleaner_max_pages = PAGE_CLEANER_MAX_PAGES;   // --page-cleaner-max-pages=N，0表示不启动清理线程
+    int page_cleaner_interval_ms = PAGE_CLEANER_INTERVAL_MS;  // --page-cleaner-interval-ms=N
+    bool direct_io = USE_DIRECT_IO;                           // --direct-io=on|off
+    bool page_compression = USE_PAGE_COMPRESSION;             // --page-compression=on|off，只影响新创建的表和索引
+    bool page_checksums = USE_PAGE_CHECKSUMS;                 // --page-checksums=on|off，只影响新创建的表和索引
+};
+
+// 全局所需的管理器对象，在main中根据启动参数构建
+std::unique_ptr<DiskManager> disk_manager;
+std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+std::unique_ptr<RmManager> rm_manager;
+std::unique_ptr<IxManager> ix_manager;
+std::unique_ptr<SmManager> sm_manager;
+std::unique_ptr<LockManager> lock_manager;
+std::unique_ptr<TransactionManager> txn_manager;
+std::unique_ptr<Planner> planner;
+std::unique_ptr<Optimizer> optimizer;
+std::unique_ptr<QlManager> ql_manager;
+std::unique_ptr<LogManager> log_manager;
+std::unique_ptr<RecoveryManager> recovery;
+std::unique_ptr<Portal> portal;
+std::unique_ptr<Analyze> analyze;
 pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
 
@@ -261,12 +274,120 @@ void start_server() {
     std::cout << "Server shuts down." << std::endl;
 }
 
+/**
+ * @description: 解析命令行参数 <database> [--key=value ...]
+ * @return {bool} 参数合法返回true
+ */
+static bool parse_startup_options(int argc, char **argv, std::string *db_name, StartupOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            if (!db_name->empty()) {
+                return false;
+            }
+            *db_name = arg;
+            continue;
+        }
+        size_t pos = arg.find('=');
+        if (pos == std::string::npos) {
+            return false;
+        }
+        std::string key = arg.substr(2, pos - 2);
+        std::string value = arg.substr(pos + 1);
+        if (key == "buffer-pool-size" || key == "buffer-pool-max-size") {
+            long long num = atoll(value.c_str());
+            if (num <= 0) {
+                return false;
+            }
+            if (key == "buffer-pool-size") {
+                options->buffer_pool_size = num;
+            } else {
+                options->buffer_pool_max_size = num;
+            }
+        } else if (key == "buffer-pool-partitions") {
+            int num = atoi(value.c_str());
+            if (num <= 0) {
+                return false;
+            }
+            options->buffer_pool_partitions = num;
+        } else if (key == "replacer") {
+            if (value != "LRU" && value != "CLOCK" && value != "LRU-K") {
+                return false;
+            }
+            options->replacer_type = value;
+        } else if (key == "page-cleaner-max-pages") {
+            int num = atoi(value.c_str());
+            if (num < 0 || (num == 0 && value != "0")) {
+                return false;
+            }
+            options->page_cleaner_max_pages = num;
+        } else if (key == "page-cleaner-interval-ms") {
+            int num = atoi(value.c_str());
+            if (num <= 0) {
+                return false;
+            }
+            options->page_cleaner_interval_ms = num;
+        } else if (key == "direct-io") {
+            if (value != "on" && value != "off") {
+                return false;
+            }
+            options->direct_io = value == "on";
+        } else if (key == "page-compression") {
+            if (value != "on" && value != "off") {
+                return false;
+            }
+            options->page_compression = value == "on";
+        } else if (key == "page-checksums") {
+            if (value != "on" && value != "off") {
+                return false;
+            }
+            options->page_checksums = value == "on";
+        } else {
+            return false;
+        }
+    }
+    return !db_name->empty() && options->buffer_pool_partitions <= options->buffer_pool_size;
+}
+
+// 构建全局所需的管理器对象
+static void init_managers(const StartupOptions &options) {
+    disk_manager = std::make_unique<DiskManager>();
+    disk_manager->set_direct_io(options.direct_io);
+    disk_manager->set_compression(options.page_compression);
+    disk_manager->set_page_checksums(options.page_checksums);
+    buffer_pool_manager = std::make_unique<BufferPoolManager>(options.buffer_pool_size, disk_manager.get(),
+                                                              options.buffer_pool_partitions, options.replacer_type,
+                                                              USE_HUGE_PAGES, options.buffer_pool_max_size);
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
+    lock_manager = std::make_unique<LockManager>();
+    txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+    planner = std::make_unique<Planner>(sm_manager.get());
+    optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
+    ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get(), planner.get());
+    log_manager = std::make_unique<LogManager>(disk_manager.get());
+    recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
+    portal = std::make_unique<Portal>(sm_manager.get());
+    analyze = std::make_unique<Analyze>(sm_manager.get());
+    // LogManager尚未维护persist_lsn_，暂不设置flushed_lsn_getter，清理线程不检查页面日志号
+    buffer_pool_manager->start_page_cleaner(PAGE_CLEANER_TARGET_CLEAN, options.page_cleaner_max_pages,
+                                            options.page_cleaner_interval_ms);
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    std::string db_name;
+    StartupOptions options;
+    if (!parse_startup_options(argc, argv, &db_name, &options)) {
         // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
+        std::cerr << "Usage: " << argv[0]
+                  << " <database> [--buffer-pool-size=N] [--buffer-pool-max-size=N] [--buffer-pool-partitions=N]"
+                     " [--replacer=LRU|CLOCK|LRU-K]"
+                     " [--page-cleaner-max-pages=N] [--page-cleaner-interval-ms=N] [--direct-io=on|off]"
+                     " [--page-compression=on|off] [--page-checksums=on|off]" << std::endl;
         exit(1);
     }
+    init_managers(options);
 
     signal(SIGINT, sigint_handler);
     try {
@@ -282,7 +403,6 @@ int main(int argc, char **argv) {
                      "Type 'help;' for help.\n"
                      "\n";
         // Database name is passed by args
-        std::string db_name = argv[1];
         if (!sm_manager->is_dir(db_name)) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
@@ -10,56 +10,400 @@ See the Mulan PSL v2 for more details. */
 
 #include "buffer_pool_manager.h"
 
+BufferPoolManager::Partition::Partition(frame_id_t first_frame, size_t size, size_t capacity,
+                                        const std::string &replacer_type)
+    : first_frame_(first_frame), size_(size), capacity_(capacity) {
+    // 可以被Replacer改变；置换器按预留的帧数创建，resize时不需要重建
+    if (replacer_type == "LRU")
+        replacer_ = new LRUReplacer(capacity_);
+    else if (replacer_type == "CLOCK")
+        replacer_ = new ClockReplacer(capacity_);
+    else if (replacer_type == "LRU-K")
+        replacer_ = new LRUKReplacer(capacity_);
+    else {
+        throw InternalError("BufferPoolManager: unknown replacer type " + replacer_type);
+    }
+    // 初始化时，分区内所有的page都在free_list_中
+    for (size_t i = 0; i < size_; ++i) {
+        free_list_.emplace_back(first_frame_ + static_cast<frame_id_t>(i));  // static_cast转换数据类型
+    }
+    // 无锁页表的槽数取不小于2 * capacity_的2的幂，负载因子不超过1/2
+    size_t num_hints = HINT_PROBES;
+    while (num_hints < capacity_ * 2) {
+        num_hints *= 2;
+    }
+    hints_ = std::make_unique<std::atomic<uint64_t>[]>(num_hints);
+    for (size_t i = 0; i < num_hints; ++i) {
+        hints_[i] = 0;
+    }
+    hint_mask_ = num_hints - 1;
+}
+
+BufferPoolManager::Partition::~Partition() { delete replacer_; }
+
+/**
+ * @description: 无锁页表使用的哈希函数(splitmix64)，低位决定槽位，高32位作为标签
+ */
+uint64_t BufferPoolManager::hint_hash(const PageId &page_id) {
+    uint64_t x = (static_cast<uint64_t>(static_cast<uint32_t>(page_id.fd)) << 32) |
+                 static_cast<uint32_t>(page_id.page_no);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @description: 在无锁页表中登记page_id位于帧frame_id。优先使用空槽，探测范围内没有空槽时覆盖第一个槽。调用者需持有part.latch_
+ */
+void BufferPoolManager::hint_insert(Partition &part, const PageId &page_id, frame_id_t frame_id) {
+    uint64_t hash = hint_hash(page_id);
+    uint64_t entry = (hash & 0xffffffff00000000ULL) | static_cast<uint64_t>(frame_id - part.first_frame_ + 1);
+    size_t empty = hash & part.hint_mask_;
+    bool found_empty = false;
+    for (size_t i = 0; i < Partition::HINT_PROBES; i++) {
+        size_t slot = (hash + i) & part.hint_mask_;
+        uint64_t old = part.hints_[slot].load(std::memory_order_relaxed);
+        if (old == entry) {
+            return;
+        }
+        if (old == 0 && !found_empty) {
+            empty = slot;
+            found_empty = true;
+        }
+    }
+    part.hints_[empty].store(entry, std::memory_order_release);
+}
+
+/**
+ * @description: 从无锁页表中删除page_id位于帧frame_id的表项(若存在)。调用者需持有part.latch_
+ */
+void BufferPoolManager::hint_erase(Partition &part, const PageId &page_id, frame_id_t frame_id) {
+    uint64_t hash = hint_hash(page_id);
+    uint64_t entry = (hash & 0xffffffff00000000ULL) | static_cast<uint64_t>(frame_id - part.first_frame_ + 1);
+    for (size_t i = 0; i < Partition::HINT_PROBES; i++) {
+        size_t slot = (hash + i) & part.hint_mask_;
+        if (part.hints_[slot].load(std::memory_order_relaxed) == entry) {
+            part.hints_[slot].store(0, std::memory_order_release);
+        }
+    }
+}
+
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @description: 独占一个帧以便修改其中的页面(淘汰、删除或回收)：版本号先变为奇数，再把pin_count_从0改为1。
+ *              乐观读者先读版本号、再pin、再核对版本号，因此要么看到奇数或变化了的版本号而放弃，
+ *              要么先于此处pin住帧而使本函数失败。成功时版本号保持奇数，修改完成后调用release_frame。调用者需持有分区锁
+ * @return {bool} 帧未被pin、独占成功返回true
+ */
+bool BufferPoolManager::claim_frame(Page *page) {
+    page->version_++;
+    int expected = 0;
+    if (page->pin_count_.compare_exchange_strong(expected, 1)) {
+        return true;
+    }
+    page->version_++;
+    return false;
+}
+
+/**
+ * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id，并用claim_frame独占该帧。
+ *              乐观读路径pin住帧时不会把它移出置换器，因此置换器选出的帧可能已被pin住，这样的帧跳过并放回置换器
  * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {Partition&} part 在该分区内查找，调用者需持有part.latch_
  * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
+bool BufferPoolManager::find_victim_page(Partition &part, frame_id_t* frame_id) {
     // Todo:
     // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
     // 1.1 未满获得frame
     // 1.2 已满使用lru_replacer中的方法选择淘汰页面
-    if (!free_list_.empty()) {
-        *frame_id = free_list_.front();
-        free_list_.pop_front();
-        return true;
+    for (size_t i = part.free_list_.size(); i > 0; i--) {
+        frame_id_t free_frame = part.free_list_.front();
+        part.free_list_.pop_front();
+        if (claim_frame(&pages_[free_frame])) {
+            *frame_id = free_frame;
+            return true;
+        }
+        // 乐观读者正短暂地pin着这个空闲帧(核对失败后会立即释放)，换下一个
+        part.free_list_.push_back(free_frame);
+    }
+    std::vector<frame_id_t> skipped;
+    bool found = false;
+    frame_id_t local_id;
+    while (part.replacer_->victim(&local_id)) {
+        frame_id_t victim = part.first_frame_ + local_id;
+        pages_[victim].in_replacer_ = false;
+        if (claim_frame(&pages_[victim])) {
+            *frame_id = victim;
+            found = true;
+            break;
+        }
+        skipped.push_back(victim);
+    }
+    // 跳过的帧正被读取，放回后仍按原来的访问历史排序(置换器在victim时不清除历史)
+    for (frame_id_t victim : skipped) {
+        replacer_unpin(part, victim);
+    }
+    return found;
+}
+
+/**
+ * @description: 从访问策略的环中取出可复用的帧。环前进一个位置，若该位置上次使用的帧属于part、未被pin、
+ *              不在I/O中且仍缓存着某个页面，则独占该帧并把它从置换器中取出作为替换帧；否则返回false，由调用者正常淘汰。
+ * @return {bool} true: 找到可复用的帧
+ * @param {Partition&} part 目标页面所属的分区，调用者需持有part.latch_
+ * @param {BufferAccessStrategy*} strategy 访问策略
+ * @param {frame_id_t*} frame_id 返回找到的帧号
+ */
+bool BufferPoolManager::get_ring_frame(Partition &part, BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+    strategy->current_ = (strategy->current_ + 1) % strategy->ring_.size();
+    frame_id_t ring_frame = strategy->ring_[strategy->current_];
+    if (ring_frame < part.first_frame_ || ring_frame >= part.first_frame_ + static_cast<frame_id_t>(part.size_)) {
+        return false;
     }
-    if (replacer_->victim(frame_id)) {
+    Page *page = &pages_[ring_frame];
+    if (page->pin_count_ != 0 || page->io_in_progress_ || page->id_.page_no == INVALID_PAGE_ID) {
+        return false;
+    }
+    auto iter = part.page_table_.find(page->id_);
+    if (iter == part.page_table_.end() || iter->second != ring_frame || !claim_frame(page)) {
+        return false;
+    }
+    // 复用不算作对旧页面的访问，只把帧移出置换器；旧页面的访问历史由reserve_frame清除，
+    // 否则LRU-K下扫描读入的页面会继承旧页面的历史，看起来像热点页面
+    replacer_pin(part, ring_frame);
+    *frame_id = ring_frame;
+    return true;
+}
+
+/**
+ * @description: 为缺页的page_id选择一个替换帧：指定了访问策略时优先复用策略环中的帧，否则(或环中没有可用帧时)
+ *              从分区中淘汰，并把得到的帧记录到环中
+ * @return {bool} true: 找到替换帧
+ * @param {Partition&} part page所属的分区，调用者需持有part.latch_
+ * @param {BufferAccessStrategy*} strategy 访问策略，可以为nullptr
+ * @param {frame_id_t*} frame_id 返回找到的帧号
+ */
+bool BufferPoolManager::find_replace_frame(Partition &part, BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+    if (strategy != nullptr && get_ring_frame(part, strategy, frame_id)) {
         return true;
     }
-    return false;
+    if (!find_victim_page(part, frame_id)) {
+        return false;
+    }
+    if (strategy != nullptr) {
+        strategy->ring_[strategy->current_] = *frame_id;
+    }
+    return true;
+}
+
+/**
+ * @description: 在页表中登记帧new_frame_id将装入new_page_id，并将帧标记为io_in_progress_。帧已由claim_frame独占(pin_count_为1)。
+ *              原页面为脏页时其页表项保留到写回完成(见complete_page_io)，这样并发访问新旧页面的线程都会在io_cv_上等待，
+ *              不会读到未写回的旧数据或未读入的新数据；访问其他页面的线程不受影响。调用者需持有part.latch_
+ *              原页面正在被清理线程写回时同样按需要写回处理，写回前由wait_for_cleaner确认清理线程是否写成功
+ * @return {bool} 原页面是否需要写回
+ */
+bool BufferPoolManager::reserve_frame(Partition &part, Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+    if (page->is_dirty_) {
+        pages_evicted_dirty_++;
+    }
+    bool write_back = page->is_dirty_ || part.writing_pages_.count(page->id_) != 0;
+    if (!write_back) {
+        part.page_table_.erase(page->id_);
+    }
+    if (page->id_.page_no != INVALID_PAGE_ID) {
+        hint_erase(part, page->id_, new_frame_id);
+    }
+    page->id_ = new_page_id;
+    page->io_in_progress_ = true;
+    // 帧中原有页面(或删除、回收前的页面)的访问历史不属于新页面；预读的页面在第一次fetch_page时才记录访问
+    part.replacer_->reset_history(new_frame_id - part.first_frame_);
+    replacer_pin(part, new_frame_id);
+    part.page_table_[new_page_id] = new_frame_id;
+    release_frame(page);
+    return write_back;
+}
+
+/**
+ * @description: reserve_frame登记的磁盘I/O结束后调用，撤销io_in_progress_并唤醒等待者。调用者需持有part.latch_
+ *              success为false时撤销reserve_frame的登记：原页面未能写回则仍保留在该帧中，否则释放该帧
+ * @param {PageId} old_page_id 帧中原来的页面
+ * @param {bool} write_back 原页面是否需要写回
+ * @param {bool} written 原页面是否已经写回
+ * @param {bool} success I/O是否全部成功
+ * @param {bool} keep_pin 为true时调用者保留reserve_frame加的pin；为false时(预读)释放该pin
+ */
+void BufferPoolManager::finish_page_io(Partition &part, Page *page, PageId old_page_id, bool write_back, bool written,
+                                       PageId new_page_id, frame_id_t new_frame_id, bool success, bool keep_pin) {
+    if (!success) {
+        part.page_table_.erase(new_page_id);
+        page->version_++;
+        if (write_back && !written) {
+            // 旧页面未能写回，仍然保留在该帧中
+            page->id_ = old_page_id;
+            page->pin_count_--;
+            replacer_unpin(part, new_frame_id);
+            hint_insert(part, old_page_id, new_frame_id);
+        } else {
+            if (write_back) {
+                part.page_table_.erase(old_page_id);
+            }
+            page->is_dirty_ = false;
+            page->id_ = PageId{-1, INVALID_PAGE_ID};
+            page->pin_count_--;
+            part.free_list_.emplace_back(new_frame_id);
+        }
+        release_frame(page);
+    } else {
+        if (write_back) {
+            part.page_table_.erase(old_page_id);
+            page->is_dirty_ = false;
+        }
+        hint_insert(part, new_page_id, new_frame_id);
+        if (!keep_pin && --page->pin_count_ == 0) {
+            replacer_unpin(part, new_frame_id);
+        }
+    }
+    page->io_in_progress_ = false;
+    part.io_cv_.notify_all();
+}
+
+/**
+ * @description: 等待清理线程对帧中旧页面old_page_id的写回结束(若正在进行)，返回旧页面是否仍需由调用者写回。
+ *              清理线程写回失败时会重新标脏该帧。调用者不能持有part.latch_
+ * @return {bool} 旧页面是否仍为脏页
+ * @param {Page*} page reserve_frame预留的帧，旧页面的数据仍在其中
+ * @param {PageId} old_page_id 帧中原来的页面
+ */
+bool BufferPoolManager::wait_for_cleaner(Partition &part, Page *page, PageId old_page_id) {
+    std::unique_lock lock{part.latch_};
+    part.io_cv_.wait(lock, [&]() { return part.writing_pages_.count(old_page_id) == 0; });
+    return page->is_dirty_;
 }
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
+ * @description: 执行reserve_frame登记的磁盘I/O：写回原脏页，再按需读入新页面，完成后加锁调用finish_page_io。
+ *              I/O期间不持有分区锁。I/O失败时撤销reserve_frame的登记，并将异常继续抛出。
+ * @param {unique_lock&} lock part.latch_上的锁，进入时未加锁，返回(或抛出异常)时已加锁
+ * @param {PageId} old_page_id 帧中原来的页面
+ * @param {bool} write_back 原页面是否需要写回
+ * @param {bool} read_from_disk 是否需要从磁盘读入新页面(new_page不需要)
+ */
+void BufferPoolManager::complete_page_io(Partition &part, std::unique_lock<std::mutex> &lock, Page *page,
+                                         PageId old_page_id, bool write_back, PageId new_page_id,
+                                         frame_id_t new_frame_id, bool read_from_disk) {
+    bool written = false;
+    try {
+        if (write_back) {
+            if (wait_for_cleaner(part, page, old_page_id)) {
+                disk_manager_->write_page(old_page_id.fd, old_page_id.page_no, page->data_, PAGE_SIZE);
+            }
+            written = true;
+        }
+        page->reset_memory();
+        if (read_from_disk) {
+            disk_manager_->read_page(new_page_id.fd, new_page_id.page_no, page->data_, PAGE_SIZE);
+        }
+    } catch (...) {
+        lock.lock();
+        finish_page_io(part, page, old_page_id, write_back, written, new_page_id, new_frame_id, false, true);
+        throw;
+    }
+    lock.lock();
+    finish_page_io(part, page, old_page_id, write_back, written, new_page_id, new_frame_id, true, true);
+}
+
+/**
+ * @description: 将帧new_frame_id替换为新页面new_page_id，如果原页面为脏页则需写入磁盘，再按需从磁盘读入新页面。
+ *              返回时新页面已被pin住(pin_count为1)
+ * @param {Partition&} part new_page_id所属的分区
+ * @param {unique_lock&} lock 持有part.latch_的锁，磁盘I/O期间释放，函数返回时仍持有该锁
  * @param {Page*} page 写回页指针
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {bool} read_from_disk 是否需要从磁盘读入新页面(new_page不需要)
  */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+void BufferPoolManager::update_page(Partition &part, std::unique_lock<std::mutex> &lock, Page *page,
+                                    PageId new_page_id, frame_id_t new_frame_id, bool read_from_disk) {
     // Todo:
     // 1 如果是脏页，写回磁盘，并且把dirty置为false
     // 2 更新page table
     // 3 重置page的data，更新page id
-    if (page->is_dirty_) {
-        disk_manager_->write_page(page->id_.fd, page->id_.page_no,page->data_,PAGE_SIZE);
-        page->is_dirty_ = false;
+    PageId old_page_id = page->id_;
+    bool write_back = reserve_frame(part, page, new_page_id, new_frame_id);
+    replacer_access(part, new_frame_id);
+    lock.unlock();
+    complete_page_io(part, lock, page, old_page_id, write_back, new_page_id, new_frame_id, read_from_disk);
+}
+
+/**
+ * @description: 乐观读路径：不加分区锁，在无锁页表中找到候选帧，读版本号、pin住帧，再核对帧中的页面、I/O状态和版本号。
+ *              命中时不更新置换器(帧一直留在置换器中，淘汰时由claim_frame跳过被pin的帧)，每OPTIMISTIC_SAMPLE_RATE次命中
+ *              尝试一次加锁，把帧移出置换器，使之后的unpin_page按正常路径把它重新放回置换器，相当于抽样记录一次访问。
+ * @return {Page*} 命中时返回已pin住的页面，否则返回nullptr，由调用者走加锁的路径
+ */
+Page *BufferPoolManager::fetch_page_optimistic(Partition &part, const PageId &page_id) {
+    static thread_local uint32_t hits = 0;
+    uint64_t hash = hint_hash(page_id);
+    for (size_t i = 0; i < Partition::HINT_PROBES; i++) {
+        uint64_t entry = part.hints_[(hash + i) & part.hint_mask_].load(std::memory_order_acquire);
+        if (entry == 0 || (entry >> 32) != (hash >> 32)) {
+            continue;
+        }
+        frame_id_t frame_id = part.first_frame_ + static_cast<frame_id_t>(entry & 0xffffffff) - 1;
+        Page *page = &pages_[frame_id];
+        uint64_t version = page->version_;
+        if (version % 2 != 0) {
+            return nullptr;
+        }
+        page->pin_count_++;
+        if (page->id_ == page_id && !page->io_in_progress_ && page->version_ == version) {
+            if (++hits % OPTIMISTIC_SAMPLE_RATE == 0 && part.latch_.try_lock()) {
+                if (page->in_replacer_) {
+                    replacer_access(part, frame_id);
+                }
+                part.latch_.unlock();
+            }
+            return page;
+        }
+        undo_optimistic_pin(part, page);
+        return nullptr;
+    }
+    return nullptr;
+}
+
+/**
+ * @description: 撤销乐观读路径核对失败的pin。若pin_count_因此降为0，这次短暂的pin可能恰好使另一个线程的unpin_page
+ *              没有把帧放回置换器，需要加锁检查：帧仍缓存着页面、未被pin且不在I/O中时把它放回置换器
+ */
+void BufferPoolManager::undo_optimistic_pin(Partition &part, Page *page) {
+    if (--page->pin_count_ != 0) {
+        return;
+    }
+    std::scoped_lock lock{part.latch_};
+    frame_id_t frame_id = static_cast<frame_id_t>(page - pages_);
+    if (page->pin_count_ != 0 || page->io_in_progress_ || page->in_replacer_ ||
+        static_cast<size_t>(frame_id - part.first_frame_) >= part.size_) {
+        return;
+    }
+    auto iter = part.page_table_.find(page->id_);
+    if (iter != part.page_table_.end() && iter->second == frame_id) {
+        replacer_unpin(part, frame_id);
     }
-    page_table_.erase(page->id_);
-    page->reset_memory();
-    page->id_ = new_page_id;
-    page_table_[new_page_id] = new_frame_id;
 }
 
 /**
  * @description: 从buffer pool获取需要的页。
+ *              打开了乐观读时先尝试fetch_page_optimistic，命中则不需要加分区锁。
  *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
  *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ *              若目标页正在被其他线程读入或写回，则等待其I/O完成后重新查找。
+ *              指定了访问策略时，缺页优先复用策略环中的帧，并把最终使用的帧记录到环中。
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 访问策略，nullptr表示使用整个缓冲池
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
+Page* BufferPoolManager::fetch_page(PageId page_id, BufferAccessStrategy *strategy) {
     //Todo:
     // 1.     从page_table_中搜寻目标页
     // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
@@ -68,34 +412,157 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
     // 3.     调用disk_manager_的read_page读取目标页到frame
     // 4.     固定目标页，更新pin_count_
     // 5.     返回目标页
-    //std::scoped_lock lock{latch_};
-    std::scoped_lock lock{latch_};
-    if (page_table_.find(page_id) != page_table_.end()) {
-        frame_id_t frame_id = page_table_[page_id];
+    Partition &part = get_partition(page_id);
+    if (optimistic_reads_) {
+        Page *page = fetch_page_optimistic(part, page_id);
+        if (page != nullptr) {
+            return page;
+        }
+    }
+    std::unique_lock lock{part.latch_};
+    auto iter = part.page_table_.find(page_id);
+    while (iter != part.page_table_.end() && pages_[iter->second].io_in_progress_) {
+        part.io_cv_.wait(lock);
+        iter = part.page_table_.find(page_id);
+    }
+    if (iter != part.page_table_.end()) {
+        frame_id_t frame_id = iter->second;
         Page* page = &pages_[frame_id];
-        replacer_->pin(frame_id);
+        replacer_access(part, frame_id);
         page->pin_count_++;
+        // 表项可能在无锁页表写满时被覆盖，重新登记以便之后的访问走乐观读路径
+        hint_insert(part, page_id, frame_id);
         return page;
     }
 
     frame_id_t frame_id;
-    if (!find_victim_page(&frame_id)) {
+    if (!find_replace_frame(part, strategy, &frame_id)) {
         return nullptr;
     }
 
     Page* victim_page = &pages_[frame_id];
-/*     if (victim_page->is_dirty_) {
-        disk_manager_->write_page(victim_page->page_id_, victim_page->data_);
-    } */
-    update_page(victim_page, page_id, frame_id);
-    disk_manager_->read_page(page_id.fd,page_id.page_no, victim_page->data_,PAGE_SIZE);
-    replacer_->pin(frame_id);
-    victim_page->pin_count_ = 1;
+    update_page(part, lock, victim_page, page_id, frame_id, true);
     return victim_page;
 }
 
 /**
- * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @description: 异步预读页面，见prefetch_pages
+ */
+void BufferPoolManager::prefetch_page(PageId page_id, BufferAccessStrategy *strategy) {
+    prefetch_pages(page_id.fd, page_id.page_no, 1, strategy);
+}
+
+/**
+ * @description: 异步预读文件fd中[start_page_no, start_page_no + num_pages)范围内的页面。
+ *              对每个不在缓冲池中的页面预留一个帧(与fetch_page一样选择替换帧)，页号连续的一段页面作为一个任务
+ *              交给prefetcher_的后台线程：先写回各帧中的脏页，再用一次read_pages(preadv)把整段页面读入各自的帧，然后立即返回。
+ *              I/O完成前访问这些页面的线程会在io_cv_上等待，完成后页面处于未pin状态，可以被正常淘汰。
+ *              预读只是提示：没有可用帧、预读队列已满或读入失败时都直接放弃。
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 第一个页号
+ * @param {int} num_pages 页数
+ * @param {BufferAccessStrategy*} strategy 访问策略，nullptr表示使用整个缓冲池
+ */
+void BufferPoolManager::prefetch_pages(int fd, page_id_t start_page_no, int num_pages, BufferAccessStrategy *strategy) {
+    struct PrefetchIo {
+        Partition *part;
+        Page *page;
+        PageId old_page_id;
+        bool write_back;
+        frame_id_t frame_id;
+    };
+    std::vector<PrefetchIo> run;   // 当前这段页号连续、已预留帧的页面
+    page_id_t run_start = INVALID_PAGE_ID;
+
+    auto submit_run = [&]() {
+        if (run.empty()) {
+            return;
+        }
+        auto task = [this, fd, run_start, run = std::move(run)]() mutable {
+            bool success = true;
+            std::vector<bool> written(run.size(), false);
+            std::vector<char *> bufs;
+            try {
+                for (size_t i = 0; i < run.size(); i++) {
+                    if (run[i].write_back) {
+                        if (wait_for_cleaner(*run[i].part, run[i].page, run[i].old_page_id)) {
+                            disk_manager_->write_page(run[i].old_page_id.fd, run[i].old_page_id.page_no,
+                                                      run[i].page->data_, PAGE_SIZE);
+                        }
+                        written[i] = true;
+                    }
+                    run[i].page->reset_memory();
+                    bufs.push_back(run[i].page->data_);
+                }
+                disk_manager_->read_pages(fd, run_start, bufs.data(), static_cast<int>(run.size()));
+            } catch (RMDBError &) {
+                // 预读失败时撤销登记，之后的fetch_page会重新同步读取
+                success = false;
+            }
+            for (size_t i = 0; i < run.size(); i++) {
+                std::scoped_lock lock{run[i].part->latch_};
+                finish_page_io(*run[i].part, run[i].page, run[i].old_page_id, run[i].write_back, written[i],
+                               PageId{fd, run_start + static_cast<page_id_t>(i)}, run[i].frame_id, success, false);
+            }
+        };
+        if (!prefetcher_->submit(task)) {
+            // 队列已满，帧已经预留，只能在当前线程完成I/O
+            task();
+        }
+        run.clear();
+    };
+
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, start_page_no + i};
+        Partition &part = get_partition(page_id);
+        std::unique_lock lock{part.latch_};
+        frame_id_t frame_id;
+        if (part.page_table_.count(page_id) != 0 || !find_replace_frame(part, strategy, &frame_id)) {
+            lock.unlock();
+            submit_run();
+            continue;
+        }
+        Page *page = &pages_[frame_id];
+        PageId old_page_id = page->id_;
+        bool write_back = reserve_frame(part, page, page_id, frame_id);
+        lock.unlock();
+        if (run.empty()) {
+            run_start = page_id.page_no;
+        }
+        run.push_back({&part, page, old_page_id, write_back, frame_id});
+    }
+    submit_run();
+}
+
+/**
+ * @description: 乐观unpin：不修改脏标记时，若减一后pin_count_仍大于0，或帧仍在置换器中(由乐观读路径pin住)，
+ *              直接原子地减一，不需要加分区锁。调用者持有该页面的pin，帧中的页面不会改变
+ * @return {bool} 成功unpin返回true；否则返回false，由调用者走加锁的路径
+ */
+bool BufferPoolManager::unpin_page_optimistic(Partition &part, const PageId &page_id) {
+    uint64_t hash = hint_hash(page_id);
+    for (size_t i = 0; i < Partition::HINT_PROBES; i++) {
+        uint64_t entry = part.hints_[(hash + i) & part.hint_mask_].load(std::memory_order_acquire);
+        if (entry == 0 || (entry >> 32) != (hash >> 32)) {
+            continue;
+        }
+        Page *page = &pages_[part.first_frame_ + static_cast<frame_id_t>(entry & 0xffffffff) - 1];
+        if (!(page->id_ == page_id) || page->io_in_progress_) {
+            continue;
+        }
+        int pin_count = page->pin_count_;
+        while (pin_count > 1 || (pin_count == 1 && page->in_replacer_)) {
+            if (page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page。打开了乐观读且is_dirty为false时先尝试unpin_page_optimistic
  * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
  * @param {PageId} page_id 目标page的page_id
  * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
@@ -110,20 +577,29 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     // 2.2 若pin_count_大于0，则pin_count_自减一
     // 2.2.1 若自减后等于0，则调用replacer_的Unpin
     // 3 根据参数is_dirty，更改P的is_dirty_
-    std::scoped_lock lock{latch_};
-    if (page_table_.find(page_id) == page_table_.end()) {
+    Partition &part = get_partition(page_id);
+    if (optimistic_reads_ && !is_dirty && unpin_page_optimistic(part, page_id)) {
+        return true;
+    }
+    std::scoped_lock lock{part.latch_};
+    auto iter = part.page_table_.find(page_id);
+    if (iter == part.page_table_.end()) {
         return false;
     }
 
-    frame_id_t frame_id = page_table_[page_id];
+    frame_id_t frame_id = iter->second;
     Page* page = &pages_[frame_id];
-    if (page->pin_count_ <= 0) {
-        return false;
-    }
+    // 乐观读者可能同时增减pin_count_，用CAS减一
+    int pin_count = page->pin_count_;
+    do {
+        if (pin_count <= 0) {
+            return false;
+        }
+    } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
 
-    page->pin_count_--;
-    if (page->pin_count_ == 0) {
-        replacer_->unpin(frame_id);
+    // 正在被resize回收的帧(局部帧号不小于size_)不再放回置换器
+    if (pin_count == 1 && static_cast<size_t>(frame_id - part.first_frame_) < part.size_) {
+        replacer_unpin(part, frame_id);
     }
 
     if (is_dirty) {
@@ -146,13 +622,20 @@ bool BufferPoolManager::flush_page(PageId page_id) {
     // 2. 无论P是否为脏都将其写回磁盘。
     // 3. 更新P的is_dirty_
    
-    std::scoped_lock lock{latch_};
-    if (page_table_.find(page_id) == page_table_.end()) {
+    Partition &part = get_partition(page_id);
+    std::unique_lock lock{part.latch_};
+    auto iter = part.page_table_.find(page_id);
+    // 同时等待清理线程写完该页的旧快照，避免其覆盖本次写入的内容
+    while (iter != part.page_table_.end() &&
+           (pages_[iter->second].io_in_progress_ || part.writing_pages_.count(page_id) != 0)) {
+        part.io_cv_.wait(lock);
+        iter = part.page_table_.find(page_id);
+    }
+    if (iter == part.page_table_.end()) {
         return false;
     }
 
-    frame_id_t frame_id = page_table_[page_id];
-    Page* page = &pages_[frame_id];
+    Page* page = &pages_[iter->second];
     disk_manager_->write_page(page_id.fd,page_id.page_no, page->data_,PAGE_SIZE);
     page->is_dirty_ = false;
 
@@ -170,17 +653,28 @@ Page* BufferPoolManager::new_page(PageId* page_id) {
     // 3.   将frame的数据写回磁盘
     // 4.   固定frame，更新pin_count_
     // 5.   返回获得的pageS
-
-    //std::scoped_lock lock{latch_};
-    std::scoped_lock lock{latch_};
+    // 多分区时新页所属的分区取决于新分配的page_no，因此需要先分配page_no再进入对应分区；
+    // 若该分区没有可用帧，这个page_no会被跳过(文件中留下一个未使用的页)，调用方只能看到创建失败。
+    // 单分区时保持先找可用帧再分配page_no的顺序，失败时不会消耗page_no。
     frame_id_t victim;
-    if (!find_victim_page(&victim)) {
-        return nullptr;
+    if (partitions_.size() == 1) {
+        Partition &part = *partitions_[0];
+        std::unique_lock lock{part.latch_};
+        if (!find_victim_page(part, &victim)) {
+            return nullptr;
+        }
+        page_id->page_no = disk_manager_->allocate_page(page_id->fd);
+        update_page(part, lock, &pages_[victim], *page_id, victim, false);
+        return &pages_[victim];
     }
+
     page_id->page_no = disk_manager_->allocate_page(page_id->fd);
-    update_page(&pages_[victim], *page_id, victim);
-    replacer_->pin(victim);
-    pages_[victim].pin_count_ = 1;
+    Partition &part = get_partition(*page_id);
+    std::unique_lock lock{part.latch_};
+    if (!find_victim_page(part, &victim)) {
+        return nullptr;
+    }
+    update_page(part, lock, &pages_[victim], *page_id, victim, false);
     return &pages_[victim];
 
 }
@@ -195,13 +689,20 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     // 2.   若目标页的pin_count不为0，则返回false
     // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
     
-    //std::scoped_lock lock{latch_};
-    std::scoped_lock lock{latch_};
-    if (page_table_.find(page_id) == page_table_.end()) {
+    Partition &part = get_partition(page_id);
+    std::unique_lock lock{part.latch_};
+    auto iter = part.page_table_.find(page_id);
+    // 同时等待清理线程写完该页的旧快照，避免其覆盖本次写入的内容
+    while (iter != part.page_table_.end() &&
+           (pages_[iter->second].io_in_progress_ || part.writing_pages_.count(page_id) != 0)) {
+        part.io_cv_.wait(lock);
+        iter = part.page_table_.find(page_id);
+    }
+    if (iter == part.page_table_.end()) {
         return true;
     }
 
-    frame_id_t frame_id = page_table_[page_id];
+    frame_id_t frame_id = iter->second;
     Page* page = &pages_[frame_id];
     if (page->pin_count_ != 0) {
         return false;
@@ -210,26 +711,354 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     if (page->is_dirty_) {
         disk_manager_->write_page(page_id.fd, page->id_.page_no,page->data_,PAGE_SIZE);
     }
+    // 写回期间可能有乐观读者pin住了该页面
+    if (!claim_frame(page)) {
+        return false;
+    }
 
-    page_table_.erase(page_id);
+    // 页面被删除后不应再被置换器选中
+    replacer_pin(part, frame_id);
+    hint_erase(part, page_id, frame_id);
+    part.page_table_.erase(page_id);
     page->reset_memory();
-    free_list_.emplace_back(frame_id);
+    page->is_dirty_ = false;
+    page->id_ = PageId{-1, INVALID_PAGE_ID};
+    page->pin_count_--;
+    release_frame(page);
+    part.free_list_.emplace_back(frame_id);
 
     return true;
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 将buffer_pool中文件fd的所有脏页写回到磁盘，页号连续的脏页合并为一次write_pages(pwritev)
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    //std::scoped_lock lock{latch_};
-    std::scoped_lock lock{latch_};
-    for (auto& [page_id, frame_id] : page_table_) {
-        Page* page = &pages_[frame_id];
-        if(fd==page_id.fd){
-            disk_manager_->write_page(fd, page->id_.page_no,page->data_,PAGE_SIZE);
+    // 1. 逐个分区加锁(不会同时持有多个分区的锁)：先等待该文件上所有正在进行的I/O(包括预读和清理线程的写回)完成，
+    //    之后调用者可以安全地关闭文件；再pin住该文件的所有脏页，并在写回前清除脏标记(写回期间再被修改的页面会重新标脏)。
+    //    写回期间页面同时记录在writing_pages_中，delete_page等操作会等待写回结束，而不是因为这里的pin而失败
+    std::vector<PageId> dirty_pages;
+    for (auto &part : partitions_) {
+        std::unique_lock lock{part->latch_};
+        part->io_cv_.wait(lock, [&]() {
+            for (auto &page_id : part->writing_pages_) {
+                if (page_id.fd == fd) {
+                    return false;
+                }
+            }
+            for (auto &[page_id, frame_id] : part->page_table_) {
+                if (page_id.fd == fd && pages_[frame_id].io_in_progress_) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        for (auto& [page_id, frame_id] : part->page_table_) {
+            Page* page = &pages_[frame_id];
+            if (fd == page_id.fd && page->is_dirty_) {
+                page->pin_count_++;
+                replacer_pin(*part, frame_id);
+                page->is_dirty_ = false;
+                part->writing_pages_.insert(page_id);
+                dirty_pages.push_back(page_id);
+            }
+        }
+    }
+
+    // 2. 不持有分区锁，按页号排序后把连续的脏页合并写回
+    std::sort(dirty_pages.begin(), dirty_pages.end(),
+              [](const PageId &a, const PageId &b) { return a.page_no < b.page_no; });
+    std::vector<const char *> bufs;
+    try {
+        for (size_t i = 0; i < dirty_pages.size();) {
+            size_t j = i;
+            bufs.clear();
+            while (j < dirty_pages.size() && dirty_pages[j].page_no == dirty_pages[i].page_no + static_cast<int>(j - i)) {
+                // 已被pin住，页表项不会变化
+                Partition &part = get_partition(dirty_pages[j]);
+                std::scoped_lock lock{part.latch_};
+                bufs.push_back(pages_[part.page_table_[dirty_pages[j]]].data_);
+                j++;
+            }
+            disk_manager_->write_pages(fd, dirty_pages[i].page_no, bufs.data(), static_cast<int>(j - i));
+            i = j;
+        }
+    } catch (...) {
+        finish_flush(dirty_pages, true);
+        throw;
+    }
+
+    // 3. 释放第1步加的pin，撤销写回登记
+    finish_flush(dirty_pages, false);
+}
+
+/**
+ * @description: flush_all_pages写回结束后释放页面的pin并撤销writing_pages_中的登记，唤醒等待者。
+ *              先unpin再撤销登记，被唤醒的delete_page不会再看到这里的pin
+ * @param {vector<PageId>&} page_ids 写回的页面
+ * @param {bool} is_dirty 写回失败时为true，重新标脏
+ */
+void BufferPoolManager::finish_flush(const std::vector<PageId> &page_ids, bool is_dirty) {
+    for (auto &page_id : page_ids) {
+        unpin_page(page_id, is_dirty);
+        Partition &part = get_partition(page_id);
+        std::scoped_lock lock{part.latch_};
+        part.writing_pages_.erase(page_id);
+        part.io_cv_.notify_all();
+    }
+}
+/**
+ * @description: 进行一轮脏页清理：在每个分区中查看置换器接下来将淘汰的target_clean个帧(空闲帧也计入干净帧)，
+ *              把其中未被pin的脏页复制一份快照并清除脏标记，然后不持有分区锁，按PageId排序后将连续的页面合并为一次
+ *              write_pages写回。这样前台线程淘汰这些帧时就不需要同步写回。
+ *              若设置了flushed_lsn_getter_，只写回页面日志号不超过已持久化日志号的脏页(WAL: 先写日志再写数据)。
+ *              写回期间页面记录在writing_pages_中，其他写回同一页面的操作会等待，写回失败时重新标脏。
+ * @return {size_t} 本轮写回的页数
+ * @param {size_t} target_clean 每个分区在淘汰端希望保持的干净帧数
+ * @param {size_t} max_pages 本轮最多写回的页数(限速)
+ */
+size_t BufferPoolManager::clean_pages(size_t target_clean, size_t max_pages) {
+    struct CleanIo {
+        Partition *part;
+        PageId page_id;
+        const char *buf;
+        bool success;
+    };
+    std::scoped_lock round_lock{clean_round_latch_};
+    if (clean_buffer_pages_ < max_pages) {
+        clean_buffer_ = alloc_aligned_buffer(max_pages * PAGE_SIZE);
+        clean_buffer_pages_ = max_pages;
+    }
+    bool check_wal = static_cast<bool>(flushed_lsn_getter_);
+    lsn_t flushed_lsn = check_wal ? flushed_lsn_getter_() : INVALID_LSN;
+
+    // 1. 逐个分区加锁，对淘汰端的脏页做快照
+    std::vector<CleanIo> ios;
+    std::vector<frame_id_t> candidates;
+    for (auto &part : partitions_) {
+        if (ios.size() >= max_pages) {
+            break;
+        }
+        std::scoped_lock lock{part->latch_};
+        if (part->free_list_.size() >= target_clean) {
+            continue;
+        }
+        candidates.clear();
+        part->replacer_->victim_candidates(target_clean - part->free_list_.size(), &candidates);
+        for (frame_id_t local_id : candidates) {
+            if (ios.size() >= max_pages) {
+                break;
+            }
+            Page *page = &pages_[part->first_frame_ + local_id];
+            if (!page->is_dirty_ || page->pin_count_ != 0 || page->io_in_progress_ ||
+                part->writing_pages_.count(page->id_) != 0) {
+                continue;
+            }
+            if (check_wal && page->get_page_lsn() > flushed_lsn) {
+                continue;
+            }
+            char *buf = clean_buffer_.get() + ios.size() * PAGE_SIZE;
+            memcpy(buf, page->data_, PAGE_SIZE);
             page->is_dirty_ = false;
+            part->writing_pages_.insert(page->id_);
+            ios.push_back({part.get(), page->id_, buf, true});
+        }
+    }
+
+    // 2. 不持有分区锁，按PageId排序后把同一文件中页号连续的页面合并写回
+    std::sort(ios.begin(), ios.end(), [](const CleanIo &a, const CleanIo &b) {
+        return a.page_id.fd != b.page_id.fd ? a.page_id.fd < b.page_id.fd : a.page_id.page_no < b.page_id.page_no;
+    });
+    std::vector<const char *> bufs;
+    for (size_t i = 0; i < ios.size();) {
+        size_t j = i;
+        bufs.clear();
+        while (j < ios.size() && ios[j].page_id.fd == ios[i].page_id.fd &&
+               ios[j].page_id.page_no == ios[i].page_id.page_no + static_cast<int>(j - i)) {
+            bufs.push_back(ios[j].buf);
+            j++;
+        }
+        try {
+            disk_manager_->write_pages(ios[i].page_id.fd, ios[i].page_id.page_no, bufs.data(), static_cast<int>(j - i));
+        } catch (RMDBError &) {
+            for (size_t k = i; k < j; k++) {
+                ios[k].success = false;
+            }
+        }
+        i = j;
+    }
+
+    // 3. 撤销写回登记，唤醒等待者
+    size_t cleaned = 0;
+    for (auto &io : ios) {
+        std::scoped_lock lock{io.part->latch_};
+        io.part->writing_pages_.erase(io.page_id);
+        if (io.success) {
+            cleaned++;
+        } else {
+            // 页面仍在页表中(可能正在被淘汰，此时帧中仍是该页面的数据)，重新标脏由之后的写回负责
+            pages_[io.part->page_table_[io.page_id]].is_dirty_ = true;
+        }
+        io.part->io_cv_.notify_all();
+    }
+    pages_cleaned_ += cleaned;
+    return cleaned;
+}
+
+/**
+ * @description: 启动后台清理线程，每隔interval_ms毫秒调用一次clean_pages。已启动时不做任何事
+ * @param {size_t} target_clean 每个分区在淘汰端希望保持的干净帧数
+ * @param {size_t} max_pages 每轮最多写回的页数
+ * @param {int} interval_ms 两轮之间的间隔(毫秒)
+ */
+void BufferPoolManager::start_page_cleaner(size_t target_clean, size_t max_pages, int interval_ms) {
+    if (cleaner_thread_.joinable() || max_pages == 0) {
+        return;
+    }
+    cleaner_stop_ = false;
+    cleaner_thread_ = std::thread([this, target_clean, max_pages, interval_ms]() {
+        std::unique_lock lock{cleaner_latch_};
+        while (!cleaner_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this]() { return cleaner_stop_; })) {
+            lock.unlock();
+            clean_pages(target_clean, max_pages);
+            lock.lock();
+        }
+    });
+}
+
+/**
+ * @description: 停止后台清理线程并等待其退出
+ */
+void BufferPoolManager::stop_page_cleaner() {
+    if (!cleaner_thread_.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{cleaner_latch_};
+        cleaner_stop_ = true;
+    }
+    cleaner_cv_.notify_all();
+    cleaner_thread_.join();
+}
+
+/**
+ * @description: 回收分区中局部帧号在[new_size, old_size)内的帧：把它们移出空闲链表和置换器，
+ *              对未被pin、不在I/O中的页面写回脏页并从页表中删除。调用者需持有part.latch_，且part.size_已设为new_size
+ * @return {bool} 所有帧都已回收返回true；仍有帧被pin或正在I/O时返回false，调用者稍后重试
+ */
+bool BufferPoolManager::retire_frames(Partition &part, size_t new_size, size_t old_size) {
+    frame_id_t begin = part.first_frame_ + static_cast<frame_id_t>(new_size);
+    frame_id_t end = part.first_frame_ + static_cast<frame_id_t>(old_size);
+    part.free_list_.remove_if([&](frame_id_t frame_id) { return frame_id >= begin && frame_id < end; });
+    bool done = true;
+    for (frame_id_t frame_id = begin; frame_id < end; frame_id++) {
+        Page *page = &pages_[frame_id];
+        // 预读完成或回滚时可能把帧放回置换器，每轮都重新移出
+        replacer_pin(part, frame_id);
+        if (page->id_.page_no == INVALID_PAGE_ID && !page->io_in_progress_) {
+            continue;
+        }
+        if (page->pin_count_ != 0 || page->io_in_progress_ || part.writing_pages_.count(page->id_) != 0) {
+            done = false;
+            continue;
+        }
+        if (page->is_dirty_) {
+            disk_manager_->write_page(page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
+        }
+        if (!claim_frame(page)) {
+            done = false;
+            continue;
+        }
+        hint_erase(part, page->id_, frame_id);
+        part.page_table_.erase(page->id_);
+        page->is_dirty_ = false;
+        page->id_ = PageId{-1, INVALID_PAGE_ID};
+        page->pin_count_--;
+        release_frame(page);
+    }
+    return done;
+}
+
+/**
+ * @description: 缩容失败时撤销retire_frames：分区恢复为old_size个帧，已回收的帧放回空闲链表，
+ *              仍缓存着页面且未被pin的帧放回置换器。调用者需持有part.latch_
+ */
+void BufferPoolManager::restore_frames(Partition &part, size_t new_size, size_t old_size) {
+    part.size_ = old_size;
+    for (size_t i = new_size; i < old_size; i++) {
+        frame_id_t frame_id = part.first_frame_ + static_cast<frame_id_t>(i);
+        Page *page = &pages_[frame_id];
+        if (page->id_.page_no == INVALID_PAGE_ID && !page->io_in_progress_) {
+            part.free_list_.emplace_back(frame_id);
+        } else if (page->pin_count_ == 0 && !page->io_in_progress_) {
+            replacer_unpin(part, frame_id);
+        }
+    }
+}
+
+/**
+ * @description: 在线调整缓冲池大小。帧数仍按分区平均分配，每个分区只在自己预留的范围内增减帧：
+ *              扩容时把新增的帧加入空闲链表；缩容时先停止分配被回收的帧，等待其上的pin和I/O结束，写回脏页后
+ *              从页表中删除，最后通过FrameArena::release把这部分内存还给操作系统。
+ *              某个分区的帧在RESIZE_TIMEOUT_MS内仍未能全部回收时，该分区恢复原大小并抛出异常，
+ *              已经缩容的分区保持缩容后的大小
+ * @param {size_t} new_pool_size 新的帧数，范围为[分区数, max_pool_size_]
+ */
+void BufferPoolManager::resize(size_t new_pool_size) {
+    std::scoped_lock resize_lock{resize_latch_};
+    size_t num_partitions = partitions_.size();
+    if (new_pool_size < num_partitions || new_pool_size > max_pool_size_) {
+        throw InternalError("BufferPoolManager::resize: buffer pool size must be in [" +
+                            std::to_string(num_partitions) + ", " + std::to_string(max_pool_size_) + "]");
+    }
+    std::vector<size_t> old_sizes(num_partitions);
+    for (size_t i = 0; i < num_partitions; i++) {
+        Partition &part = *partitions_[i];
+        size_t new_size = partition_share(new_pool_size, num_partitions, i);
+        std::scoped_lock lock{part.latch_};
+        old_sizes[i] = part.size_;
+        for (size_t j = part.size_; j < new_size; j++) {
+            part.free_list_.emplace_back(part.first_frame_ + static_cast<frame_id_t>(j));
+        }
+        part.size_ = new_size;
+    }
+
+    auto update_pool_size = [&]() {
+        size_t pool_size = 0;
+        for (auto &part : partitions_) {
+            std::scoped_lock lock{part->latch_};
+            pool_size += part->size_;
+        }
+        pool_size_ = pool_size;
+    };
+    for (size_t i = 0; i < num_partitions; i++) {
+        Partition &part = *partitions_[i];
+        size_t new_size = part.size_;
+        if (new_size >= old_sizes[i]) {
+            continue;
+        }
+        std::unique_lock lock{part.latch_};
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RESIZE_TIMEOUT_MS);
+        try {
+            bool retired = retire_frames(part, new_size, old_sizes[i]);
+            while (!retired && std::chrono::steady_clock::now() < deadline) {
+                // unpin不会通知io_cv_，因此定期重试
+                part.io_cv_.wait_for(lock, std::chrono::milliseconds(1));
+                retired = retire_frames(part, new_size, old_sizes[i]);
+            }
+            if (!retired) {
+                throw InternalError("BufferPoolManager::resize: frames are still pinned");
+            }
+        } catch (RMDBError &) {
+            restore_frames(part, new_size, old_sizes[i]);
+            lock.unlock();
+            update_pool_size();
+            throw;
         }
+        lock.unlock();
+        arena_->release(static_cast<size_t>(part.first_frame_ + new_size) * PAGE_SIZE,
+                        (old_sizes[i] - new_size) * PAGE_SIZE);
     }
+    update_pool_size();
 }
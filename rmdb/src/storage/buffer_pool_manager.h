@@ -12,49 +12,147 @@ See the Mulan PSL v2 for more details. */
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "disk_manager.h"
 #include "errors.h"
+#include "frame_arena.h"
 #include "page.h"
+#include "prefetcher.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/replacer.h"
 
+/**
+ * @description: 缓冲区访问策略(buffer ring)。
+ * 大表的全表扫描通过一个私有的环形帧数组循环使用少量帧：缺页时优先复用环中当前位置上次使用的帧，
+ * 而不是从整个缓冲池中淘汰页面，从而避免一次扫描把热点页面全部挤出缓冲池。
+ * 一个BufferAccessStrategy对象只能被一个线程(一次扫描)使用。
+ */
+class BufferAccessStrategy {
+    friend class BufferPoolManager;
+
+   public:
+    explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE) : ring_(ring_size, INVALID_FRAME_ID), current_(0) {}
+
+   private:
+    std::vector<frame_id_t> ring_;  // 环中每个位置最近一次使用的帧号
+    size_t current_;                // 环的当前位置
+};
+
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    /**
+     * 缓冲池的一个分区(shard)。
+     * 每个分区拥有独立的页表、空闲帧链表、置换器和互斥锁，PageId通过哈希固定映射到某一分区，
+     * 不同分区上的fetch_page/unpin_page互不阻塞。分区在pages_中预留连续的一段[first_frame_, first_frame_ + capacity_)，
+     * 其中前size_个帧可用，resize时在这段范围内增加或回收帧；置换器中保存的是分区内的局部帧号(frame_id - first_frame_)。
+     */
+    struct Partition {
+        frame_id_t first_frame_;    // 该分区第一个帧在pages_中的下标
+        size_t size_;               // 该分区当前可用的帧数
+        size_t capacity_;           // 该分区预留的帧数(缓冲池扩容的上限)
+        std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 页面号到全局帧号的映射
+        std::list<frame_id_t> free_list_;   // 空闲帧编号(全局帧号)的链表
+        Replacer *replacer_;        // 该分区的置换策略
+        std::mutex latch_;          // 保护该分区的页表、空闲链表和置换器
+        std::condition_variable io_cv_; // 分区内某个帧的I/O完成时通知等待该帧的线程
+        std::unordered_set<PageId, PageIdHash> writing_pages_;  // 后台清理线程正在写回(不持有帧)以及flush_all_pages正在写回的页面，它们始终留在页表中
+
+        /**
+         * 乐观读路径使用的无锁页表：开放定址，每个槽是一个原子的64位整数，高32位为PageId哈希值的高32位(标签)，
+         * 低32位为局部帧号加1，0表示空槽。一个页面只会出现在其哈希位置起的HINT_PROBES个槽内。
+         * 槽只在持有latch_时修改，读者不加锁查找；表项只是提示，读者pin住帧后还要核对帧中的页面，
+         * 因此过时的表项或写满时被覆盖的表项只会让访问退回加锁的路径
+         */
+        static constexpr size_t HINT_PROBES = 4;
+        std::unique_ptr<std::atomic<uint64_t>[]> hints_;
+        size_t hint_mask_;
+
+        Partition(frame_id_t first_frame, size_t size, size_t capacity, const std::string &replacer_type);
+        ~Partition();
+    };
+
+    std::atomic<size_t> pool_size_;     // buffer_pool中可容纳页面的个数，即可用帧的个数
+    size_t max_pool_size_;  // 预留的帧数，resize的上限
+    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为max_pool_size_
+    std::unique_ptr<FrameArena> arena_;  // 所有帧的页面数据，按PAGE_SIZE对齐的连续内存，第i个帧的数据位于arena_->data() + i * PAGE_SIZE
+    std::vector<std::unique_ptr<Partition>> partitions_;    // 缓冲池分区，帧按分区数平均划分
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::unique_ptr<Prefetcher> prefetcher_;    // 执行预读I/O的后台线程池
+
+    // 后台脏页清理线程(page cleaner)
+    std::thread cleaner_thread_;
+    std::mutex cleaner_latch_;              // 保护cleaner_stop_
+    std::condition_variable cleaner_cv_;    // 通知清理线程退出
+    bool cleaner_stop_ = false;
+    std::mutex clean_round_latch_;          // 同一时刻只进行一轮clean_pages，保护clean_buffer_
+    AlignedBuffer clean_buffer_;            // 清理时脏页的快照，按PAGE_SIZE对齐
+    size_t clean_buffer_pages_ = 0;         // clean_buffer_可容纳的页数
+    std::function<lsn_t()> flushed_lsn_getter_;     // 返回已持久化的最大日志号，为空时不检查WAL规则
+    std::atomic<uint64_t> pages_cleaned_{0};        // 后台清理线程写回的页数
+    std::atomic<uint64_t> pages_evicted_dirty_{0};  // 淘汰时仍为脏页、需要由前台线程写回的页数
+
+    std::mutex resize_latch_;               // 同一时刻只进行一次resize
+    bool optimistic_reads_ = OPTIMISTIC_READS;  // 缓冲池命中时是否先尝试不加锁的乐观读路径
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
+    /**
+     * @param {size_t} pool_size 缓冲池帧数
+     * @param {DiskManager*} disk_manager
+     * @param {size_t} num_partitions 分区数，默认为1(即单一页表、单一互斥锁)；帧数会平均分配到各分区
+     * @param {string} replacer_type 置换策略："LRU"、"CLOCK"或"LRU-K"，每个分区各自创建一个置换器
+     * @param {bool} huge_pages 帧数据区是否使用大页
+     * @param {size_t} max_pool_size resize允许的最大帧数，小于pool_size时取pool_size。只预留地址空间，
+     *                 超出pool_size的部分在扩容并使用之前不占用物理内存
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_partitions = 1,
+                      const std::string &replacer_type = REPLACER_TYPE, bool huge_pages = USE_HUGE_PAGES,
+                      size_t max_pool_size = 0)
+        : pool_size_(pool_size), max_pool_size_(std::max(pool_size, max_pool_size)), disk_manager_(disk_manager) {
+        assert(num_partitions > 0 && num_partitions <= pool_size);
+        // 将pool_size个帧和max_pool_size_个预留帧分别平均分给各分区，余数分给前面的分区
+        frame_id_t first_frame = 0;
+        for (size_t i = 0; i < num_partitions; ++i) {
+            size_t size = partition_share(pool_size, num_partitions, i);
+            size_t capacity = partition_share(max_pool_size_, num_partitions, i);
+            partitions_.emplace_back(std::make_unique<Partition>(first_frame, size, capacity, replacer_type));
+            first_frame += static_cast<frame_id_t>(capacity);
+        }
+        // 为buffer pool分配一块连续的内存空间：元数据和页面数据分开存放，页面数据按PAGE_SIZE对齐，可直接用于O_DIRECT读写
+        pages_ = new Page[max_pool_size_];
+        arena_ = std::make_unique<FrameArena>(max_pool_size_ * PAGE_SIZE, huge_pages);
+        for (size_t i = 0; i < max_pool_size_; i++) {
+            pages_[i].data_ = arena_->data() + i * PAGE_SIZE;
         }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        // 多个NUMA节点时各分区的帧轮流绑定到不同节点，避免整个缓冲池都分配在构造它的线程所在的节点上
+        int num_nodes = FrameArena::num_numa_nodes();
+        for (size_t i = 0; i < partitions_.size() && num_nodes > 1; ++i) {
+            arena_->bind_to_node(static_cast<size_t>(partitions_[i]->first_frame_) * PAGE_SIZE,
+                                 partitions_[i]->capacity_ * PAGE_SIZE, static_cast<int>(i % num_nodes));
         }
+        prefetcher_ = std::make_unique<Prefetcher>(PREFETCH_THREADS, PREFETCH_QUEUE_SIZE);
     }
 
     ~BufferPoolManager() {
+        // 先停止清理线程、等待所有预读I/O结束，它们会访问pages_和partitions_
+        stop_page_cleaner();
+        prefetcher_.reset();
+        partitions_.clear();
         delete[] pages_;
-        delete replacer_;
     }
 
     /**
@@ -63,8 +161,33 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_max_pool_size() const { return max_pool_size_; }
+
+    size_t get_num_partitions() const { return partitions_.size(); }
+
+    /** @description: 帧数据区是否使用了MAP_HUGETLB预留的大页 */
+    bool is_hugetlb() const { return arena_->is_hugetlb(); }
+
+    uint64_t get_pages_cleaned() const { return pages_cleaned_; }
+
+    uint64_t get_pages_evicted_dirty() const { return pages_evicted_dirty_; }
+
+    /**
+     * @description: 设置WAL规则的检查函数：日志号大于getter()返回值的脏页不会被清理线程写回。需在start_page_cleaner之前设置
+     * @param {function<lsn_t()>} getter 返回已持久化到磁盘的最大日志号
+     */
+    void set_flushed_lsn_getter(std::function<lsn_t()> getter) { flushed_lsn_getter_ = std::move(getter); }
+
+    /**
+     * @description: 打开或关闭fetch_page/unpin_page的乐观读路径，用于对比测试。需在没有其他线程访问缓冲池时调用
+     * @param {bool} enable 为false时所有访问都持有分区锁
+     */
+    void set_optimistic_reads(bool enable) { optimistic_reads_ = enable; }
+
    public: 
-    Page* fetch_page(PageId page_id);
+    Page* fetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr);
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
@@ -72,12 +195,89 @@ class BufferPoolManager {
 
     Page* new_page(PageId* page_id);
 
+    void prefetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr);
+
+    void prefetch_pages(int fd, page_id_t start_page_no, int num_pages, BufferAccessStrategy *strategy = nullptr);
+
     bool delete_page(PageId page_id);
 
     void flush_all_pages(int fd);
 
+    size_t clean_pages(size_t target_clean, size_t max_pages);
+
+    void start_page_cleaner(size_t target_clean = PAGE_CLEANER_TARGET_CLEAN, size_t max_pages = PAGE_CLEANER_MAX_PAGES,
+                            int interval_ms = PAGE_CLEANER_INTERVAL_MS);
+
+    void stop_page_cleaner();
+
+    void resize(size_t new_pool_size);
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    /** @description: total个帧平均分给num个分区时第i个分区分到的帧数，余数分给前面的分区 */
+    static size_t partition_share(size_t total, size_t num, size_t i) { return total / num + (i < total % num ? 1 : 0); }
+
+    bool retire_frames(Partition &part, size_t new_size, size_t old_size);
+
+    void restore_frames(Partition &part, size_t new_size, size_t old_size);
+
+    /** @description: 根据PageId的哈希值选择其所属的分区 */
+    Partition &get_partition(const PageId &page_id) {
+        return *partitions_[PageIdHash()(page_id) % partitions_.size()];
+    }
+
+    static uint64_t hint_hash(const PageId &page_id);
+
+    void hint_insert(Partition &part, const PageId &page_id, frame_id_t frame_id);
+
+    void hint_erase(Partition &part, const PageId &page_id, frame_id_t frame_id);
+
+    Page *fetch_page_optimistic(Partition &part, const PageId &page_id);
+
+    bool unpin_page_optimistic(Partition &part, const PageId &page_id);
+
+    void undo_optimistic_pin(Partition &part, Page *page);
+
+    static bool claim_frame(Page *page);
+
+    /** @description: claim_frame成功后帧的元数据修改完毕，版本号恢复为偶数 */
+    static void release_frame(Page *page) { page->version_++; }
+
+    /** @description: 把帧从置换器中移出，同步in_replacer_。调用者需持有part.latch_ */
+    void replacer_pin(Partition &part, frame_id_t frame_id) {
+        part.replacer_->pin(frame_id - part.first_frame_);
+        pages_[frame_id].in_replacer_ = false;
+    }
+
+    /** @description: 记录一次对帧中页面的访问(fetch_page、new_page)，并把帧从置换器中移出。调用者需持有part.latch_ */
+    void replacer_access(Partition &part, frame_id_t frame_id) {
+        replacer_pin(part, frame_id);
+        part.replacer_->record_access(frame_id - part.first_frame_);
+    }
+
+    /** @description: 把帧放回置换器，同步in_replacer_。调用者需持有part.latch_ */
+    void replacer_unpin(Partition &part, frame_id_t frame_id) {
+        part.replacer_->unpin(frame_id - part.first_frame_);
+        pages_[frame_id].in_replacer_ = true;
+    }
+
+    bool find_victim_page(Partition &part, frame_id_t* frame_id);
+
+    bool get_ring_frame(Partition &part, BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+    bool find_replace_frame(Partition &part, BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+    bool wait_for_cleaner(Partition &part, Page *page, PageId old_page_id);
+
+    bool reserve_frame(Partition &part, Page *page, PageId new_page_id, frame_id_t new_frame_id);
+
+    void finish_page_io(Partition &part, Page *page, PageId old_page_id, bool write_back, bool written,
+                        PageId new_page_id, frame_id_t new_frame_id, bool success, bool keep_pin);
+
+    void complete_page_io(Partition &part, std::unique_lock<std::mutex> &lock, Page *page, PageId old_page_id,
+                          bool write_back, PageId new_page_id, frame_id_t new_frame_id, bool read_from_disk);
+
+    void update_page(Partition &part, std::unique_lock<std::mutex> &lock, Page* page, PageId new_page_id,
+                     frame_id_t new_frame_id, bool read_from_disk);
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
+    void finish_flush(const std::vector<PageId> &page_ids, bool is_dirty);
 };
\ No newline at end of file
@@ -0,0 +1,225 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/compressed_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "errors.h"
+#include "storage/lz4.h"
+
+/**
+ * @description: 在新创建的空文件开头写入文件头，之后打开该文件时按页面压缩的格式读写
+ * @param {int} fd 文件句柄
+ */
+void CompressedFile::format(int fd) {
+    char hdr[SECTOR_SIZE] = {};
+    memcpy(hdr, &FILE_MAGIC, sizeof(FILE_MAGIC));
+    if (pwrite(fd, hdr, SECTOR_SIZE, 0) != SECTOR_SIZE) {
+        throw InternalError("CompressedFile::format Error");
+    }
+}
+
+/**
+ * @description: 判断文件是否是页面压缩的格式(以FILE_MAGIC开头)
+ * @param {string&} path 文件路径
+ */
+bool CompressedFile::is_compressed(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    uint64_t magic = 0;
+    ssize_t bytes_read = pread(fd, &magic, sizeof(magic), 0);
+    close(fd);
+    return bytes_read == sizeof(magic) && magic == FILE_MAGIC;
+}
+
+/**
+ * @description: 打开文件后扫描所有extent的头部，重建页号到extent的映射和空闲extent
+ */
+void CompressedFile::load() {
+    std::scoped_lock lock{latch_};
+    struct stat st;
+    if (fstat(fd_, &st) < 0) {
+        throw UnixError();
+    }
+    off_t size = st.st_size;
+    off_t offset = SECTOR_SIZE;
+    while (offset < size) {
+        PageExtentHdr hdr;
+        ssize_t bytes_read = pread(fd_, &hdr, sizeof(hdr), offset);
+        off_t len = static_cast<off_t>(hdr.num_sectors) * SECTOR_SIZE;
+        if (bytes_read != sizeof(hdr) || hdr.magic != EXTENT_MAGIC || hdr.num_sectors == 0 ||
+            hdr.num_sectors > MAX_EXTENT_SECTORS || offset + len > size) {
+            // 不完整的extent(如写到一半时崩溃)，跳过这个扇区
+            offset += SECTOR_SIZE;
+            continue;
+        }
+        Extent extent = {offset, hdr.seq, hdr.num_sectors};
+        auto it = extents_.find(hdr.page_no);
+        if (it == extents_.end()) {
+            extents_.emplace(hdr.page_no, extent);
+        } else if (it->second.seq < hdr.seq) {
+            free_extents_[it->second.num_sectors].push_back(it->second.offset);
+            it->second = extent;
+        } else {
+            free_extents_[extent.num_sectors].push_back(extent.offset);
+        }
+        next_seq_ = std::max(next_seq_, hdr.seq + 1);
+        num_pages_ = std::max(num_pages_, hdr.page_no + 1);
+        offset += len;
+    }
+    file_end_ = (offset + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE;
+}
+
+/**
+ * @description: 读取页面的前num_bytes个字节，整页解压后复制
+ */
+void CompressedFile::read_page(page_id_t page_no, char *offset, int num_bytes) {
+    if (num_bytes == PAGE_SIZE) {
+        read_full_page(page_no, offset);
+        return;
+    }
+    char page[PAGE_SIZE];
+    read_full_page(page_no, page);
+    memcpy(offset, page, num_bytes);
+}
+
+/**
+ * @description: 写入页面的前num_bytes个字节，页面其余内容保持不变
+ */
+void CompressedFile::write_page(page_id_t page_no, const char *offset, int num_bytes) {
+    if (num_bytes == PAGE_SIZE) {
+        write_full_page(page_no, offset);
+        return;
+    }
+    char page[PAGE_SIZE];
+    bool exists;
+    {
+        std::scoped_lock lock{latch_};
+        exists = page_no < num_pages_;
+    }
+    if (exists) {
+        read_full_page(page_no, page);
+    } else {
+        memset(page, 0, PAGE_SIZE);
+    }
+    memcpy(page, offset, num_bytes);
+    write_full_page(page_no, page);
+}
+
+/**
+ * @description: 读出并解压页面。页面所在的extent可能在读取时被搬走并重新分配给其他页面，此时头部与映射不一致，重新查找后再读
+ */
+void CompressedFile::read_full_page(page_id_t page_no, char *page) {
+    char buf[MAX_EXTENT_SECTORS * SECTOR_SIZE];
+    auto *hdr = reinterpret_cast<PageExtentHdr *>(buf);
+    Extent extent = {-1, 0, 0};
+    while (true) {
+        {
+            std::scoped_lock lock{latch_};
+            auto it = extents_.find(page_no);
+            if (it == extents_.end()) {
+                // 文件中间从未写过的页面读出全0，与普通文件的空洞一致
+                if (page_no >= num_pages_) {
+                    throw InternalError("DiskManager::read_page Error");
+                }
+                memset(page, 0, PAGE_SIZE);
+                return;
+            }
+            if (it->second.offset == extent.offset && it->second.seq == extent.seq) {
+                throw InternalError("CompressedFile: corrupted extent of page " + std::to_string(page_no));
+            }
+            extent = it->second;
+        }
+        ssize_t len = static_cast<ssize_t>(extent.num_sectors) * SECTOR_SIZE;
+        if (pread(fd_, buf, len, extent.offset) != len) {
+            throw InternalError("DiskManager::read_page Error");
+        }
+        if (hdr->magic == EXTENT_MAGIC && hdr->page_no == page_no && hdr->seq == extent.seq) {
+            break;
+        }
+    }
+    const char *data = buf + sizeof(PageExtentHdr);
+    if (!hdr->compressed) {
+        memcpy(page, data, PAGE_SIZE);
+    } else if (!lz4_decompress(data, hdr->data_len, page, PAGE_SIZE)) {
+        throw InternalError("CompressedFile: corrupted extent of page " + std::to_string(page_no));
+    }
+}
+
+/**
+ * @description: 压缩并写入页面，压缩后的大小变化时写到新的extent，写完后原extent变为空闲
+ */
+void CompressedFile::write_full_page(page_id_t page_no, const char *page) {
+    char buf[MAX_EXTENT_SECTORS * SECTOR_SIZE];
+    auto *hdr = reinterpret_cast<PageExtentHdr *>(buf);
+    char *data = buf + sizeof(PageExtentHdr);
+    int len = lz4_compress(page, PAGE_SIZE, data, PAGE_SIZE - 1);
+    memset(hdr, 0, sizeof(PageExtentHdr));
+    hdr->magic = EXTENT_MAGIC;
+    hdr->page_no = page_no;
+    if (len < 0) {
+        memcpy(data, page, PAGE_SIZE);
+        len = PAGE_SIZE;
+    } else {
+        hdr->compressed = 1;
+    }
+    hdr->data_len = static_cast<uint16_t>(len);
+    int num_sectors = (static_cast<int>(sizeof(PageExtentHdr)) + len + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    hdr->num_sectors = static_cast<uint8_t>(num_sectors);
+    ssize_t bytes = static_cast<ssize_t>(num_sectors) * SECTOR_SIZE;
+    memset(data + len, 0, bytes - sizeof(PageExtentHdr) - len);
+
+    std::scoped_lock lock{latch_};
+    hdr->seq = next_seq_++;
+    auto it = extents_.find(page_no);
+    bool in_place = it != extents_.end() && it->second.num_sectors == num_sectors;
+    off_t offset = in_place ? it->second.offset : alloc_extent(num_sectors);
+    if (pwrite(fd_, buf, bytes, offset) != bytes) {
+        throw InternalError("DiskManager::write_page Error");
+    }
+    if (it != extents_.end() && !in_place) {
+        free_extents_[it->second.num_sectors].push_back(it->second.offset);
+    }
+    extents_[page_no] = Extent{offset, hdr->seq, num_sectors};
+    num_pages_ = std::max(num_pages_, page_no + 1);
+}
+
+/**
+ * @description: 分配一个num_sectors个扇区的extent，优先使用同样大小的空闲extent。调用者需持有latch_
+ */
+off_t CompressedFile::alloc_extent(int num_sectors) {
+    auto &free_list = free_extents_[num_sectors];
+    if (!free_list.empty()) {
+        off_t offset = free_list.back();
+        free_list.pop_back();
+        return offset;
+    }
+    off_t offset = file_end_;
+    file_end_ += static_cast<off_t>(num_sectors) * SECTOR_SIZE;
+    return offset;
+}
+
+page_id_t CompressedFile::num_pages() {
+    std::scoped_lock lock{latch_};
+    return num_pages_;
+}
+
+off_t CompressedFile::physical_size() {
+    std::scoped_lock lock{latch_};
+    return file_end_;
+}
@@ -0,0 +1,86 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 页面压缩的数据文件。文件的第一个扇区是文件头(魔数)，之后是一个个extent，每个extent占整数个扇区，
+ * 由PageExtentHdr和页面压缩后的数据组成；压缩后不比原页面小的页面原样存放。
+ * 页号到extent的映射只保存在内存中，打开文件时扫描所有extent的头部重建：同一页面有多个extent时序号最大的有效，其余为空闲extent。
+ * 页面重写时压缩后的大小不变则原地覆盖，否则写到同样大小的空闲extent或文件末尾，写完后原来的extent才变为空闲，
+ * 空闲extent只会被同样扇区数的页面重新使用，因此extent的边界始终不变
+ */
+class CompressedFile {
+   public:
+    static constexpr int SECTOR_SIZE = 512;
+    static constexpr uint64_t FILE_MAGIC = 0x31305a5042444d52ULL;     // "RMDBPZ01"
+    static constexpr uint32_t EXTENT_MAGIC = 0x5458455a;              // "ZEXT"
+
+    /* 每个extent开头的头部 */
+    struct PageExtentHdr {
+        uint32_t magic;         // EXTENT_MAGIC
+        int32_t page_no;        // extent中存放的页面
+        uint64_t seq;           // 写入序号，文件内单调递增
+        uint16_t data_len;      // 头部之后数据的长度
+        uint8_t compressed;     // 数据是否经过压缩，为0时是原始页面
+        uint8_t num_sectors;    // extent占用的扇区数
+        uint32_t reserved;
+    };
+
+    static constexpr int MAX_EXTENT_SECTORS = (sizeof(PageExtentHdr) + PAGE_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+    explicit CompressedFile(int fd) : fd_(fd) {}
+
+    static void format(int fd);
+
+    static bool is_compressed(const std::string &path);
+
+    void load();
+
+    void read_page(page_id_t page_no, char *offset, int num_bytes);
+
+    void write_page(page_id_t page_no, const char *offset, int num_bytes);
+
+    page_id_t num_pages();
+
+    // 文件实际占用的字节数
+    off_t physical_size();
+
+   private:
+    struct Extent {
+        off_t offset;
+        uint64_t seq;
+        int num_sectors;
+    };
+
+    void read_full_page(page_id_t page_no, char *page);
+
+    void write_full_page(page_id_t page_no, const char *page);
+
+    off_t alloc_extent(int num_sectors);
+
+    int fd_;
+    std::mutex latch_;                              // 保护以下成员
+    std::unordered_map<page_id_t, Extent> extents_; // 页号到其有效extent的映射
+    std::vector<off_t> free_extents_[MAX_EXTENT_SECTORS + 1];   // 按扇区数分类的空闲extent
+    off_t file_end_ = SECTOR_SIZE;                  // 文件末尾，新的extent从这里分配
+    uint64_t next_seq_ = 1;
+    page_id_t num_pages_ = 0;                       // 文件的逻辑页数，即最大的页号加1
+};
@@ -0,0 +1,145 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+#include "storage/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82f63b78;  // Castagnoli多项式(按位反转)
+
+// 按8字节分段查表(slicing-by-8)：table[k][b]为字节b之后再跟k个0字节的CRC
+struct Crc32cTable {
+    uint32_t table[8][256];
+
+    constexpr Crc32cTable() : table() {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; i++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+            }
+        }
+    }
+};
+
+constexpr Crc32cTable crc_table;  // 编译期生成
+
+uint32_t crc32c_sw(const void *data, size_t len, uint32_t crc) {
+    auto p = static_cast<const uint8_t *>(data);
+    auto &t = crc_table.table;
+    crc = ~crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        v ^= crc;
+        crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff] ^
+              t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+    }
+    for (; len > 0; len--, p++) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+// crc32指令延迟3个周期、每周期可以发射一条，单条依赖链只用到1/3的吞吐。硬件实现把数据分成连续的三段并行计算，
+// 再把前面段的CRC寄存器"移过"后面段的长度合并。不做首尾取反时CRC寄存器的更新是线性的：
+// S(s, A || B) = M_|B|(S(s, A)) ^ S(0, B)，其中M_|B|(s)为s之后跟|B|个0字节的寄存器值，对固定的段长按字节查表计算
+constexpr size_t CRC32C_LANE = 1360;  // 每段的字节数，三段4080字节，正好覆盖一个页面的主体
+
+struct Crc32cShift {
+    uint32_t table[4][256];  // M_LANE(s) = table[0][s的第0字节] ^ ... ^ table[3][s的第3字节]
+
+    constexpr Crc32cShift() : table() {
+        uint32_t basis[32] = {};
+        for (int bit = 0; bit < 32; bit++) {
+            uint32_t s = 1u << bit;
+            for (size_t i = 0; i < CRC32C_LANE; i++) {
+                s = (s >> 8) ^ crc_table.table[0][s & 0xff];
+            }
+            basis[bit] = s;
+        }
+        for (int k = 0; k < 4; k++) {
+            for (uint32_t b = 0; b < 256; b++) {
+                for (int bit = 0; bit < 8; bit++) {
+                    if (b & (1u << bit)) {
+                        table[k][b] ^= basis[k * 8 + bit];
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t operator()(uint32_t s) const {
+        return table[0][s & 0xff] ^ table[1][(s >> 8) & 0xff] ^ table[2][(s >> 16) & 0xff] ^ table[3][s >> 24];
+    }
+};
+
+constexpr Crc32cShift crc_shift;  // 编译期生成
+
+// 单独以sse4.2为目标编译，其余代码不要求CPU支持SSE4.2，运行时检测后再选用
+__attribute__((target("sse4.2"))) uint32_t crc32c_hw(const void *data, size_t len, uint32_t crc) {
+    auto p = static_cast<const uint8_t *>(data);
+    uint64_t c = ~crc;
+    for (; len >= 3 * CRC32C_LANE; len -= 3 * CRC32C_LANE, p += 3 * CRC32C_LANE) {
+        uint64_t c1 = 0, c2 = 0;
+        for (size_t i = 0; i < CRC32C_LANE; i += 8) {
+            uint64_t v0, v1, v2;
+            memcpy(&v0, p + i, sizeof(v0));
+            memcpy(&v1, p + CRC32C_LANE + i, sizeof(v1));
+            memcpy(&v2, p + 2 * CRC32C_LANE + i, sizeof(v2));
+            c = _mm_crc32_u64(c, v0);
+            c1 = _mm_crc32_u64(c1, v1);
+            c2 = _mm_crc32_u64(c2, v2);
+        }
+        c = crc_shift(crc_shift(static_cast<uint32_t>(c)) ^ static_cast<uint32_t>(c1)) ^ static_cast<uint32_t>(c2);
+    }
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        c = _mm_crc32_u64(c, v);
+    }
+    auto c32 = static_cast<uint32_t>(c);
+    for (; len > 0; len--, p++) {
+        c32 = _mm_crc32_u8(c32, *p);
+    }
+    return ~c32;
+}
+
+const bool has_sse42 = [] {
+    __builtin_cpu_init();  // 可能在其他全局对象的构造中使用，先初始化CPU特性信息
+    return __builtin_cpu_supports("sse4.2") != 0;
+}();
+#else
+const bool has_sse42 = false;
+#endif
+
+}  // namespace
+
+uint32_t crc32c(const void *data, size_t len, uint32_t crc) {
+#if defined(__x86_64__)
+    if (has_sse42) {
+        return crc32c_hw(data, len, crc);
+    }
+#endif
+    return crc32c_sw(data, len, crc);
+}
+
+bool crc32c_hardware() { return has_sse42; }
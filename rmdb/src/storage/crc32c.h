@@ -0,0 +1,30 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC32C(Castagnoli多项式)校验和，用于页面校验。
+ * x86上CPU支持SSE4.2时使用crc32指令，否则使用查表法，两者结果相同
+ */
+
+/**
+ * @description: 计算data中len字节的CRC32C，可以分段计算：后一段以前一段的返回值作为crc
+ * @param {void*} data 数据
+ * @param {size_t} len 数据长度
+ * @param {uint32_t} crc 之前各段的CRC32C，第一段为0
+ * @return {uint32_t} 到这一段为止的CRC32C
+ */
+uint32_t crc32c(const void *data, size_t len, uint32_t crc = 0);
+
+/** @description: crc32c()是否使用了SSE4.2的硬件指令 */
+bool crc32c_hardware();
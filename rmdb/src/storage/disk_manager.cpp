@@ -11,11 +11,32 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <limits.h>    // for IOV_MAX
+#include <errno.h>     // for errno
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for preadv, pwritev
+#include <unistd.h>    // for lseek, pread, pwrite
+
+#include <algorithm>
+#include <vector>
 
 #include "defs.h"
+#include "storage/crc32c.h"
+#include "storage/page.h"
+
+namespace {
+// 计算和校验页面校验和时使用的线程私有的页面缓冲区，按PAGE_SIZE对齐，O_DIRECT文件也可以直接读写
+char *checksum_buffer(int num_pages = 1) {
+    static thread_local AlignedBuffer buf;
+    static thread_local int capacity = 0;
+    if (capacity < num_pages) {
+        buf = alloc_aligned_buffer(static_cast<size_t>(num_pages) * PAGE_SIZE);
+        capacity = num_pages;
+    }
+    return buf.get();
+}
+}  // namespace
 
 DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
 
@@ -27,43 +48,292 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
+    if (!checksum_fds_[fd]) {
+        write_page_raw(fd, page_no, offset, num_bytes);
+        return;
+    }
+    // 在副本上填入校验和，缓冲池中的页面可能正被其他线程读取；只写页面的一部分时先读出原页面，整页写回
+    char *page = checksum_buffer();
+    if (num_bytes < PAGE_SIZE) {
+        read_existing_page(fd, page_no, page);
+    }
+    memcpy(page, offset, num_bytes);
+    uint32_t checksum = page_checksum(page, page_no);
+    memcpy(page + Page::OFFSET_CHECKSUM, &checksum, sizeof(checksum));
+    write_page_raw(fd, page_no, page, PAGE_SIZE);
+}
+
+/**
+ * @description: 读取文件中指定编号的页面中的部分数据到内存中，带校验和的文件整页读入并校验
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 指定的页面编号
+ * @param {char} *offset 读取的内容写入到offset中
+ * @param {int} num_bytes 读取的数据量大小
+ */
+void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
+    if (!checksum_fds_[fd]) {
+        read_page_raw(fd, page_no, offset, num_bytes);
+        return;
+    }
+    if (num_bytes == PAGE_SIZE) {
+        read_page_raw(fd, page_no, offset, PAGE_SIZE);
+        check_page(fd, page_no, offset);
+        return;
+    }
+    char *page = checksum_buffer();
+    read_page_raw(fd, page_no, page, PAGE_SIZE);
+    check_page(fd, page_no, page);
+    memcpy(offset, page, num_bytes);
+}
+
+/**
+ * @description: 写入页面，不处理校验和
+ */
+void DiskManager::write_page_raw(int fd, page_id_t page_no, const char *offset, int num_bytes) {
     // Todo:
     // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
     // 2.调用write()函数
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
-        off_t offset_in_file = static_cast<off_t>(page_no * PAGE_SIZE); // 计算页面在文件中的偏移量
-        if (lseek(fd, offset_in_file, SEEK_SET) == -1) {
-            throw InternalError("DiskManager::write_page Error: lseek failed");
+        if (compressed_files_[fd] != nullptr) {
+            compressed_files_[fd]->write_page(page_no, offset, num_bytes);
+            return;
+        }
+        if (direct_fds_[fd] && !is_aligned_io(offset, num_bytes)) {
+            write_page_bounced(fd, page_no, offset, num_bytes);
+            return;
         }
-        
-        ssize_t bytes_written = write(fd, offset, num_bytes); // 写入数据到文件
+        // 使用pwrite，不移动共享的文件偏移量，多个线程可以并发读写同一文件的不同页面
+        off_t offset_in_file = static_cast<off_t>(page_no) * PAGE_SIZE; // 计算页面在文件中的偏移量
+        ssize_t bytes_written = pwrite(fd, offset, num_bytes, offset_in_file); // 写入数据到文件
         if (bytes_written != num_bytes) {
             throw InternalError("DiskManager::write_page Error");
         }
 }
 
 /**
- * @description: 读取文件中指定编号的页面中的部分数据到内存中
- * @param {int} fd 磁盘文件的文件句柄
- * @param {page_id_t} page_no 指定的页面编号
- * @param {char} *offset 读取的内容写入到offset中
- * @param {int} num_bytes 读取的数据量大小
+ * @description: 读取页面，不校验校验和
  */
-void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
+void DiskManager::read_page_raw(int fd, page_id_t page_no, char *offset, int num_bytes) {
     // Todo:
     // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
     // 2.调用read()函数
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
-        off_t offset_bytes = static_cast<off_t>(page_no * PAGE_SIZE); // PAGE_SIZE 是页面大小的常量
-        if (lseek(fd, offset_bytes, SEEK_SET) == -1) {
-            throw InternalError("DiskManager::read_page Error: lseek failed");
+        if (compressed_files_[fd] != nullptr) {
+            compressed_files_[fd]->read_page(page_no, offset, num_bytes);
+            return;
+        }
+        if (direct_fds_[fd] && !is_aligned_io(offset, num_bytes)) {
+            read_page_bounced(fd, page_no, offset, num_bytes);
+            return;
         }
-        ssize_t bytes_read = read(fd, offset, num_bytes);
+        off_t offset_bytes = static_cast<off_t>(page_no) * PAGE_SIZE; // PAGE_SIZE 是页面大小的常量
+        ssize_t bytes_read = pread(fd, offset, num_bytes, offset_bytes);
         if (bytes_read != num_bytes) {
             throw InternalError("DiskManager::read_page Error");
         }
 }
 
+/**
+ * @description: 将num_pages个页面写入文件中从start_page_no开始的连续页面，每个页面的数据可以位于不连续的内存中。
+ *              使用pwritev，一次系统调用写入一段连续的磁盘区域(每次最多IOV_MAX个页面)
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的页号
+ * @param {char* const*} bufs 每个页面的数据，每个大小为PAGE_SIZE
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::write_pages(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages) {
+    if (!checksum_fds_[fd]) {
+        write_pages_raw(fd, start_page_no, bufs, num_pages);
+        return;
+    }
+    // 复制到连续的缓冲区中填入校验和，仍然一次写出
+    char *pages = checksum_buffer(num_pages);
+    std::vector<const char *> copies(num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        char *page = pages + static_cast<size_t>(i) * PAGE_SIZE;
+        memcpy(page, bufs[i], PAGE_SIZE);
+        uint32_t checksum = page_checksum(page, start_page_no + i);
+        memcpy(page + Page::OFFSET_CHECKSUM, &checksum, sizeof(checksum));
+        copies[i] = page;
+    }
+    write_pages_raw(fd, start_page_no, copies.data(), num_pages);
+}
+
+/**
+ * @description: 读取文件中从start_page_no开始的num_pages个连续页面，每个页面读入bufs中对应的内存。
+ *              使用preadv，一次系统调用读取一段连续的磁盘区域(每次最多IOV_MAX个页面)，带校验和的文件逐页校验
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的页号
+ * @param {char* const*} bufs 每个页面读入的位置，每个大小为PAGE_SIZE
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    read_pages_raw(fd, start_page_no, bufs, num_pages);
+    if (checksum_fds_[fd]) {
+        for (int i = 0; i < num_pages; i++) {
+            check_page(fd, start_page_no + i, bufs[i]);
+        }
+    }
+}
+
+/**
+ * @description: 连续写入多个页面，不处理校验和
+ */
+void DiskManager::write_pages_raw(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages) {
+    // 压缩文件中连续的页面在磁盘上不连续，逐页写入
+    if (compressed_files_[fd] != nullptr ||
+        (direct_fds_[fd] && !std::all_of(bufs, bufs + num_pages, [](const char *buf) { return is_aligned_io(buf, 0); }))) {
+        for (int i = 0; i < num_pages; i++) {
+            write_page_raw(fd, start_page_no + i, bufs[i], PAGE_SIZE);
+        }
+        return;
+    }
+    struct iovec iov[IOV_MAX];
+    int done = 0;
+    while (done < num_pages) {
+        int n = std::min(num_pages - done, IOV_MAX);
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = const_cast<char *>(bufs[done + i]);
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        off_t offset_in_file = static_cast<off_t>(start_page_no + done) * PAGE_SIZE;
+        ssize_t bytes_written = pwritev(fd, iov, n, offset_in_file);
+        if (bytes_written <= 0 || bytes_written % PAGE_SIZE != 0) {
+            throw InternalError("DiskManager::write_pages Error");
+        }
+        // 可能只写入了一部分页面，剩下的下一轮继续写
+        done += static_cast<int>(bytes_written / PAGE_SIZE);
+    }
+}
+
+/**
+ * @description: 连续读取多个页面，不校验校验和
+ */
+void DiskManager::read_pages_raw(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    if (compressed_files_[fd] != nullptr ||
+        (direct_fds_[fd] && !std::all_of(bufs, bufs + num_pages, [](const char *buf) { return is_aligned_io(buf, 0); }))) {
+        for (int i = 0; i < num_pages; i++) {
+            read_page_raw(fd, start_page_no + i, bufs[i], PAGE_SIZE);
+        }
+        return;
+    }
+    struct iovec iov[IOV_MAX];
+    int done = 0;
+    while (done < num_pages) {
+        int n = std::min(num_pages - done, IOV_MAX);
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = bufs[done + i];
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        off_t offset_in_file = static_cast<off_t>(start_page_no + done) * PAGE_SIZE;
+        ssize_t bytes_read = preadv(fd, iov, n, offset_in_file);
+        // 读到文件末尾或者读到不完整的页面都视为错误
+        if (bytes_read <= 0 || bytes_read % PAGE_SIZE != 0) {
+            throw InternalError("DiskManager::read_pages Error");
+        }
+        done += static_cast<int>(bytes_read / PAGE_SIZE);
+    }
+}
+
+/**
+ * @description: 计算页面的校验和：页号和页面中[0, Page::OFFSET_CHECKSUM)的CRC32C，
+ *              页号参与计算，写错位置的页面也能被发现
+ * @param {char*} page 页面数据
+ * @param {page_id_t} page_no 页号
+ */
+uint32_t DiskManager::page_checksum(const char *page, page_id_t page_no) {
+    return crc32c(page, Page::OFFSET_CHECKSUM, crc32c(&page_no, sizeof(page_no)));
+}
+
+/**
+ * @description: 页面的校验和是否正确。全0的页面是分配后还没有写出过的页面(文件中的空洞)，视为正确
+ * @param {char*} page 页面数据
+ * @param {page_id_t} page_no 页号
+ */
+bool DiskManager::is_page_valid(const char *page, page_id_t page_no) {
+    uint32_t stored;
+    memcpy(&stored, page + Page::OFFSET_CHECKSUM, sizeof(stored));
+    if (stored == page_checksum(page, page_no)) {
+        return true;
+    }
+    return stored == 0 && std::all_of(page, page + PAGE_SIZE, [](char c) { return c == 0; });
+}
+
+/**
+ * @description: 直接从磁盘读出页面并检查校验和，不经过缓冲池，用于VERIFY TABLE
+ * @return {bool} 校验和是否正确，不带校验和的文件总是返回true
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 页号
+ */
+bool DiskManager::verify_page(int fd, page_id_t page_no) {
+    if (!checksum_fds_[fd]) {
+        return true;
+    }
+    char *page = checksum_buffer();
+    read_page_raw(fd, page_no, page, PAGE_SIZE);
+    return is_page_valid(page, page_no);
+}
+
+/**
+ * @description: 校验读入的页面，校验和不一致时抛出PageChecksumError
+ */
+void DiskManager::check_page(int fd, page_id_t page_no, const char *page) {
+    if (!is_page_valid(page, page_no)) {
+        throw PageChecksumError(get_file_name(fd), page_no);
+    }
+}
+
+/**
+ * @description: 读出页面的原内容用于整页写回，页面还不在文件中时读出全0
+ */
+void DiskManager::read_existing_page(int fd, page_id_t page_no, char *page) {
+    if (compressed_files_[fd] != nullptr) {
+        if (page_no < compressed_files_[fd]->num_pages()) {
+            compressed_files_[fd]->read_page(page_no, page, PAGE_SIZE);
+        } else {
+            memset(page, 0, PAGE_SIZE);
+        }
+        return;
+    }
+    ssize_t bytes_read = pread(fd, page, PAGE_SIZE, static_cast<off_t>(page_no) * PAGE_SIZE);
+    if (bytes_read < 0) {
+        throw UnixError();
+    }
+    memset(page + bytes_read, 0, PAGE_SIZE - bytes_read);
+}
+
+/**
+ * @description: O_DIRECT文件上不满足对齐要求的写(如小于一页的文件头)：经过一块对齐的临时缓冲区，
+ *              先读出所在页面的原内容，覆盖前num_bytes个字节后整页写回，文件中其余字节保持不变
+ */
+void DiskManager::write_page_bounced(int fd, page_id_t page_no, const char *offset, int num_bytes) {
+    size_t len = (static_cast<size_t>(num_bytes) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    AlignedBuffer buf = alloc_aligned_buffer(len);
+    off_t offset_in_file = static_cast<off_t>(page_no) * PAGE_SIZE;
+    ssize_t bytes_read = pread(fd, buf.get(), len, offset_in_file);
+    if (bytes_read < 0) {
+        throw UnixError();
+    }
+    memset(buf.get() + bytes_read, 0, len - bytes_read);  // 文件末尾之后的部分补0
+    memcpy(buf.get(), offset, num_bytes);
+    if (pwrite(fd, buf.get(), len, offset_in_file) != static_cast<ssize_t>(len)) {
+        throw InternalError("DiskManager::write_page Error");
+    }
+}
+
+/**
+ * @description: O_DIRECT文件上不满足对齐要求的读：整页读入一块对齐的临时缓冲区，再复制前num_bytes个字节
+ */
+void DiskManager::read_page_bounced(int fd, page_id_t page_no, char *offset, int num_bytes) {
+    size_t len = (static_cast<size_t>(num_bytes) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    AlignedBuffer buf = alloc_aligned_buffer(len);
+    ssize_t bytes_read = pread(fd, buf.get(), len, static_cast<off_t>(page_no) * PAGE_SIZE);
+    if (bytes_read < num_bytes) {
+        throw InternalError("DiskManager::read_page Error");
+    }
+    memcpy(offset, buf.get(), num_bytes);
+}
+
 /**
  * @description: 分配一个新的页号
  * @return {page_id_t} 分配的新页号
@@ -121,10 +391,14 @@ void DiskManager::create_file(const std::string &path) {
         throw FileExistsError(path); // 文件已存在
     }
     //int fd = open(path.c_str(), O_CREAT | O_EXCL, 0777); // 创建文件
-    int fd = open(path.c_str(), O_CREAT, 0777);
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY, 0777);
     if (fd < 0) {
         throw UnixError(); // 创建文件失败
     }
+    // 日志文件按字节追加写，不压缩
+    if (compression_ && path != LOG_FILE_NAME) {
+        CompressedFile::format(fd);
+    }
 }
 
 /**
@@ -162,10 +436,23 @@ int DiskManager::open_file(const std::string &path) {
     if (path2fd_.find(path) != path2fd_.end()) {
         throw FileNotClosedError(path); // 文件已打开
     }
-    int fd = open(path.c_str(), O_RDWR);
+    bool compressed = path != LOG_FILE_NAME && CompressedFile::is_compressed(path);
+    bool direct = direct_io_ && path != LOG_FILE_NAME && !compressed;
+    int fd = open(path.c_str(), O_RDWR | (direct ? O_DIRECT : 0));
+    if (fd < 0 && direct && errno == EINVAL) {
+        // 文件系统不支持O_DIRECT(如tmpfs)，退回普通I/O
+        direct = false;
+        fd = open(path.c_str(), O_RDWR);
+    }
     if (fd < 0) {
         throw UnixError(); // 打开文件失败
     }
+    direct_fds_[fd] = direct;
+    checksum_fds_[fd] = false;
+    if (compressed) {
+        compressed_files_[fd] = std::make_unique<CompressedFile>(fd);
+        compressed_files_[fd]->load();
+    }
     path2fd_[path] = fd; // 更新文件打开列表
     fd2path_[fd] = path;
     return fd;
@@ -186,17 +473,24 @@ void DiskManager::close_file(int fd) {
         throw UnixError(); // 关闭文件失败
     }
     std::string path = fd2path_[fd];
+    direct_fds_[fd] = false;
+    checksum_fds_[fd] = false;
+    compressed_files_[fd].reset();
     fd2path_.erase(fd); // 更新文件打开列表
     path2fd_.erase(path);
 }
 
 
 /**
- * @description: 获得文件的大小
+ * @description: 获得文件的大小，已打开的压缩文件返回其逻辑大小(页数 * PAGE_SIZE)
  * @return {int} 文件的大小
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_size(const std::string &file_name) {
+    auto it = path2fd_.find(file_name);
+    if (it != path2fd_.end() && compressed_files_[it->second] != nullptr) {
+        return compressed_files_[it->second]->num_pages() * PAGE_SIZE;
+    }
     struct stat stat_buf;
     int rc = stat(file_name.c_str(), &stat_buf);
     return rc == 0 ? stat_buf.st_size : -1;
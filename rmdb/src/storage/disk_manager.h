@@ -15,13 +15,37 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>    
 
 #include <atomic>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <string>
 #include <unordered_map>
 
 #include "common/config.h"
 #include "errors.h"  
+#include "storage/compressed_file.h"
+
+/**
+ * 按PAGE_SIZE对齐的内存块，O_DIRECT读写使用的内存必须按块对齐
+ */
+struct AlignedDeleter {
+    void operator()(char *ptr) const { free(ptr); }
+};
+using AlignedBuffer = std::unique_ptr<char[], AlignedDeleter>;
+
+/**
+ * @description: 申请size字节、起始地址按PAGE_SIZE对齐的内存
+ * @param {size_t} size 字节数
+ */
+inline AlignedBuffer alloc_aligned_buffer(size_t size) {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, PAGE_SIZE, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return AlignedBuffer(static_cast<char *>(ptr));
+}
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -36,6 +60,10 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void write_pages(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages);
+
+    void read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
     page_id_t allocate_page(int fd);
 
     void deallocate_page(page_id_t page_id);
@@ -87,13 +115,91 @@ class DiskManager {
      */
     page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
 
+    /**
+     * @description: 设置之后打开的数据文件(表文件和索引文件)是否使用O_DIRECT，绕过内核页缓存，避免与缓冲池重复缓存页面。
+     *              日志文件按字节追加写，始终使用普通I/O
+     * @param {bool} direct_io 是否使用O_DIRECT
+     */
+    void set_direct_io(bool direct_io) { direct_io_ = direct_io; }
+
+    /** @description: 文件是否以O_DIRECT方式打开 */
+    bool is_direct_io(int fd) const { return direct_fds_[fd]; }
+
+    /**
+     * @description: 设置之后创建的数据文件(表文件和索引文件)是否使用页面压缩。文件是否压缩记录在文件头中，
+     *              打开时自动识别，与创建时的设置无关；压缩文件不使用O_DIRECT
+     * @param {bool} compression 是否压缩
+     */
+    void set_compression(bool compression) { compression_ = compression; }
+
+    /** @description: 文件是否是页面压缩的格式 */
+    bool is_compressed(int fd) const { return compressed_files_[fd] != nullptr; }
+
+    /** @description: 压缩文件实际占用的磁盘空间 */
+    off_t get_compressed_size(int fd) const { return compressed_files_[fd]->physical_size(); }
+
+    /**
+     * @description: 设置之后新创建的表和索引文件是否使用页面校验和。文件是否使用校验和记录在各自的文件头
+     *              (RmFileHdr/IxFileHdr)中，已有的文件按创建时的设置打开，不受这里的影响
+     * @param {bool} checksums 是否使用校验和
+     */
+    void set_page_checksums(bool checksums) { page_checksums_ = checksums; }
+
+    /** @description: 新创建的表和索引文件是否使用页面校验和 */
+    bool page_checksums() const { return page_checksums_; }
+
+    /**
+     * @description: 设置已打开的文件是否使用页面校验和：写出页面时在Page::OFFSET_CHECKSUM处填入CRC32C，
+     *              读入时校验，不一致抛出PageChecksumError。open_file打开的文件默认不使用，
+     *              上层读出文件头之后按其中的记录设置
+     * @param {int} fd 文件句柄
+     * @param {bool} checksums 是否使用校验和
+     */
+    void set_file_checksums(int fd, bool checksums) { checksum_fds_[fd] = checksums; }
+
+    /** @description: 文件的页面是否带有校验和 */
+    bool has_page_checksums(int fd) const { return checksum_fds_[fd]; }
+
+    static uint32_t page_checksum(const char *page, page_id_t page_no);
+
+    static bool is_page_valid(const char *page, page_id_t page_no);
+
+    bool verify_page(int fd, page_id_t page_no);
+
     static constexpr int MAX_FD = 8192;
 
    private:
+    /** @description: O_DIRECT文件的读写是否满足对齐要求(内存地址和长度都按PAGE_SIZE对齐) */
+    static bool is_aligned_io(const void *buf, int num_bytes) {
+        return reinterpret_cast<uintptr_t>(buf) % PAGE_SIZE == 0 && num_bytes % PAGE_SIZE == 0;
+    }
+
+    void write_page_raw(int fd, page_id_t page_no, const char *offset, int num_bytes);
+
+    void read_page_raw(int fd, page_id_t page_no, char *offset, int num_bytes);
+
+    void write_pages_raw(int fd, page_id_t start_page_no, const char *const *bufs, int num_pages);
+
+    void read_pages_raw(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
+    void read_existing_page(int fd, page_id_t page_no, char *page);
+
+    void check_page(int fd, page_id_t page_no, const char *page);
+
+    void write_page_bounced(int fd, page_id_t page_no, const char *offset, int num_bytes);
+
+    void read_page_bounced(int fd, page_id_t page_no, char *offset, int num_bytes);
+
     // 文件打开列表，用于记录文件是否被打开
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+    bool direct_io_ = false;                      // 新打开的数据文件是否使用O_DIRECT
+    std::atomic<bool> direct_fds_[MAX_FD]{};      // 文件是否以O_DIRECT方式打开
+    bool compression_ = false;                    // 新创建的数据文件是否使用页面压缩
+    std::unique_ptr<CompressedFile> compressed_files_[MAX_FD];  // 页面压缩的文件，其他文件为nullptr
+    bool page_checksums_ = false;                 // 新创建的表和索引文件是否使用页面校验和
+    std::atomic<bool> checksum_fds_[MAX_FD]{};    // 文件的页面是否带有校验和
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <new>
+
+#ifdef RMDB_HAVE_NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+FrameArena::FrameArena(size_t size, bool huge_pages) : size_(size) {
+    void *ptr = MAP_FAILED;
+    if (huge_pages && size_ >= HUGE_PAGE_SIZE) {
+        // MAP_HUGETLB需要系统预留大页(vm.nr_hugepages)，预留不足时mmap失败
+        mapped_size_ = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        ptr = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        hugetlb_ = ptr != MAP_FAILED;
+    }
+    if (ptr == MAP_FAILED) {
+        mapped_size_ = size_;
+        ptr = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (huge_pages) {
+            // 只是建议，内核不支持透明大页时忽略错误
+            madvise(ptr, mapped_size_, MADV_HUGEPAGE);
+        }
+    }
+    data_ = static_cast<char *>(ptr);
+}
+
+FrameArena::~FrameArena() { munmap(data_, mapped_size_); }
+
+/**
+ * @description: 将arena中[offset, offset + len)的内存绑定到NUMA节点node上，之后第一次访问时在该节点上分配物理页。
+ *              没有libnuma或系统只有一个节点时不做任何事；绑定失败同样忽略，内存仍然可用
+ * @param {size_t} offset 起始偏移，需按PAGE_SIZE对齐；使用MAP_HUGETLB时只绑定其中按大页对齐的部分
+ * @param {size_t} len 字节数
+ * @param {int} node NUMA节点编号
+ */
+void FrameArena::bind_to_node(size_t offset, size_t len, int node) {
+#ifdef RMDB_HAVE_NUMA
+    unsigned long nodemask = 0;
+    if (num_numa_nodes() <= 1 || node >= static_cast<int>(sizeof(nodemask) * 8)) {
+        return;
+    }
+    size_t end = offset + len;
+    if (hugetlb_) {
+        offset = (offset + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        end = end / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+    if (end <= offset) {
+        return;
+    }
+    nodemask = 1UL << node;
+    mbind(data_ + offset, end - offset, MPOL_BIND, &nodemask, sizeof(nodemask) * 8, 0);
+#else
+    (void)offset;
+    (void)len;
+    (void)node;
+#endif
+}
+
+/**
+ * @description: 把arena中[offset, offset + len)的物理内存还给操作系统(MADV_DONTNEED)，地址空间仍然保留，
+ *              之后再次访问时得到清零的新页面。使用MAP_HUGETLB时只释放其中完整的大页
+ * @param {size_t} offset 起始偏移，需按PAGE_SIZE对齐
+ * @param {size_t} len 字节数
+ */
+void FrameArena::release(size_t offset, size_t len) {
+    size_t end = offset + len;
+    if (hugetlb_) {
+        offset = (offset + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        end = end / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+    if (end > offset) {
+        madvise(data_ + offset, end - offset, MADV_DONTNEED);
+    }
+}
+
+/**
+ * @description: 系统中可用的NUMA节点数，没有libnuma时返回1
+ */
+int FrameArena::num_numa_nodes() {
+#ifdef RMDB_HAVE_NUMA
+    if (numa_available() < 0) {
+        return 1;
+    }
+    return numa_num_configured_nodes();
+#else
+    return 1;
+#endif
+}
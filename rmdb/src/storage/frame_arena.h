@@ -0,0 +1,55 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @description: 缓冲池帧数据区(arena)，一块按PAGE_SIZE对齐、用mmap申请的连续内存。
+ * 开启大页时优先使用MAP_HUGETLB预留的大页；系统没有预留大页时退回普通页，并用MADV_HUGEPAGE建议内核使用透明大页。
+ * 大缓冲池因此只占用很少的TLB项，随机访问页面(如索引查找)时TLB miss明显减少。
+ * 编译时检测到libnuma(RMDB_HAVE_NUMA)时，可以把arena中的某一段绑定到指定的NUMA节点上；否则bind_to_node不做任何事。
+ * mmap得到的内存已经清零，且在第一次访问时才真正分配物理页。
+ */
+class FrameArena {
+   public:
+    /**
+     * @param {size_t} size arena的字节数
+     * @param {bool} huge_pages 是否尝试使用大页
+     */
+    FrameArena(size_t size, bool huge_pages);
+
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    char *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    /** @description: 是否使用了MAP_HUGETLB预留的大页 */
+    bool is_hugetlb() const { return hugetlb_; }
+
+    void bind_to_node(size_t offset, size_t len, int node);
+
+    void release(size_t offset, size_t len);
+
+    static int num_numa_nodes();
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;  // x86-64默认大页大小
+
+   private:
+    char *data_;
+    size_t size_;           // 用户请求的字节数
+    size_t mapped_size_;    // 实际映射的字节数(使用MAP_HUGETLB时按HUGE_PAGE_SIZE向上取整)
+    bool hugetlb_ = false;
+};
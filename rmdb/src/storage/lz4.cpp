@@ -0,0 +1,187 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/lz4.h"
+
+#include <cstdint>
+#include <cstring>
+
+static constexpr int LZ4_MIN_MATCH = 4;
+static constexpr int LZ4_LAST_LITERALS = 5;    // 最后5个字节总是字面量
+static constexpr int LZ4_MF_LIMIT = 12;        // 最后一个匹配必须在输入结束前至少12字节处开始
+static constexpr int LZ4_MAX_OFFSET = 65535;
+static constexpr int LZ4_HASH_BITS = 12;
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t seq) { return (seq * 2654435761U) >> (32 - LZ4_HASH_BITS); }
+
+/**
+ * @description: 写出长度len超过15的部分：若干个255和最后一个小于255的字节
+ * @return {bool} 输出空间是否足够
+ */
+static bool write_length(uint8_t *&op, const uint8_t *oend, int len) {
+    for (; len >= 255; len -= 255) {
+        if (op >= oend) {
+            return false;
+        }
+        *op++ = 255;
+    }
+    if (op >= oend) {
+        return false;
+    }
+    *op++ = static_cast<uint8_t>(len);
+    return true;
+}
+
+/**
+ * @description: 写出一个序列：[anchor, anchor + lit_len)处的字面量，以及偏移为offset、长度为match_len的匹配；match_len为0时是最后一个序列
+ */
+static bool write_sequence(uint8_t *&op, const uint8_t *oend, const uint8_t *anchor, int lit_len, int offset,
+                           int match_len) {
+    if (op >= oend) {
+        return false;
+    }
+    uint8_t *token = op++;
+    int ml = match_len > 0 ? match_len - LZ4_MIN_MATCH : 0;
+    *token = static_cast<uint8_t>((lit_len < 15 ? lit_len : 15) << 4 | (ml < 15 ? ml : 15));
+    if (lit_len >= 15 && !write_length(op, oend, lit_len - 15)) {
+        return false;
+    }
+    if (oend - op < lit_len) {
+        return false;
+    }
+    memcpy(op, anchor, lit_len);
+    op += lit_len;
+    if (match_len == 0) {
+        return true;
+    }
+    if (oend - op < 2) {
+        return false;
+    }
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    return ml < 15 || write_length(op, oend, ml - 15);
+}
+
+int lz4_compress(const char *src, int src_len, char *dst, int dst_cap) {
+    const auto *base = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *ip = base;
+    const uint8_t *anchor = base;
+    const uint8_t *iend = base + src_len;
+    auto *op = reinterpret_cast<uint8_t *>(dst);
+    const uint8_t *oend = op + dst_cap;
+
+    if (src_len > LZ4_MF_LIMIT) {
+        const uint8_t *mflimit = iend - LZ4_MF_LIMIT;
+        const uint8_t *matchlimit = iend - LZ4_LAST_LITERALS;
+        uint16_t table[1 << LZ4_HASH_BITS] = {};    // 哈希值 -> 最近一次出现的位置
+        while (ip < mflimit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = lz4_hash(seq);
+            const uint8_t *ref = base + table[h];
+            table[h] = static_cast<uint16_t>(ip - base);
+            if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || read32(ref) != seq) {
+                ip++;
+                continue;
+            }
+            // 向前扩展到上一个序列结束处，再向后扩展到不相等或matchlimit为止
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const uint8_t *mp = ip + LZ4_MIN_MATCH;
+            const uint8_t *rp = ref + LZ4_MIN_MATCH;
+            while (mp < matchlimit && *mp == *rp) {
+                mp++;
+                rp++;
+            }
+            if (!write_sequence(op, oend, anchor, static_cast<int>(ip - anchor), static_cast<int>(ip - ref),
+                                static_cast<int>(mp - ip))) {
+                return -1;
+            }
+            ip = mp;
+            anchor = ip;
+        }
+    }
+    if (!write_sequence(op, oend, anchor, static_cast<int>(iend - anchor), 0, 0)) {
+        return -1;
+    }
+    return static_cast<int>(op - reinterpret_cast<uint8_t *>(dst));
+}
+
+/**
+ * @description: 读出超过15的长度的剩余部分，加到len上
+ */
+static bool read_length(const uint8_t *&ip, const uint8_t *iend, int &len) {
+    uint8_t b;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool lz4_decompress(const char *src, int src_len, char *dst, int dst_len) {
+    const auto *ip = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *iend = ip + src_len;
+    auto *op = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *const ostart = op;
+    const uint8_t *oend = op + dst_len;
+    while (true) {
+        if (ip >= iend) {
+            return false;
+        }
+        uint8_t token = *ip++;
+        int lit_len = token >> 4;
+        if (lit_len == 15 && !read_length(ip, iend, lit_len)) {
+            return false;
+        }
+        if (iend - ip < lit_len || oend - op < lit_len) {
+            return false;
+        }
+        memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+        if (ip == iend) {
+            break;  // 最后一个序列只有字面量
+        }
+        if (iend - ip < 2) {
+            return false;
+        }
+        int offset = ip[0] | ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op - ostart) {
+            return false;
+        }
+        int match_len = token & 15;
+        if (match_len == 15 && !read_length(ip, iend, match_len)) {
+            return false;
+        }
+        match_len += LZ4_MIN_MATCH;
+        if (oend - op < match_len) {
+            return false;
+        }
+        // 匹配可能与输出重叠(offset < match_len)，逐字节复制
+        const uint8_t *ref = op - offset;
+        for (int i = 0; i < match_len; i++) {
+            op[i] = ref[i];
+        }
+        op += match_len;
+    }
+    return op == oend;
+}
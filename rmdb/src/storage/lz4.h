@@ -0,0 +1,36 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+/**
+ * LZ4块格式(LZ4 block format)的压缩与解压，用于页面压缩，输出可以被标准的LZ4_decompress_safe解压。
+ * 压缩使用单个哈希表的贪心匹配，输入不超过64KB
+ */
+
+/**
+ * @description: 压缩src中的src_len字节
+ * @param {char*} src 输入，不超过64KB
+ * @param {int} src_len 输入长度
+ * @param {char*} dst 输出
+ * @param {int} dst_cap 输出的容量
+ * @return {int} 压缩后的长度，超过dst_cap时返回-1
+ */
+int lz4_compress(const char *src, int src_len, char *dst, int dst_cap);
+
+/**
+ * @description: 解压lz4_compress()的输出，输入损坏时不会越界读写
+ * @param {char*} src 压缩后的数据
+ * @param {int} src_len 压缩后的长度
+ * @param {char*} dst 输出
+ * @param {int} dst_len 解压后的长度必须恰好为dst_len
+ * @return {bool} 解压是否成功
+ */
+bool lz4_decompress(const char *src, int src_len, char *dst, int dst_len);
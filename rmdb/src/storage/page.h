@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -47,13 +50,14 @@ struct std::hash<PageId> {
 /**
  * @description: Page类声明, Page是RMDB数据块的单位、是负责数据操作Record模块的操作对象，
  * Page对象在磁盘上有文件存储, 若在Buffer中则有帧偏移, 并非特指Buffer或Disk上的数据
+ * Page对象只保存帧的元数据，页面数据位于BufferPoolManager按PAGE_SIZE对齐分配的数据区中，由data_指向
  */
 class Page {
     friend class BufferPoolManager;
 
    public:
     
-    Page() { reset_memory(); }
+    Page() = default;
 
     ~Page() = default;
 
@@ -66,11 +70,27 @@ class Page {
     static constexpr size_t OFFSET_PAGE_START = 0;
     static constexpr size_t OFFSET_LSN = 0;
     static constexpr size_t OFFSET_PAGE_HDR = 4;
+    // 页尾4字节是DiskManager写出时填入的CRC32C校验和，上层的页面格式只使用[0, OFFSET_CHECKSUM)
+    static constexpr size_t OFFSET_CHECKSUM = PAGE_SIZE - sizeof(uint32_t);
 
     inline lsn_t get_page_lsn() { return *reinterpret_cast<lsn_t *>(get_data() + OFFSET_LSN) ; }
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /** 页面内容的读写锁，只能在pin住页面期间持有，unpin之前必须释放 */
+    void rlatch() { rwlatch_.lock_shared(); }
+
+    void runlatch() { rwlatch_.unlock_shared(); }
+
+    void wlatch() { rwlatch_.lock(); }
+
+    void wunlatch() { rwlatch_.unlock(); }
+
+    /** 不等待地尝试加锁，用于违反加锁顺序的场合(如B+树中持有右结点时获取左兄弟的锁) */
+    bool try_rlatch() { return rwlatch_.try_lock_shared(); }
+
+    bool try_wlatch() { return rwlatch_.try_lock(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
@@ -78,13 +98,28 @@ class Page {
     PageId id_;
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool数据区中的地址，按PAGE_SIZE对齐，由BufferPoolManager设置
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
 
     /** 脏页判断 */
     bool is_dirty_ = false;
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** The pin count of this page.
+     *  乐观读路径不持有分区锁直接增减，因此是原子变量；帧被淘汰、删除或回收前需通过BufferPoolManager::claim_frame
+     *  将其从0原子地改为1，改为1失败说明有线程刚刚pin住了该帧 */
+    std::atomic<int> pin_count_{0};
+
+    /** 该帧正在进行磁盘读写(换出脏页或读入新页)，此时data_不可用，访问者需在分区的io_cv_上等待 */
+    std::atomic<bool> io_in_progress_{false};
+
+    /** 帧的版本号，id_改变期间为奇数。乐观读在pin前后各读一次，不一致说明帧在此期间被换成了别的页面 */
+    std::atomic<uint64_t> version_{0};
+
+    /** 帧是否在置换器中，与置换器的状态在分区锁内同步修改；乐观unpin只在帧仍在置换器中时才能不加锁把pin_count_减到0 */
+    std::atomic<bool> in_replacer_{false};
+
+    /** 保护data_中页面内容的读写锁，由上层(如B+树的latch crabbing)按需使用；与分区锁、pin计数相互独立，
+     *  缓冲池只管理帧的换入换出，不会获取该锁 */
+    std::shared_mutex rwlatch_;
 };
\ No newline at end of file
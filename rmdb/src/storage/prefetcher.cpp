@@ -0,0 +1,65 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/prefetcher.h"
+
+Prefetcher::Prefetcher(size_t num_threads, size_t max_pending) : num_threads_(num_threads), max_pending_(max_pending) {}
+
+/**
+ * @description: 等待队列中已提交的任务全部执行完再退出后台线程
+ */
+Prefetcher::~Prefetcher() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &thread : workers_) {
+        thread.join();
+    }
+}
+
+/**
+ * @description: 提交一个I/O任务
+ * @return {bool} 任务进入队列返回true，队列已满返回false
+ * @param {function<void()>} task 要异步执行的任务，任务自己负责处理异常
+ */
+bool Prefetcher::submit(std::function<void()> task) {
+    {
+        std::scoped_lock lock{latch_};
+        if (tasks_.size() >= max_pending_) {
+            return false;
+        }
+        if (workers_.empty()) {
+            for (size_t i = 0; i < num_threads_; i++) {
+                workers_.emplace_back(&Prefetcher::worker, this);
+            }
+        }
+        tasks_.emplace_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void Prefetcher::worker() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{latch_};
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
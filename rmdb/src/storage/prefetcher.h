@@ -0,0 +1,44 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @description: 预读I/O线程池。
+ * BufferPoolManager把预读页面的磁盘读写封装成任务提交到这里，由后台线程异步执行，
+ * 调用者(扫描线程)无需等待磁盘I/O即可继续处理已经在缓冲池中的页面。
+ * 线程在第一次提交任务时才创建；任务队列有上限，队列满时submit返回false，由调用者自行处理。
+ */
+class Prefetcher {
+   public:
+    Prefetcher(size_t num_threads, size_t max_pending);
+
+    ~Prefetcher();
+
+    bool submit(std::function<void()> task);
+
+   private:
+    void worker();
+
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;   // 等待执行的I/O任务
+    std::vector<std::thread> workers_;
+    size_t num_threads_;
+    size_t max_pending_;                        // 队列中最多等待的任务数
+    bool stop_ = false;
+};
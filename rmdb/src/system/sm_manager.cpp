@@ -13,7 +13,11 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <mutex>
+#include <thread>  // NOLINT
 
 #include "index/ix.h"
 #include "record/rm.h"
@@ -141,20 +145,106 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
     printer.print_separator(context);
     // Print fields
     for (auto &col : tab.cols) {
-        std::vector<std::string> field_info = {col.name, coltype2str(col.type), col.index ? "YES" : "NO"};
+        std::string type = col.varlen ? "VARCHAR" : coltype2str(col.type);
+        std::vector<std::string> field_info = {col.name, type, col.index ? "YES" : "NO"};
         printer.print_record(field_info, context);
     }
     // Print footer
     printer.print_separator(context);
 }
 
+/**
+ * @description: 检查表的数据文件、FSM文件和索引文件中每个页面的校验和，多个线程并行地直接从磁盘读取页面，
+ *              输出每个文件的页面数和校验和错误的页面
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ */
+void SmManager::verify_table(const std::string& tab_name, Context* context) {
+    TabMeta &tab = db_.get_table(tab_name);
+    std::vector<std::string> files = {tab_name, tab_name + RM_FSM_SUFFIX};
+    for (auto &index : tab.indexes) {
+        files.push_back(ix_manager_->get_index_name(tab_name, index.cols));
+    }
+
+    // 先写出缓冲池中的脏页，检查的是磁盘上的最新内容；每个文件按VERIFY_CHUNK_PAGES个页面切分成任务
+    constexpr int VERIFY_CHUNK_PAGES = 256;
+    struct Chunk {
+        size_t file;
+        page_id_t begin;
+        page_id_t end;
+    };
+    std::vector<int> fds;
+    std::vector<int> num_pages;
+    std::vector<Chunk> chunks;
+    for (size_t i = 0; i < files.size(); i++) {
+        int fd = disk_manager_->get_file_fd(files[i]);
+        buffer_pool_manager_->flush_all_pages(fd);
+        fds.push_back(fd);
+        num_pages.push_back(disk_manager_->get_file_size(files[i]) / PAGE_SIZE);
+        for (page_id_t begin = 0; begin < num_pages.back(); begin += VERIFY_CHUNK_PAGES) {
+            chunks.push_back({i, begin, std::min(begin + VERIFY_CHUNK_PAGES, num_pages.back())});
+        }
+    }
+
+    std::vector<std::vector<page_id_t>> corrupt(files.size());
+    std::mutex corrupt_latch;
+    std::atomic<size_t> next_chunk{0};
+    size_t num_threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), chunks.size());
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < num_threads; t++) {
+        workers.emplace_back([&]() {
+            for (size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+                auto &chunk = chunks[c];
+                for (page_id_t page_no = chunk.begin; page_no < chunk.end; page_no++) {
+                    if (!disk_manager_->verify_page(fds[chunk.file], page_no)) {
+                        std::scoped_lock lock{corrupt_latch};
+                        corrupt[chunk.file].push_back(page_no);
+                    }
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    RecordPrinter printer(3);
+    printer.print_separator(context);
+    printer.print_record({"File", "Pages", "Corrupt"}, context);
+    printer.print_separator(context);
+    for (size_t i = 0; i < files.size(); i++) {
+        printer.print_record({files[i], std::to_string(num_pages[i]), std::to_string(corrupt[i].size())}, context);
+    }
+    printer.print_separator(context);
+    // 列出校验和错误的页面
+    RecordPrinter page_printer(2);
+    bool has_corrupt = false;
+    for (size_t i = 0; i < files.size(); i++) {
+        std::sort(corrupt[i].begin(), corrupt[i].end());
+        for (page_id_t page_no : corrupt[i]) {
+            if (!has_corrupt) {
+                page_printer.print_separator(context);
+                page_printer.print_record({"File", "Corrupt page"}, context);
+                page_printer.print_separator(context);
+                has_corrupt = true;
+            }
+            page_printer.print_record({files[i], std::to_string(page_no)}, context);
+        }
+    }
+    if (has_corrupt) {
+        page_printer.print_separator(context);
+    }
+}
+
 /**
  * @description: 创建表
  * @param {string&} tab_name 表的名称
  * @param {vector<ColDef>&} col_defs 表的字段
  * @param {Context*} context 
+ * @param {bool} pax 是否使用PAX页面格式，同一页面中每个字段的值连续存放
  */
-void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context) {
+void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                             bool pax) {
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
@@ -162,19 +252,32 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
     int curr_offset = 0;
     TabMeta tab;
     tab.name = tab_name;
+    std::vector<RmColPos> var_cols;     // 有VARCHAR字段的表使用slotted页面
+    std::vector<RmColPos> pax_cols;
+    std::vector<RmZoneCol> zone_cols;   // 数值字段维护zone map，最多RM_MAX_ZONE_COLS个
     for (auto &col_def : col_defs) {
         ColMeta col = {.tab_name = tab_name,
                        .name = col_def.name,
                        .type = col_def.type,
                        .len = col_def.len,
                        .offset = curr_offset,
-                       .index = false};
+                       .index = false,
+                       .varlen = col_def.varlen};
+        if (col.varlen) {
+            var_cols.push_back(RmColPos{col.offset, col.len});
+        }
+        if (pax) {
+            pax_cols.push_back(RmColPos{col.offset, col.len});
+        }
+        if ((col.type == TYPE_INT || col.type == TYPE_FLOAT) && zone_cols.size() < RM_MAX_ZONE_COLS) {
+            zone_cols.push_back(RmZoneCol{col.offset, col.type});
+        }
         curr_offset += col_def.len;
         tab.cols.push_back(col);
     }
     // Create & open record file
     int record_size = curr_offset;  // record_size就是col meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    rm_manager_->create_file(tab_name, record_size, var_cols, pax_cols, zone_cols);
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
@@ -192,13 +295,55 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
 }
 
 /**
- * @description: 创建索引
+ * @description: 创建索引。表中已有的记录不逐条插入，而是扫描一遍表后由IxBulkLoader排序并自底向上地构建B+树
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {bool} blink 是否创建B-link树索引
+ * @param {bool} compress 是否压缩索引结点中的key
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
-    
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             bool blink, bool compress) {
+    TabMeta &tab = db_.get_table(tab_name);
+    if (tab.is_index(col_names)) {
+        throw IndexExistsError(tab_name, col_names);
+    }
+    IndexMeta index = {.tab_name = tab_name, .col_tot_len = 0, .col_num = static_cast<int>(col_names.size())};
+    for (auto &col_name : col_names) {
+        auto col = tab.get_col(col_name);
+        index.cols.push_back(*col);
+        index.col_tot_len += col->len;
+    }
+    ix_manager_->create_index(tab_name, index.cols, blink, compress);
+
+    std::string ix_name = ix_manager_->get_index_name(tab_name, col_names);
+    int fd = ix_manager_->open_index_file(ix_name);
+    try {
+        IxBulkLoader loader(disk_manager_, fd);
+        std::vector<char> key(index.col_tot_len);
+        for (RmScan scan(fhs_.at(tab_name).get()); !scan.is_end(); scan.next()) {
+            const char *record = scan.record_data();
+            int offset = 0;
+            for (auto &col : index.cols) {
+                memcpy(key.data() + offset, record + col.offset, col.len);
+                offset += col.len;
+            }
+            loader.add(key.data(), scan.rid());
+        }
+        loader.finish();
+    } catch (...) {
+        disk_manager_->close_file(fd);
+        ix_manager_->destroy_index(tab_name, index.cols);
+        throw;
+    }
+    disk_manager_->close_file(fd);
+
+    ihs_.emplace(ix_name, ix_manager_->open_index(tab_name, index.cols));
+    for (auto &col_name : col_names) {
+        tab.get_col(col_name)->index = true;
+    }
+    tab.indexes.push_back(index);
+    flush_meta();
 }
 
 /**
@@ -22,6 +22,7 @@ struct ColDef {
     std::string name;  // Column name
     ColType type;      // Type of column
     int len;           // Length of column
+    bool varlen = false;    // VARCHAR(len)，存储时去掉补齐
 };
 
 /* 系统管理器，负责元数据管理和DDL语句的执行 */
@@ -68,11 +69,15 @@ class SmManager {
 
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void verify_table(const std::string& tab_name, Context* context);
+
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                      bool pax = false);
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      bool blink = false, bool compress = false);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
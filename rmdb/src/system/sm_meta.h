@@ -19,6 +19,18 @@ See the Mulan PSL v2 for more details. */
 #include "errors.h"
 #include "sm_defs.h"
 
+/* db.meta的格式版本。旧格式的db.meta没有版本行，ColMeta没有varlen */
+constexpr int DB_META_VERSION_BASELINE = 1;
+constexpr int DB_META_VERSION_VARLEN = 2;   // ColMeta末尾带有varlen
+constexpr int DB_META_VERSION = DB_META_VERSION_VARLEN;
+const std::string DB_META_VERSION_TAG = "#version";     // 版本行：#version <版本号>，写在数据库名称之前
+
+/* 流中正在读取的db.meta的格式版本，由DbMeta的operator>>记录；不经过DbMeta单独读取元数据时为当前版本 */
+inline long &db_meta_version(std::ios_base &ios) {
+    static const int index = std::ios_base::xalloc();
+    return ios.iword(index);
+}
+
 /* 字段元数据 */
 struct ColMeta {
     std::string tab_name;   // 字段所属表名称
@@ -27,15 +39,22 @@ struct ColMeta {
     int len;                // 字段长度
     int offset;             // 字段位于记录中的偏移量
     bool index;             /** unused */
+    bool varlen = false;    // VARCHAR字段：在记录中仍占len字节，写入页面时去掉末尾的补齐
 
     friend std::ostream &operator<<(std::ostream &os, const ColMeta &col) {
         // ColMeta中有各个基本类型的变量，然后调用重载的这些变量的操作符<<（具体实现逻辑在defs.h）
         return os << col.tab_name << ' ' << col.name << ' ' << col.type << ' ' << col.len << ' ' << col.offset << ' '
-                  << col.index;
+                  << col.index << ' ' << col.varlen;
     }
 
     friend std::istream &operator>>(std::istream &is, ColMeta &col) {
-        return is >> col.tab_name >> col.name >> col.type >> col.len >> col.offset >> col.index;
+        is >> col.tab_name >> col.name >> col.type >> col.len >> col.offset >> col.index;
+        long version = db_meta_version(is);
+        col.varlen = false;
+        if (version == 0 || version >= DB_META_VERSION_VARLEN) {
+            is >> col.varlen;
+        }
+        return is;
     }
 };
 
@@ -185,6 +204,7 @@ class DbMeta {
 
     // 重载操作符 <<
     friend std::ostream &operator<<(std::ostream &os, const DbMeta &db_meta) {
+        os << DB_META_VERSION_TAG << ' ' << DB_META_VERSION << '\n';
         os << db_meta.name_ << '\n' << db_meta.tabs_.size() << '\n';
         for (auto &entry : db_meta.tabs_) {
             os << entry.second << '\n';
@@ -193,13 +213,25 @@ class DbMeta {
     }
 
     friend std::istream &operator>>(std::istream &is, DbMeta &db_meta) {
+        // 没有版本行的是旧格式，第一个词就是数据库名称
+        long version = DB_META_VERSION_BASELINE;
+        is >> db_meta.name_;
+        if (db_meta.name_ == DB_META_VERSION_TAG) {
+            is >> version >> db_meta.name_;
+            if (version < DB_META_VERSION_BASELINE || version > DB_META_VERSION) {
+                throw InternalError("DbMeta: unsupported db.meta version " + std::to_string(version));
+            }
+        }
+        long prev_version = db_meta_version(is);
+        db_meta_version(is) = version;
         size_t n;
-        is >> db_meta.name_ >> n;
+        is >> n;
         for (size_t i = 0; i < n; i++) {
             TabMeta tab;
             is >> tab;
             db_meta.tabs_[tab.name] = tab;
         }
+        db_meta_version(is) = prev_version;
         return is;
     }
 };
@@ -0,0 +1,99 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 记录页面位图的查找性能。
+ * 按不同的记录大小(决定每页的slot数)和填充率生成一批页面位图，分别测试：
+ *   scan:   用next_bit遍历页面中所有记录(RmScan的访问方式)，对比逐位、逐字、AVX2、按情况选择二者的next_bit
+ *           和一次取出所有记录的get_set_bits
+ *   insert: 用first_bit(false, ...)查找第一个空闲slot(insert_record的访问方式)
+ * 结果为每个页面的平均耗时(ns)。
+ * 用法: ./bitmap_bench [num_pages] [rounds]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "record/bitmap.h"
+#include "record/rm_defs.h"
+
+using NextBitFn = int (*)(bool, const char *, int, int);
+
+static volatile int sink;
+
+// 与RmManager::create_file相同的每页slot数的计算方式
+static int records_per_page(int record_size) {
+    return (BITMAP_WIDTH * (PAGE_SIZE - 1 - static_cast<int>(sizeof(RmFileHdr))) + 1) / (1 + record_size * BITMAP_WIDTH);
+}
+
+template <typename F>
+static double time_per_page(const std::vector<std::vector<char>> &bitmaps, int rounds, F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (auto &bm : bitmaps) {
+            fn(bm.data());
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(rounds) * bitmaps.size());
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 1024;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    std::vector<std::pair<const char *, NextBitFn>> impls = {{"bitwise", Bitmap::next_bit_bitwise},
+                                                             {"word", Bitmap::next_bit_word}};
+#ifdef RMDB_BITMAP_AVX2
+    if (Bitmap::has_avx2()) {
+        impls.push_back({"avx2", Bitmap::next_bit_avx2});
+    }
+#endif
+    impls.push_back({"next_bit", Bitmap::next_bit});
+
+    printf("%-8s%-8s%-8s%-10s%14s%14s\n", "recsize", "slots", "fill%", "impl", "scan ns/pg", "insert ns/pg");
+    std::mt19937 rng(0);
+    for (int record_size : {1, 8, 64, 256}) {
+        int max_n = records_per_page(record_size);
+        int size = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        std::vector<int> positions(max_n);
+        for (int fill : {1, 10, 50, 90, 99, 100}) {
+            std::vector<std::vector<char>> bitmaps(num_pages, std::vector<char>(size, 0));
+            for (auto &bm : bitmaps) {
+                for (int i = 0; i < max_n; i++) {
+                    if (static_cast<int>(rng() % 100) < fill) {
+                        Bitmap::set(bm.data(), i);
+                    }
+                }
+            }
+            for (auto &[name, next_bit] : impls) {
+                double scan = time_per_page(bitmaps, rounds, [&, next_bit = next_bit](const char *bm) {
+                    int n = 0;
+                    for (int i = next_bit(true, bm, max_n, -1); i < max_n; i = next_bit(true, bm, max_n, i)) {
+                        n++;
+                    }
+                    sink = n;
+                });
+                double insert = time_per_page(bitmaps, rounds, [&, next_bit = next_bit](const char *bm) {
+                    sink = next_bit(false, bm, max_n, -1);
+                });
+                printf("%-8d%-8d%-8d%-10s%14.0f%14.0f\n", record_size, max_n, fill, name, scan, insert);
+            }
+            double bulk = time_per_page(bitmaps, rounds, [&](const char *bm) {
+                sink = Bitmap::get_set_bits(bm, max_n, positions.data());
+            });
+            printf("%-8d%-8d%-8d%-10s%14.0f%14s\n", record_size, max_n, fill, "bulk", bulk, "-");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * BufferPoolManager多线程fetch_page/unpin_page吞吐测试。
+ * 所有页面预先载入缓冲池(全部命中)，因此测得的是页表查找与锁竞争的开销。
+ * 用法: ./buffer_pool_bench [num_pages] [ops_per_thread]
+ * 对分区数{1, BUFFER_POOL_PARTITIONS}分别测试1~32个线程的吞吐，并对比加锁路径(optimistic=off)
+ * 与不加分区锁的乐观读路径(optimistic=on)。
+ */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string BENCH_DB_NAME = "BufferPoolBench_db";
+const std::string BENCH_FILE_NAME = "bench";
+
+static double run_bench(BufferPoolManager *bpm, int fd, int num_pages, int num_threads, int ops_per_thread) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([=]() {
+            std::mt19937 rng(tid);
+            std::uniform_int_distribution<int> dist(0, num_pages - 1);
+            for (int i = 0; i < ops_per_thread; i++) {
+                PageId page_id = {.fd = fd, .page_no = dist(rng)};
+                Page *page = bpm->fetch_page(page_id);
+                if (page == nullptr) {
+                    fprintf(stderr, "fetch_page failed: %s\n", page_id.toString().c_str());
+                    abort();
+                }
+                bpm->unpin_page(page_id, false);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_threads) * ops_per_thread / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 4096;
+    int ops_per_thread = argc > 2 ? atoi(argv[2]) : 200000;
+
+    DiskManager disk_manager;
+    if (!disk_manager.is_dir(BENCH_DB_NAME)) {
+        disk_manager.create_dir(BENCH_DB_NAME);
+    }
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+    if (disk_manager.is_file(BENCH_FILE_NAME)) {
+        disk_manager.destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager.create_file(BENCH_FILE_NAME);
+    int fd = disk_manager.open_file(BENCH_FILE_NAME);
+
+    // 先写出num_pages个页面
+    {
+        BufferPoolManager bpm(num_pages, &disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            bpm.new_page(&page_id);
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+    }
+
+    printf("%-12s%-12s%-10s%16s\n", "partitions", "optimistic", "threads", "ops/sec");
+    for (size_t num_partitions : {static_cast<size_t>(1), static_cast<size_t>(BUFFER_POOL_PARTITIONS)}) {
+        for (bool optimistic : {false, true}) {
+            // 每个分区多留一些帧，保证哈希不均匀时所有页面仍能全部常驻
+            BufferPoolManager bpm(num_pages * 2, &disk_manager, num_partitions);
+            bpm.set_optimistic_reads(optimistic);
+            run_bench(&bpm, fd, num_pages, 1, num_pages);  // 预热，将所有页面读入缓冲池
+            for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+                double ops = run_bench(&bpm, fd, num_pages, num_threads, ops_per_thread);
+                printf("%-12zu%-12s%-10d%16.0f\n", num_partitions, optimistic ? "on" : "off", num_threads, ops);
+            }
+        }
+    }
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 在num_keys个乱序的键值对上创建索引的耗时：逐条insert_entry对比IxBulkLoader批量构建(内存排序和外部排序)。
+ * 两种key：单个INT字段，以及类似TPC-C customer表(c_w_id, c_d_id, c_last)的INT, INT, CHAR(16)组合key。
+ * 耗时包括把索引写到磁盘上，同时输出索引文件的页面数。
+ * 用法: ./ix_bulk_load_bench [num_keys]
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "index/ix.h"
+
+const std::string BENCH_DB_NAME = "IxBulkLoadBench_db";
+const std::string BENCH_TABLE_NAME = "bench";
+
+// 第i个key：INT key即i；组合key为(i / 30000, i / 3000 % 10, 以i结尾的姓)，与i的顺序一致
+static void make_key(int i, bool composite, char *key) {
+    if (!composite) {
+        memcpy(key, &i, sizeof(int));
+        return;
+    }
+    int w_id = i / 30000, d_id = i / 3000 % 10;
+    memcpy(key, &w_id, sizeof(int));
+    memcpy(key + sizeof(int), &d_id, sizeof(int));
+    memset(key + 2 * sizeof(int), ' ', 16);
+    snprintf(key + 2 * sizeof(int), 16, "BARBAR%08d", i);
+}
+
+int main(int argc, char **argv) {
+    int num_keys = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    DiskManager disk_manager;
+    if (!disk_manager.is_dir(BENCH_DB_NAME)) {
+        disk_manager.create_dir(BENCH_DB_NAME);
+    }
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+    BufferPoolManager bpm(BUFFER_POOL_SIZE, &disk_manager, BUFFER_POOL_PARTITIONS);
+    IxManager ix_manager(&disk_manager, &bpm);
+
+    std::vector<int> order(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(2023));
+
+    printf("%-12s%-16s%12s%12s\n", "key", "method", "seconds", "pages");
+    for (bool composite : {false, true}) {
+        std::vector<ColMeta> index_cols = {{.tab_name = BENCH_TABLE_NAME, .name = "k", .type = TYPE_INT, .len = 4,
+                                            .offset = 0, .index = true}};
+        if (composite) {
+            index_cols.push_back({.tab_name = BENCH_TABLE_NAME, .name = "d", .type = TYPE_INT, .len = 4,
+                                  .offset = 4, .index = true});
+            index_cols.push_back({.tab_name = BENCH_TABLE_NAME, .name = "last", .type = TYPE_STRING, .len = 16,
+                                  .offset = 8, .index = true});
+        }
+        std::string ix_name = ix_manager.get_index_name(BENCH_TABLE_NAME, index_cols);
+        std::vector<char> key(composite ? 24 : 4);
+        // method 0: insert_entry，1: 内存中排序，2: 每个run只有1MB的外部排序
+        for (int method = 0; method < 3; method++) {
+            if (disk_manager.is_file(ix_name)) {
+                ix_manager.destroy_index(BENCH_TABLE_NAME, index_cols);
+            }
+            ix_manager.create_index(BENCH_TABLE_NAME, index_cols);
+            auto start = std::chrono::steady_clock::now();
+            if (method == 0) {
+                auto ih = ix_manager.open_index(BENCH_TABLE_NAME, index_cols);
+                for (int i : order) {
+                    make_key(i, composite, key.data());
+                    ih->insert_entry(key.data(), Rid{i, 0}, nullptr);
+                }
+                ix_manager.close_index(ih.get());
+            } else {
+                int fd = ix_manager.open_index_file(ix_name);
+                IxBulkLoader loader(&disk_manager, fd, IX_BULK_LOAD_FILL_FACTOR,
+                                    method == 1 ? IX_BULK_LOAD_SORT_MEM : 1 << 20);
+                for (int i : order) {
+                    make_key(i, composite, key.data());
+                    loader.add(key.data(), Rid{i, 0});
+                }
+                loader.finish();
+                disk_manager.close_file(fd);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const char *method_name = method == 0 ? "insert_entry" : (method == 1 ? "bulk" : "bulk_external");
+            printf("%-12s%-16s%12.3f%12d\n", composite ? "composite" : "int", method_name, elapsed.count(),
+                   disk_manager.get_file_size(ix_name) / PAGE_SIZE);
+        }
+        ix_manager.destroy_index(BENCH_TABLE_NAME, index_cols);
+    }
+
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    return 0;
+}
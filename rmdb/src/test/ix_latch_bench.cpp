@@ -0,0 +1,124 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * B+树多线程吞吐测试。预先插入num_keys个INT key，然后测试两种负载：
+ *   random: 每个线程随机执行查找、插入和删除(默认比例8:1:1)
+ *   append: 所有线程插入递增的key，每次插入都落在最右的叶结点上
+ * 对比所有操作串行执行(外加一把全局锁，即没有结点latch时只能采用的方式)、latch crabbing和B-link树的吞吐。
+ * 用法: ./ix_latch_bench [num_keys] [ops_per_thread] [write_percent]
+ * write_percent为random负载中插入和删除各自所占的百分比
+ */
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "index/ix.h"
+
+const std::string BENCH_DB_NAME = "IxLatchBench_db";
+const std::string BENCH_TABLE_NAME = "bench";
+
+static double run_bench(IxIndexHandle *ih, int num_keys, int num_threads, int ops_per_thread, int write_percent,
+                        bool global_latch, std::atomic<int> *next_key) {
+    std::mutex global_mutex;
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([=, &global_mutex]() {
+            std::mt19937 rng(tid);
+            std::uniform_int_distribution<int> key_dist(0, num_keys * 2 - 1);
+            std::uniform_int_distribution<int> op_dist(0, 99);
+            std::vector<Rid> result;
+            for (int i = 0; i < ops_per_thread; i++) {
+                bool append = next_key != nullptr;
+                int key = append ? (*next_key)++ : key_dist(rng);
+                int op = op_dist(rng);
+                std::unique_lock<std::mutex> lock(global_mutex, std::defer_lock);
+                if (global_latch) {
+                    lock.lock();
+                }
+                if (append || op < write_percent) {
+                    ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, nullptr);
+                } else if (op < write_percent * 2) {
+                    ih->delete_entry(reinterpret_cast<const char *>(&key), nullptr);
+                } else {
+                    result.clear();
+                    ih->get_value(reinterpret_cast<const char *>(&key), &result, nullptr);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_threads) * ops_per_thread / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+    int num_keys = argc > 1 ? atoi(argv[1]) : 200000;
+    int ops_per_thread = argc > 2 ? atoi(argv[2]) : 100000;
+    int write_percent = argc > 3 ? atoi(argv[3]) : 10;
+
+    DiskManager disk_manager;
+    if (!disk_manager.is_dir(BENCH_DB_NAME)) {
+        disk_manager.create_dir(BENCH_DB_NAME);
+    }
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+    BufferPoolManager bpm(BUFFER_POOL_SIZE, &disk_manager, BUFFER_POOL_PARTITIONS);
+    IxManager ix_manager(&disk_manager, &bpm);
+    std::vector<ColMeta> index_cols = {{.tab_name = BENCH_TABLE_NAME, .name = "k", .type = TYPE_INT, .len = 4,
+                                        .offset = 0, .index = true}};
+
+    printf("%-10s%-14s%-10s%16s\n", "workload", "latch", "threads", "ops/sec");
+    for (bool append : {false, true}) {
+        for (int mode = 0; mode < 3; mode++) {
+            bool global_latch = mode == 0;
+            bool blink = mode == 2;
+            if (disk_manager.is_file(ix_manager.get_index_name(BENCH_TABLE_NAME, index_cols))) {
+                ix_manager.destroy_index(BENCH_TABLE_NAME, index_cols);
+            }
+            ix_manager.create_index(BENCH_TABLE_NAME, index_cols, blink);
+            auto ih = ix_manager.open_index(BENCH_TABLE_NAME, index_cols);
+            // 插入偶数key，random负载中的查找约一半命中
+            for (int i = 0; i < num_keys; i++) {
+                int key = i * 2;
+                ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{key, 0}, nullptr);
+            }
+            std::atomic<int> next_key{num_keys * 2};
+            std::atomic<int> *append_key = append ? &next_key : nullptr;
+            run_bench(ih.get(), num_keys, 1, ops_per_thread, write_percent, global_latch, append_key);  // 预热
+            for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+                double ops = run_bench(ih.get(), num_keys, num_threads, ops_per_thread, write_percent, global_latch,
+                                       append_key);
+                printf("%-10s%-14s%-10d%16.0f\n", append ? "append" : "random",
+                       global_latch ? "global" : (blink ? "blink" : "crabbing"), num_threads, ops);
+            }
+            ix_manager.close_index(ih.get());
+            ix_manager.destroy_index(BENCH_TABLE_NAME, index_cols);
+        }
+    }
+
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    return 0;
+}
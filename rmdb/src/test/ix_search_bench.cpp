@@ -0,0 +1,117 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+/**
+ * B+树结点内key查找的耗时。对几种key格式，在一个装满的结点大小的有序key数组中随机查找，对比
+ * 逐字段调用ix_compare()的二分查找(baseline)与按key格式选定比较器的IxKeySearch(单个INT/FLOAT字段含AVX2)。
+ * 用法: ./ix_search_bench [num_searches]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "index/ix_index_handle.h"
+
+struct Schema {
+    std::string name;
+    std::vector<ColType> types;
+    std::vector<int> lens;
+};
+
+static void run_bench(const Schema &schema, int num_searches) {
+    IxFileHdr file_hdr;
+    file_hdr.col_num_ = static_cast<int>(schema.types.size());
+    file_hdr.col_types_ = schema.types;
+    file_hdr.col_lens_ = schema.lens;
+    file_hdr.col_tot_len_ = 0;
+    for (int len : schema.lens) {
+        file_hdr.col_tot_len_ += len;
+    }
+    int key_len = file_hdr.col_tot_len_;
+    int n = static_cast<int>((Page::OFFSET_CHECKSUM - sizeof(IxPageHdr)) / (key_len + sizeof(Rid)) - 1);
+
+    // 结点中的key为0, 2, 4, ...，查找的目标随机
+    std::mt19937 rng(0);
+    auto make_key = [&](char *key, int v) {
+        int offset = 0;
+        for (size_t i = 0; i < schema.types.size(); i++) {
+            // 多字段时前面的字段取相同的值，比较要一直进行到最后一个字段
+            int fv = i + 1 == schema.types.size() ? v : 1;
+            if (schema.types[i] == TYPE_INT) {
+                memcpy(key + offset, &fv, sizeof(int));
+            } else if (schema.types[i] == TYPE_FLOAT) {
+                float f = static_cast<float>(fv);
+                memcpy(key + offset, &f, sizeof(float));
+            } else {
+                snprintf(key + offset, schema.lens[i], "%0*d", schema.lens[i] - 1, fv);
+            }
+            offset += schema.lens[i];
+        }
+    };
+    std::vector<char> keys(static_cast<size_t>(n) * key_len, 0);
+    for (int i = 0; i < n; i++) {
+        make_key(keys.data() + i * key_len, i * 2);
+    }
+    std::vector<std::vector<char>> targets(1024, std::vector<char>(key_len, 0));
+    for (auto &target : targets) {
+        make_key(target.data(), static_cast<int>(rng() % (2 * n)));
+    }
+
+    long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_searches; i++) {
+        const char *target = targets[i % targets.size()].data();
+        int lo = 0, hi = n;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (ix_compare(keys.data() + mid * key_len, target, file_hdr.col_types_, file_hdr.col_lens_) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        sum += lo;
+    }
+    std::chrono::duration<double, std::nano> baseline = std::chrono::steady_clock::now() - start;
+
+    IxKeySearch key_search(file_hdr);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_searches; i++) {
+        sum -= key_search.lower_bound(keys.data(), 0, n, targets[i % targets.size()].data());
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sum != 0) {
+        fprintf(stderr, "results differ for %s\n", schema.name.c_str());
+        abort();
+    }
+    printf("%-16s%8d%16.1f%16.1f%8s\n", schema.name.c_str(), n, baseline.count() / num_searches,
+           elapsed.count() / num_searches, key_search.use_simd() ? "yes" : "no");
+}
+
+int main(int argc, char **argv) {
+    int num_searches = argc > 1 ? atoi(argv[1]) : 2000000;
+    std::vector<Schema> schemas = {
+        {"int", {TYPE_INT}, {4}},
+        {"float", {TYPE_FLOAT}, {4}},
+        {"int,int,int", {TYPE_INT, TYPE_INT, TYPE_INT}, {4, 4, 4}},
+        {"char(16)", {TYPE_STRING}, {16}},
+        {"int,char(16)", {TYPE_INT, TYPE_STRING}, {4, 16}},
+    };
+    printf("%-16s%8s%16s%16s%8s\n", "key", "keys", "baseline(ns)", "search(ns)", "simd");
+    for (auto &schema : schemas) {
+        run_bench(schema, num_searches);
+    }
+    return 0;
+}
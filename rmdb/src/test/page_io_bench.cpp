@@ -0,0 +1,118 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+/**
+ * 页面校验和对DiskManager读写吞吐的影响。
+ * 分别在不使用/使用页面校验和时，批量写出num_pages个页面(write_pages)、批量顺序读回(read_pages)、随机逐页读取(read_page)，
+ * 统计每秒处理的页面数。文件大多留在内核页缓存中，I/O本身很快，测得的是校验和开销的上限。
+ * 另外单独测量计算一个页面的CRC32C的耗时。
+ * 用法: ./page_io_bench [num_pages] [num_random_reads]
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/crc32c.h"
+#include "storage/disk_manager.h"
+
+const std::string BENCH_DB_NAME = "PageIoBench_db";
+const std::string BENCH_FILE_NAME = "bench";
+constexpr int BATCH_PAGES = 64;
+
+template <typename F>
+static double pages_per_sec(int num_pages, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_pages / elapsed.count();
+}
+
+static void run_bench(DiskManager *disk_manager, int num_pages, int num_random_reads, bool checksums) {
+    if (disk_manager->is_file(BENCH_FILE_NAME)) {
+        disk_manager->destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager->create_file(BENCH_FILE_NAME);
+    int fd = disk_manager->open_file(BENCH_FILE_NAME);
+    disk_manager->set_file_checksums(fd, checksums);
+
+    AlignedBuffer data = alloc_aligned_buffer(static_cast<size_t>(BATCH_PAGES) * PAGE_SIZE);
+    std::vector<char *> bufs(BATCH_PAGES);
+    std::mt19937 rng(0);
+    for (int i = 0; i < BATCH_PAGES; i++) {
+        bufs[i] = data.get() + static_cast<size_t>(i) * PAGE_SIZE;
+        for (int j = 0; j < PAGE_SIZE; j++) {
+            bufs[i][j] = static_cast<char>(rng());
+        }
+    }
+
+    double write = pages_per_sec(num_pages, [&]() {
+        for (int i = 0; i < num_pages; i += BATCH_PAGES) {
+            disk_manager->write_pages(fd, i, bufs.data(), std::min(BATCH_PAGES, num_pages - i));
+        }
+    });
+    double seq_read = pages_per_sec(num_pages, [&]() {
+        for (int i = 0; i < num_pages; i += BATCH_PAGES) {
+            disk_manager->read_pages(fd, i, bufs.data(), std::min(BATCH_PAGES, num_pages - i));
+        }
+    });
+    double random_read = pages_per_sec(num_random_reads, [&]() {
+        for (int i = 0; i < num_random_reads; i++) {
+            disk_manager->read_page(fd, static_cast<page_id_t>(rng() % num_pages), bufs[0], PAGE_SIZE);
+        }
+    });
+    printf("%-12s%16.0f%16.0f%16.0f\n", checksums ? "on" : "off", write, seq_read, random_read);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 65536;
+    int num_random_reads = argc > 2 ? atoi(argv[2]) : 200000;
+
+    DiskManager disk_manager;
+    if (!disk_manager.is_dir(BENCH_DB_NAME)) {
+        disk_manager.create_dir(BENCH_DB_NAME);
+    }
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+
+    // 计算一个页面校验和的耗时
+    std::vector<char> page(PAGE_SIZE);
+    std::mt19937 rng(0);
+    for (auto &c : page) {
+        c = static_cast<char>(rng());
+    }
+    const int num_rounds = 1000000;
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_rounds; i++) {
+        sum += DiskManager::page_checksum(page.data(), i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("crc32c (%s): %.1f ns/page (checksum sum %u)\n\n", crc32c_hardware() ? "sse4.2" : "table",
+           elapsed.count() / num_rounds, sum);
+
+    printf("%-12s%16s%16s%16s\n", "checksums", "write(pg/s)", "seq read(pg/s)", "rand read(pg/s)");
+    run_bench(&disk_manager, num_pages, num_random_reads, false);
+    run_bench(&disk_manager, num_pages, num_random_reads, true);
+
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    return 0;
+}
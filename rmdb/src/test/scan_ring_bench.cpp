@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 全表扫描对点查延迟的影响。
+ * 一个线程反复顺序扫描一张大表(页数远大于缓冲池)，主线程同时随机读取一小组热点页面，统计点查延迟。
+ * 分别在扫描不使用/使用buffer ring(BufferAccessStrategy)两种情况下测试。
+ * 用法: ./scan_ring_bench [pool_size] [num_hot_pages] [num_scan_pages] [num_lookups]
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string BENCH_DB_NAME = "ScanRingBench_db";
+const std::string BENCH_FILE_NAME = "bench";
+
+static void run_bench(DiskManager *disk_manager, int fd, int pool_size, int num_hot_pages, int num_scan_pages,
+                      int num_lookups, bool use_ring) {
+    BufferPoolManager bpm(pool_size, disk_manager);
+    // 预热热点页面
+    for (int i = 0; i < num_hot_pages; i++) {
+        bpm.fetch_page({fd, i});
+        bpm.unpin_page({fd, i}, false);
+    }
+
+    std::atomic<bool> stop{false};
+    std::thread scanner([&]() {
+        BufferAccessStrategy strategy;
+        while (!stop) {
+            for (int i = num_hot_pages; i < num_hot_pages + num_scan_pages && !stop; i++) {
+                bpm.fetch_page({fd, i}, use_ring ? &strategy : nullptr);
+                bpm.unpin_page({fd, i}, false);
+            }
+        }
+    });
+
+    std::mt19937 rng(0);
+    std::vector<double> latencies;
+    latencies.reserve(num_lookups);
+    for (int i = 0; i < num_lookups; i++) {
+        PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(rng() % num_hot_pages)};
+        auto start = std::chrono::steady_clock::now();
+        bpm.fetch_page(page_id);
+        bpm.unpin_page(page_id, false);
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        latencies.push_back(elapsed.count());
+    }
+    stop = true;
+    scanner.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    for (double l : latencies) {
+        sum += l;
+    }
+    printf("%-10s%14.2f%14.2f%14.2f\n", use_ring ? "ring" : "shared", sum / latencies.size(),
+           latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+}
+
+int main(int argc, char **argv) {
+    int pool_size = argc > 1 ? atoi(argv[1]) : 1024;
+    int num_hot_pages = argc > 2 ? atoi(argv[2]) : 256;
+    int num_scan_pages = argc > 3 ? atoi(argv[3]) : 8192;
+    int num_lookups = argc > 4 ? atoi(argv[4]) : 200000;
+
+    DiskManager disk_manager;
+    if (!disk_manager.is_dir(BENCH_DB_NAME)) {
+        disk_manager.create_dir(BENCH_DB_NAME);
+    }
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+    if (disk_manager.is_file(BENCH_FILE_NAME)) {
+        disk_manager.destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager.create_file(BENCH_FILE_NAME);
+    int fd = disk_manager.open_file(BENCH_FILE_NAME);
+
+    // 写出热点页面[0, num_hot_pages)和大表页面[num_hot_pages, num_hot_pages + num_scan_pages)
+    char buf[PAGE_SIZE] = {};
+    for (int i = 0; i < num_hot_pages + num_scan_pages; i++) {
+        disk_manager.write_page(fd, disk_manager.allocate_page(fd), buf, PAGE_SIZE);
+    }
+
+    printf("%-10s%14s%14s%14s\n", "scan", "avg(us)", "p50(us)", "p99(us)");
+    run_bench(&disk_manager, fd, pool_size, num_hot_pages, num_scan_pages, num_lookups, false);
+    run_bench(&disk_manager, fd, pool_size, num_hot_pages, num_scan_pages, num_lookups, true);
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    return 0;
+}
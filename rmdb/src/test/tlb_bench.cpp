@@ -0,0 +1,135 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+/**
+ * 缓冲池帧数据区使用大页前后的TLB miss对比。
+ * 模拟索引查找的指针追逐：缓冲池中所有页面常驻，每个页面存放PAGE_SIZE / 4个子页号，
+ * 一次查找从根据键选出的页面开始，逐层读取由键决定的槽位中的子页号并访问该子页面，下一次访存依赖上一次的结果。
+ * 分别在普通页和大页(FrameArena: MAP_HUGETLB或MADV_HUGEPAGE)下测试，统计每次查找的耗时和dTLB读miss
+ * (通过perf_event_open读取硬件计数器，不可用时显示n/a)。
+ * 用法: ./tlb_bench [num_pages] [num_lookups] [depth]
+ */
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string BENCH_DB_NAME = "TlbBench_db";
+const std::string BENCH_FILE_NAME = "bench";
+
+// 打开当前线程的dTLB读miss计数器，失败返回-1
+static int open_dtlb_counter() {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static void run_bench(DiskManager *disk_manager, int fd, int num_pages, int num_lookups, int depth, bool huge_pages) {
+    const int slots = PAGE_SIZE / sizeof(page_id_t);
+    BufferPoolManager bpm(num_pages, disk_manager, 1, REPLACER_TYPE, huge_pages);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+    disk_manager->set_fd2pageno(fd, 0);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm.new_page(&page_id);
+        auto children = reinterpret_cast<page_id_t *>(page->get_data());
+        for (int j = 0; j < slots; j++) {
+            children[j] = page_dist(rng);
+        }
+        bpm.unpin_page(page_id, false);
+    }
+
+    int counter = open_dtlb_counter();
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    auto start = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for (int i = 0; i < num_lookups; i++) {
+        uint64_t key = static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ULL;
+        PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(key % num_pages)};
+        for (int level = 0; level < depth; level++) {
+            Page *page = bpm.fetch_page(page_id);
+            auto children = reinterpret_cast<page_id_t *>(page->get_data());
+            page_id_t child = children[(key >> (level * 10)) % slots];
+            bpm.unpin_page(page_id, false);
+            page_id.page_no = child;
+        }
+        checksum += page_id.page_no;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    long long misses = -1;
+    if (counter >= 0) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) != sizeof(misses)) {
+            misses = -1;
+        }
+        close(counter);
+    }
+
+    const char *mode = !huge_pages ? "4K" : (bpm.is_hugetlb() ? "hugetlb" : "THP");
+    printf("%-10s%16.1f", mode, elapsed.count() / num_lookups);
+    if (misses >= 0) {
+        printf("%22.3f", static_cast<double>(misses) / num_lookups);
+    } else {
+        printf("%22s", "n/a");
+    }
+    printf("    (checksum %llu)\n", static_cast<unsigned long long>(checksum));
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : BUFFER_POOL_SIZE;
+    int num_lookups = argc > 2 ? atoi(argv[2]) : 2000000;
+    int depth = argc > 3 ? atoi(argv[3]) : 3;
+
+    DiskManager disk_manager;
+    if (!disk_manager.is_dir(BENCH_DB_NAME)) {
+        disk_manager.create_dir(BENCH_DB_NAME);
+    }
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+    if (disk_manager.is_file(BENCH_FILE_NAME)) {
+        disk_manager.destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager.create_file(BENCH_FILE_NAME);
+    int fd = disk_manager.open_file(BENCH_FILE_NAME);
+
+    // 所有页面都在缓冲池中新建且不会被淘汰，测试过程中没有磁盘I/O
+    printf("%-10s%16s%22s\n", "pages", "ns/lookup", "dTLB misses/lookup");
+    run_bench(&disk_manager, fd, num_pages, num_lookups, depth, false);
+    run_bench(&disk_manager, fd, num_pages, num_lookups, depth, true);
+
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    return 0;
+}
@@ -12,29 +12,41 @@ See the Mulan PSL v2 for more details. */
 
 #define private public
 
+#include "index/ix.h"
 #include "record/rm.h"
 #include "storage/buffer_pool_manager.h"
 
 #undef private
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <set>
+#include <sstream>
 #include <string>
 #include <thread>  // NOLINT
 #include <unordered_map>
 #include <vector>
 
+#include "execution/executor_delete.h"
+#include "execution/executor_projection.h"
+#include "execution/executor_seq_scan.h"
 #include "gtest/gtest.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
 #include "replacer/lru_replacer.h"
+#include "storage/crc32c.h"
 #include "storage/disk_manager.h"
+#include "storage/lz4.h"
 
 const std::string TEST_DB_NAME = "BufferPoolManagerTest_db";  // 以数据库名作为根目录
 const std::string TEST_FILE_NAME = "basic";                   // 测试文件的名字
@@ -117,6 +129,8 @@ void check_equal(const RmFileHandle *file_handle,
         auto mock_buf = (char *)entry.second.c_str();
         auto rec = file_handle->get_record(rid, nullptr);
         assert(memcmp(mock_buf, rec->data, file_handle->file_hdr_.record_size) == 0);
+        auto view = file_handle->get_record_view(rid, nullptr);
+        assert(view && memcmp(mock_buf, view.data, file_handle->file_hdr_.record_size) == 0);
     }
     // Randomly get record
     for (int i = 0; i < 10; i++) {
@@ -132,9 +146,20 @@ void check_equal(const RmFileHandle *file_handle,
         assert(mock.count(scan.rid()) > 0);
         auto rec = file_handle->get_record(scan.rid(), nullptr);
         assert(memcmp(rec->data, mock.at(scan.rid()).c_str(), file_handle->file_hdr_.record_size) == 0);
+        assert(memcmp(scan.record_data(), rec->data, file_handle->file_hdr_.record_size) == 0);
         num_records++;
     }
     assert(num_records == mock.size());
+    // Test page-at-a-time scan: 每个页面只pin一次，页内记录直接在缓冲池中读取
+    num_records = 0;
+    for (RmScan scan(file_handle); !scan.is_end(); scan.next_page()) {
+        for (int slot_no : scan.page_slots()) {
+            Rid rid = {.page_no = scan.rid().page_no, .slot_no = slot_no};
+            assert(memcmp(scan.get_slot_data(slot_no), mock.at(rid).c_str(), file_handle->file_hdr_.record_size) == 0);
+            num_records++;
+        }
+    }
+    assert(num_records == mock.size());
 }
 
 // std::cout can call this, for example: std::cout << rid
@@ -231,6 +256,165 @@ TEST(LRUReplacerTest, SampleTest) {
     EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, SampleTest) {
+    ClockReplacer clock_replacer(7);
+
+    // Scenario: unpin six elements, i.e. add them to the replacer.
+    clock_replacer.unpin(1);
+    clock_replacer.unpin(2);
+    clock_replacer.unpin(3);
+    clock_replacer.unpin(4);
+    clock_replacer.unpin(5);
+    clock_replacer.unpin(6);
+    clock_replacer.unpin(1);
+    EXPECT_EQ(6, clock_replacer.Size());
+
+    // Scenario: get three victims from the clock.
+    // 所有引用位都为1，第一圈全部清0，第二圈从1号帧开始淘汰
+    int value;
+    clock_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+
+    // Scenario: pin elements in the replacer.
+    // Note that 3 has already been victimized, so pinning 3 should have no effect.
+    clock_replacer.pin(3);
+    clock_replacer.pin(4);
+    EXPECT_EQ(2, clock_replacer.Size());
+
+    // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
+    clock_replacer.unpin(4);
+
+    // Scenario: continue looking for victims. 4的引用位为1，获得第二次机会
+    clock_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(6, value);
+    clock_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+    EXPECT_EQ(0, clock_replacer.Size());
+    EXPECT_EQ(false, clock_replacer.victim(&value));
+}
+
+TEST(LRUKReplacerTest, SampleTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+
+    // Scenario: 帧1~3各访问两次(热点页面)，帧4~6只访问一次(例如全表扫描读入的页面)
+    for (int i = 1; i <= 6; i++) {
+        lru_k_replacer.record_access(i);
+        lru_k_replacer.pin(i);
+    }
+    for (int i = 1; i <= 3; i++) {
+        lru_k_replacer.record_access(i);
+    }
+    for (int i = 1; i <= 6; i++) {
+        lru_k_replacer.unpin(i);
+    }
+    EXPECT_EQ(6, lru_k_replacer.Size());
+
+    // 只访问一次的帧先被淘汰，按首次访问的先后顺序
+    int value;
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+
+    // 帧1再被访问一次，其第2近一次访问变为第二轮的访问时间，比帧2、3更晚
+    lru_k_replacer.record_access(1);
+    EXPECT_EQ(4, lru_k_replacer.Size());
+
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(6, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.pin(3);
+    EXPECT_EQ(1, lru_k_replacer.Size());
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
+
+// pin/unpin不算作访问；帧被淘汰或删除后装入新页面时，访问历史从零开始
+TEST(LRUKReplacerTest, HistoryResetTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+    int value;
+
+    // 帧1访问两次，帧2访问一次后反复pin/unpin(如flush_all_pages、缩容时的移出)，仍然先于帧1被淘汰
+    lru_k_replacer.record_access(1);
+    lru_k_replacer.record_access(1);
+    lru_k_replacer.record_access(2);
+    for (int i = 0; i < 3; i++) {
+        lru_k_replacer.pin(2);
+        lru_k_replacer.unpin(2);
+    }
+    lru_k_replacer.unpin(1);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+
+    // 帧2被淘汰后装入新页面并访问一次，帧3之后访问一次：帧2排在帧3之前，帧1最后
+    lru_k_replacer.reset_history(2);
+    lru_k_replacer.record_access(2);
+    lru_k_replacer.unpin(2);
+    lru_k_replacer.record_access(3);
+    lru_k_replacer.unpin(3);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+
+    // 帧4访问两次后页面被删除(只移出置换器)，帧重新装入的页面只访问一次，先于访问两次的帧5被淘汰
+    lru_k_replacer.record_access(5);
+    lru_k_replacer.record_access(4);
+    lru_k_replacer.record_access(4);
+    lru_k_replacer.record_access(5);
+    lru_k_replacer.unpin(4);
+    lru_k_replacer.pin(4);
+    lru_k_replacer.reset_history(4);
+    lru_k_replacer.record_access(4);
+    lru_k_replacer.unpin(4);
+    lru_k_replacer.unpin(5);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(4, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(5, value);
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
+
+// 缓冲池放弃淘汰victim选出的帧(帧正被乐观读者pin住)并把它放回时，帧保持原来的访问历史和淘汰顺序
+TEST(LRUKReplacerTest, VictimReinsertTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+    int value;
+
+    for (int i = 0; i < 3; i++) {
+        lru_k_replacer.record_access(1);
+    }
+    lru_k_replacer.record_access(2);
+    lru_k_replacer.record_access(3);
+    for (int i = 1; i <= 3; i++) {
+        lru_k_replacer.unpin(i);
+    }
+    // 依次取出全部帧再放回，相当于find_victim_page跳过了它们
+    std::vector<int> skipped;
+    while (lru_k_replacer.victim(&value)) {
+        skipped.push_back(value);
+    }
+    EXPECT_EQ(std::vector<int>({2, 3, 1}), skipped);
+    for (int frame_id : skipped) {
+        lru_k_replacer.unpin(frame_id);
+    }
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(3, value);
+    lru_k_replacer.victim(&value);
+    EXPECT_EQ(1, value);
+}
+
 /** 注意：每个测试点只测试了单个文件！
  * 对于每个测试点，先创建和进入目录TEST_DB_NAME
  * 然后在此目录下创建和打开文件TEST_FILE_NAME，记录其文件描述符fd */
@@ -328,6 +512,312 @@ TEST_F(BufferPoolManagerTest, SampleTest) {
     bpm->flush_all_pages(fd);
 }
 
+// read_pages/write_pages一次读写多个连续页面，页面数据位于互不相邻的内存中
+TEST_F(BufferPoolManagerTest, VectoredIoTest) {
+    const int num_pages = 8;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    int fd = BufferPoolManagerTest::fd_;
+
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<const char *> write_bufs;
+    for (int i = 0; i < num_pages; i++) {
+        rand_buf(PAGE_SIZE, pages[i].data());
+        write_bufs.push_back(pages[i].data());
+    }
+    disk_manager->write_pages(fd, 0, write_bufs.data(), num_pages);
+
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager->read_page(fd, i, buf, PAGE_SIZE);
+        EXPECT_EQ(0, memcmp(buf, pages[i].data(), PAGE_SIZE));
+    }
+
+    // 读取中间的一段页面
+    std::vector<std::vector<char>> read_pages(num_pages - 2, std::vector<char>(PAGE_SIZE));
+    std::vector<char *> read_bufs;
+    for (auto &page : read_pages) {
+        read_bufs.push_back(page.data());
+    }
+    disk_manager->read_pages(fd, 1, read_bufs.data(), num_pages - 2);
+    for (int i = 0; i < num_pages - 2; i++) {
+        EXPECT_EQ(0, memcmp(read_pages[i].data(), pages[i + 1].data(), PAGE_SIZE));
+    }
+
+    // 读到文件末尾之后视为错误
+    EXPECT_THROW(disk_manager->read_pages(fd, num_pages - 1, read_bufs.data(), 2), InternalError);
+}
+
+// O_DIRECT模式：缓冲池的帧数据按PAGE_SIZE对齐，不对齐的小块读写(如文件头)经过临时缓冲区
+TEST_F(BufferPoolManagerTest, DirectIoTest) {
+    const int num_pages = 16;
+    const std::string file_name = "direct_io_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(file_name)) {
+        disk_manager->destroy_file(file_name);
+    }
+    disk_manager->create_file(file_name);
+    disk_manager->set_direct_io(true);
+    int fd = disk_manager->open_file(file_name);
+    disk_manager->set_direct_io(false);
+    EXPECT_TRUE(disk_manager->is_direct_io(fd));
+
+    {
+        BufferPoolManager bpm(num_pages / 2, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            auto page = bpm.new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->get_data()) % PAGE_SIZE);
+            strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());  // NOLINT
+            EXPECT_EQ(1, bpm.unpin_page(page_id, true));
+        }
+        bpm.flush_all_pages(fd);
+    }
+
+    // 不对齐的小块写只覆盖页面开头，页面其余内容保持不变
+    const char header[] = "header";
+    disk_manager->write_page(fd, 1, header, sizeof(header));
+    char buf[PAGE_SIZE];
+    disk_manager->read_page(fd, 1, buf, sizeof(header));
+    EXPECT_EQ(0, strcmp(header, buf));
+
+    BufferPoolManager bpm(num_pages / 2, disk_manager);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = i};
+        auto page = bpm.fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        if (i == 1) {
+            EXPECT_EQ(0, strcmp(header, page->get_data()));
+        } else {
+            EXPECT_EQ(0, strcmp(std::to_string(i).c_str(), page->get_data()));
+        }
+        EXPECT_EQ(1, bpm.unpin_page(page_id, false));
+    }
+    bpm.flush_all_pages(fd);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(file_name);
+}
+
+// LZ4块格式的压缩与解压
+TEST(StorageTest, Lz4Test) {
+    std::mt19937 rng(2023);
+    std::vector<char> src(PAGE_SIZE), dst(PAGE_SIZE * 2), out(PAGE_SIZE);
+    for (int round = 0; round < 200; round++) {
+        int len = round < 20 ? round : static_cast<int>(rng() % (PAGE_SIZE + 1));
+        // 全0、随机、以及定长记录中常见的短字段加大段补0
+        int kind = round % 3;
+        for (int i = 0; i < len; i++) {
+            if (kind == 0) {
+                src[i] = 0;
+            } else if (kind == 1) {
+                src[i] = static_cast<char>(rng());
+            } else {
+                src[i] = i % 64 < 8 ? static_cast<char>(rng() % 4) : 0;
+            }
+        }
+        int clen = lz4_compress(src.data(), len, dst.data(), static_cast<int>(dst.size()));
+        ASSERT_GT(clen, 0);
+        if (kind != 1 && len == PAGE_SIZE) {
+            EXPECT_LT(clen, PAGE_SIZE / 4);
+        }
+        ASSERT_TRUE(lz4_decompress(dst.data(), clen, out.data(), len));
+        EXPECT_EQ(0, memcmp(src.data(), out.data(), len));
+        // 输出空间不够时返回-1，输入损坏时返回false
+        if (clen > 1) {
+            EXPECT_EQ(-1, lz4_compress(src.data(), len, dst.data(), clen - 1));
+            EXPECT_FALSE(lz4_decompress(dst.data(), clen - 1, out.data(), len));
+        }
+    }
+}
+
+// CRC32C：标准测试向量，分段计算与一次计算的结果相同
+TEST(StorageTest, Crc32cTest) {
+    EXPECT_EQ(0u, crc32c("", 0));
+    EXPECT_EQ(0xe3069283u, crc32c("123456789", 9));
+    std::vector<char> zeros(32, 0);
+    EXPECT_EQ(0x8a9136aau, crc32c(zeros.data(), zeros.size()));
+
+    std::mt19937 rng(2023);
+    std::vector<char> buf(PAGE_SIZE + 7);
+    for (auto &c : buf) {
+        c = static_cast<char>(rng());
+    }
+    uint32_t whole = crc32c(buf.data(), buf.size());
+    for (size_t split : {1ul, 7ul, 8ul, 100ul, static_cast<size_t>(PAGE_SIZE)}) {
+        EXPECT_EQ(whole, crc32c(buf.data() + split, buf.size() - split, crc32c(buf.data(), split)));
+    }
+}
+
+// 页面校验和：写出时填入页尾，读入时校验，损坏的页面抛出PageChecksumError，VERIFY TABLE使用的verify_page返回false
+TEST_F(BufferPoolManagerTest, ChecksumTest) {
+    const int num_pages = 16;
+    const std::string file_name = "checksum_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(file_name)) {
+        disk_manager->destroy_file(file_name);
+    }
+    disk_manager->create_file(file_name);
+    int fd = disk_manager->open_file(file_name);
+    EXPECT_FALSE(disk_manager->has_page_checksums(fd));
+    disk_manager->set_file_checksums(fd, true);
+    EXPECT_TRUE(disk_manager->has_page_checksums(fd));
+
+    // 页尾的校验和由DiskManager填入，只比较[0, Page::OFFSET_CHECKSUM)
+    std::mt19937 rng(2023);
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+    {
+        BufferPoolManager bpm(num_pages / 4, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm.new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            for (auto &c : pages[i]) {
+                c = static_cast<char>(rng());
+            }
+            memcpy(page->get_data(), pages[i].data(), PAGE_SIZE);
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+    }
+    // 只写页面开头时保留其余内容并重新计算校验和
+    const char header[] = "header";
+    disk_manager->write_page(fd, 0, header, sizeof(header));
+    memcpy(pages[0].data(), header, sizeof(header));
+    char buf[sizeof(header)];
+    disk_manager->read_page(fd, 0, buf, sizeof(buf));
+    EXPECT_EQ(0, memcmp(buf, header, sizeof(header)));
+    {
+        BufferPoolManager bpm(num_pages / 4, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = i};
+            Page *page = bpm.fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(0, memcmp(page->get_data(), pages[i].data(), Page::OFFSET_CHECKSUM));
+            EXPECT_TRUE(DiskManager::is_page_valid(page->get_data(), i));
+            EXPECT_FALSE(DiskManager::is_page_valid(page->get_data(), i + 1));  // 页号参与校验
+            bpm.unpin_page(page_id, false);
+        }
+    }
+
+    // 绕过DiskManager改坏页面3中的一个字节
+    const int corrupt_page = 3;
+    int raw_fd = open(file_name.c_str(), O_RDWR);
+    ASSERT_GE(raw_fd, 0);
+    char byte;
+    off_t offset = static_cast<off_t>(corrupt_page) * PAGE_SIZE + 100;
+    ASSERT_EQ(1, pread(raw_fd, &byte, 1, offset));
+    byte ^= 1;
+    ASSERT_EQ(1, pwrite(raw_fd, &byte, 1, offset));
+    close(raw_fd);
+
+    std::vector<char> page(PAGE_SIZE);
+    EXPECT_THROW(disk_manager->read_page(fd, corrupt_page, page.data(), PAGE_SIZE), PageChecksumError);
+    EXPECT_THROW(disk_manager->read_page(fd, corrupt_page, page.data(), 8), PageChecksumError);
+    std::vector<char *> bufs(num_pages);
+    std::vector<char> data(static_cast<size_t>(num_pages) * PAGE_SIZE);
+    for (int i = 0; i < num_pages; i++) {
+        bufs[i] = data.data() + static_cast<size_t>(i) * PAGE_SIZE;
+    }
+    EXPECT_THROW(disk_manager->read_pages(fd, 0, bufs.data(), num_pages), PageChecksumError);
+    for (int i = 0; i < num_pages; i++) {
+        EXPECT_EQ(i != corrupt_page, disk_manager->verify_page(fd, i));
+    }
+    // 跳过的页面在文件中是全0的空洞，视为正确
+    disk_manager->write_page(fd, num_pages + 2, pages[1].data(), PAGE_SIZE);
+    EXPECT_TRUE(disk_manager->verify_page(fd, num_pages));
+    EXPECT_TRUE(disk_manager->verify_page(fd, num_pages + 2));
+
+    disk_manager->close_file(fd);
+    EXPECT_FALSE(disk_manager->has_page_checksums(fd));
+    disk_manager->destroy_file(file_name);
+}
+
+// 页面压缩：页面在缓冲池中不压缩，写回磁盘时压缩，大小变化的页面搬到新的extent，重新打开文件后重建映射
+TEST_F(BufferPoolManagerTest, CompressionTest) {
+    const int num_pages = 64;
+    const std::string file_name = "compression_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    if (disk_manager->is_file(file_name)) {
+        disk_manager->destroy_file(file_name);
+    }
+    disk_manager->set_compression(true);
+    disk_manager->create_file(file_name);
+    disk_manager->set_compression(false);
+    int fd = disk_manager->open_file(file_name);
+    EXPECT_TRUE(disk_manager->is_compressed(fd));
+
+    // 偶数页大部分为0，奇数页为随机数据。可压缩的页面内容只由页号决定，每次压缩后的大小相同
+    std::mt19937 rng(2023);
+    std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE, 0));
+    auto fill_page = [&](int page_no, bool compressible) {
+        auto &page = pages[page_no];
+        for (int i = 0; i < PAGE_SIZE; i++) {
+            page[i] = compressible ? (i % 128 < 4 ? static_cast<char>(page_no * 7 + i) : 0) : static_cast<char>(rng());
+        }
+    };
+    auto write_all = [&]() {
+        BufferPoolManager bpm(num_pages / 4, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = i};
+            Page *page = i < disk_manager->get_file_size(file_name) / PAGE_SIZE ? bpm.fetch_page(page_id)
+                                                                                : bpm.new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            ASSERT_EQ(i, page_id.page_no);
+            memcpy(page->get_data(), pages[i].data(), PAGE_SIZE);
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+    };
+    auto check_all = [&]() {
+        BufferPoolManager bpm(num_pages / 4, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = i};
+            Page *page = bpm.fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(0, memcmp(page->get_data(), pages[i].data(), PAGE_SIZE));
+            bpm.unpin_page(page_id, false);
+        }
+    };
+    for (int i = 0; i < num_pages; i++) {
+        fill_page(i, i % 2 == 0);
+    }
+    write_all();
+    check_all();
+    EXPECT_EQ(num_pages * PAGE_SIZE, disk_manager->get_file_size(file_name));
+    EXPECT_LT(disk_manager->get_compressed_size(fd), num_pages * PAGE_SIZE * 3 / 4);
+
+    // 交换两类页面，每个页面都要搬到新的extent
+    for (int i = 0; i < num_pages; i++) {
+        fill_page(i, i % 2 == 1);
+    }
+    write_all();
+    check_all();
+    off_t size = disk_manager->get_compressed_size(fd);
+
+    // 不对齐的小块写只覆盖页面开头
+    const char header[] = "header";
+    disk_manager->write_page(fd, 0, header, sizeof(header));
+    memcpy(pages[0].data(), header, sizeof(header));
+
+    // 重新打开后映射和空闲extent都能恢复，之后反复交换两类页面时重用空闲extent，文件不再变大
+    disk_manager->close_file(fd);
+    fd = disk_manager->open_file(file_name);
+    EXPECT_TRUE(disk_manager->is_compressed(fd));
+    check_all();
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < num_pages; i++) {
+            fill_page(i, i % 2 == round % 2);
+        }
+        write_all();
+        check_all();
+    }
+    EXPECT_LE(disk_manager->get_compressed_size(fd), size + CompressedFile::MAX_EXTENT_SECTORS * CompressedFile::SECTOR_SIZE);
+    EXPECT_THROW(disk_manager->read_page(fd, num_pages, pages[0].data(), PAGE_SIZE), InternalError);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(file_name);
+}
+
 /** 注意：每个测试点只测试了单个文件！
  * 对于每个测试点，先创建和进入目录TEST_DB_NAME
  * 然后在此目录下创建和打开文件TEST_FILE_NAME_CCUR，记录其文件描述符fd */
@@ -425,6 +915,401 @@ TEST_F(BufferPoolManagerConcurrencyTest, ConcurrencyTest) {
     }  // end loop run=[0,num_runs)
 }
 
+// 多分区模式：不同线程的页面分布在不同分区上，分区间互不阻塞
+TEST_F(BufferPoolManagerConcurrencyTest, PartitionedTest) {
+    const int num_threads = 8;
+    const int num_runs = 20;
+    const int num_pages = 10;
+
+    // get fd
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+
+    for (int run = 0; run < num_runs; run++) {
+        auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+        // 每个分区留足够的帧，保证哈希不均匀时new_page也不会失败
+        std::shared_ptr<BufferPoolManager> bpm{new BufferPoolManager(num_threads * num_pages * 4, disk_manager, 4)};
+        EXPECT_EQ(4, bpm->get_num_partitions());
+
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.push_back(std::thread([&bpm, fd]() {  // NOLINT
+                PageId temp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+                std::vector<PageId> page_ids;
+                for (int i = 0; i < num_pages; i++) {
+                    auto new_page = bpm->new_page(&temp_page_id);
+                    ASSERT_NE(nullptr, new_page);
+                    strcpy(new_page->get_data(), std::to_string(temp_page_id.page_no).c_str());  // NOLINT
+                    page_ids.push_back(temp_page_id);
+                }
+                for (int i = 0; i < num_pages; i++) {
+                    EXPECT_EQ(1, bpm->unpin_page(page_ids[i], true));
+                    EXPECT_EQ(0, bpm->unpin_page(page_ids[i], true));
+                }
+                for (int j = 0; j < num_pages; j++) {
+                    auto page = bpm->fetch_page(page_ids[j]);
+                    ASSERT_NE(nullptr, page);
+                    EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[j].page_no).c_str(), (page->get_data())));
+                    EXPECT_EQ(1, bpm->unpin_page(page_ids[j], true));
+                }
+                for (int j = 0; j < num_pages; j++) {
+                    EXPECT_EQ(1, bpm->delete_page(page_ids[j]));
+                }
+                bpm->flush_all_pages(fd);
+            }));
+        }  // end loop tid=[0,num_threads)
+
+        for (int i = 0; i < num_threads; i++) {
+            threads[i].join();
+        }
+    }  // end loop run=[0,num_runs)
+}
+
+// 缓冲池远小于数据量时，多个线程并发换入换出同一批页面：缺页I/O不持有分区锁，页面内容必须保持正确
+TEST_F(BufferPoolManagerConcurrencyTest, EvictionTest) {
+    const int num_threads = 8;
+    const int num_pages = 64;
+    const int num_ops = 2000;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    for (const std::string replacer_type : {"LRU", "CLOCK", "LRU-K"}) {
+        std::shared_ptr<BufferPoolManager> bpm{new BufferPoolManager(num_threads * 2, disk_manager, 1, replacer_type)};
+
+        std::vector<PageId> page_ids;
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            auto page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());  // NOLINT
+            EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+            page_ids.push_back(page_id);
+        }
+
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.push_back(std::thread([&bpm, &page_ids, tid]() {  // NOLINT
+                std::mt19937 rng(tid);
+                for (int i = 0; i < num_ops; i++) {
+                    PageId page_id = page_ids[rng() % page_ids.size()];
+                    auto page = bpm->fetch_page(page_id);
+                    ASSERT_NE(nullptr, page);
+                    EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+                    // 写回同样的内容并标脏，让换出时也产生写I/O
+                    strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());  // NOLINT
+                    EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+                }
+            }));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        bpm->flush_all_pages(fd);
+    }
+}
+
+// 使用buffer ring扫描大量页面后，扫描前缓存的热点页面仍然留在缓冲池中
+TEST_F(BufferPoolManagerConcurrencyTest, ScanRingTest) {
+    const int pool_size = 64;
+    const int num_hot_pages = 16;
+    const int num_scan_pages = 200;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    std::shared_ptr<BufferPoolManager> bpm{new BufferPoolManager(pool_size, disk_manager)};
+
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_hot_pages + num_scan_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    }
+    bpm->flush_all_pages(fd);
+    for (int i = 0; i < num_hot_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(page_ids[i]));
+        EXPECT_EQ(1, bpm->unpin_page(page_ids[i], false));
+    }
+
+    BufferAccessStrategy strategy(8);
+    for (int i = num_hot_pages; i < num_hot_pages + num_scan_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(page_ids[i], &strategy));
+        EXPECT_EQ(1, bpm->unpin_page(page_ids[i], false));
+    }
+    auto &page_table = bpm->partitions_[0]->page_table_;
+    for (int i = 0; i < num_hot_pages; i++) {
+        EXPECT_EQ(1, page_table.count(page_ids[i]));
+    }
+
+    // 不使用访问策略时，同样的扫描会把热点页面淘汰出缓冲池
+    for (int i = num_hot_pages; i < num_hot_pages + num_scan_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(page_ids[i]));
+        EXPECT_EQ(1, bpm->unpin_page(page_ids[i], false));
+    }
+    for (int i = 0; i < num_hot_pages; i++) {
+        EXPECT_EQ(0, page_table.count(page_ids[i]));
+    }
+}
+
+// LRU-K下环中复用的帧装入的扫描页面只算一次访问，仍然先于访问过两次的热点页面被淘汰
+TEST_F(BufferPoolManagerConcurrencyTest, LRUKScanRingTest) {
+    const int num_hot_pages = 8;
+    const int ring_size = 4;
+    const int num_scan_pages = 100;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    std::vector<PageId> page_ids;
+    {
+        BufferPoolManager bpm(16, disk_manager);
+        for (int i = 0; i < num_hot_pages + num_scan_pages + ring_size; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm.new_page(&page_id));
+            EXPECT_EQ(1, bpm.unpin_page(page_id, true));
+            page_ids.push_back(page_id);
+        }
+        bpm.flush_all_pages(fd);
+    }
+
+    // 缓冲池只放得下热点页面和一个环
+    BufferPoolManager bpm(num_hot_pages + ring_size, disk_manager, 1, "LRU-K");
+    bpm.set_optimistic_reads(false);
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < num_hot_pages; i++) {
+            ASSERT_NE(nullptr, bpm.fetch_page(page_ids[i]));
+            EXPECT_EQ(1, bpm.unpin_page(page_ids[i], false));
+        }
+    }
+    BufferAccessStrategy strategy(ring_size);
+    for (int i = num_hot_pages; i < num_hot_pages + num_scan_pages; i++) {
+        ASSERT_NE(nullptr, bpm.fetch_page(page_ids[i], &strategy));
+        EXPECT_EQ(1, bpm.unpin_page(page_ids[i], false));
+    }
+    // 不使用访问策略读入ring_size个页面，淘汰的应当是环中的扫描页面
+    for (int i = num_hot_pages + num_scan_pages; i < num_hot_pages + num_scan_pages + ring_size; i++) {
+        ASSERT_NE(nullptr, bpm.fetch_page(page_ids[i]));
+        EXPECT_EQ(1, bpm.unpin_page(page_ids[i], false));
+    }
+    auto &page_table = bpm.partitions_[0]->page_table_;
+    for (int i = 0; i < num_hot_pages; i++) {
+        EXPECT_EQ(1, page_table.count(page_ids[i]));
+    }
+}
+
+// 预读的页面在后台线程中读入，随后fetch_page得到的内容正确，且预读本身不会残留pin
+TEST_F(BufferPoolManagerConcurrencyTest, PrefetchTest) {
+    const int num_pages = 64;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    std::vector<PageId> page_ids;
+    {
+        BufferPoolManager bpm(num_pages, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            auto page = bpm.new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());  // NOLINT
+            EXPECT_EQ(1, bpm.unpin_page(page_id, true));
+            page_ids.push_back(page_id);
+        }
+        bpm.flush_all_pages(fd);
+    }
+
+    // 缓冲池只有一半大小，预读会在后台不断换出先读入的页面
+    std::shared_ptr<BufferPoolManager> bpm{new BufferPoolManager(num_pages / 2, disk_manager, 4)};
+    bpm->prefetch_pages(fd, page_ids[0].page_no, num_pages);
+    for (auto &page_id : page_ids) {
+        bpm->prefetch_page(page_id);
+        auto page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+        EXPECT_EQ(1, bpm->unpin_page(page_id, false));
+    }
+    bpm->flush_all_pages(fd);
+    for (size_t i = 0; i < bpm->pool_size_; i++) {
+        EXPECT_EQ(0, bpm->pages_[i].pin_count_);
+    }
+}
+
+/**
+ * @brief 后台清理线程写回淘汰端的脏页，遵守WAL规则，之后淘汰这些帧不再需要写回
+ */
+TEST_F(BufferPoolManagerConcurrencyTest, PageCleanerTest) {
+    const int num_pages = 32;
+    const lsn_t unflushed_lsn = 100;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    std::shared_ptr<BufferPoolManager> bpm{new BufferPoolManager(num_pages, disk_manager, 2)};
+    lsn_t flushed_lsn = 0;
+    bpm->set_flushed_lsn_getter([&flushed_lsn]() { return flushed_lsn; });
+
+    // 页号为奇数的页面日志号大于已持久化的日志号，暂时不能写回
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data() + sizeof(lsn_t), std::to_string(page_id.page_no).c_str());  // NOLINT
+        if (page_id.page_no % 2 == 1) {
+            page->set_page_lsn(unflushed_lsn);
+        }
+        EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    }
+
+    size_t num_even = (num_pages + 1 - page_ids[0].page_no % 2) / 2;
+    EXPECT_EQ(num_even, bpm->clean_pages(num_pages, num_pages));
+    EXPECT_EQ(0, bpm->clean_pages(num_pages, num_pages));
+    flushed_lsn = unflushed_lsn;
+    EXPECT_EQ(num_pages - num_even, bpm->clean_pages(num_pages, num_pages));
+    EXPECT_EQ(num_pages, bpm->get_pages_cleaned());
+
+    char buf[PAGE_SIZE];
+    for (auto &page_id : page_ids) {
+        EXPECT_FALSE(bpm->pages_[bpm->get_partition(page_id).page_table_[page_id]].is_dirty_);
+        disk_manager->read_page(fd, page_id.page_no, buf, PAGE_SIZE);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), buf + sizeof(lsn_t)));
+    }
+
+    // 所有页面都已是干净页，换入新页面时不需要同步写回
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    }
+    EXPECT_EQ(0, bpm->get_pages_evicted_dirty());
+
+    // 后台线程最终会写回所有脏页
+    bpm->start_page_cleaner(num_pages, 8, 1);
+    for (int i = 0; i < 1000 && bpm->get_pages_cleaned() < 2 * num_pages; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    bpm->stop_page_cleaner();
+    EXPECT_EQ(2 * num_pages, bpm->get_pages_cleaned());
+    for (auto it = page_ids.begin() + num_pages; it != page_ids.end(); ++it) {
+        PageId page_id = *it;
+        auto page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_FALSE(page->is_dirty_);
+        EXPECT_EQ(1, bpm->unpin_page(page_id, false));
+    }
+}
+
+/**
+ * @brief 在线扩容和缩容：扩容后新增的帧立即可用，缩容时等待被pin的帧释放，写回脏页后回收
+ */
+TEST_F(BufferPoolManagerConcurrencyTest, ResizeTest) {
+    const int initial_size = 16;
+    const int max_size = 64;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    std::shared_ptr<BufferPoolManager> bpm{
+        new BufferPoolManager(initial_size, disk_manager, 2, REPLACER_TYPE, false, max_size)};
+    EXPECT_THROW(bpm->resize(max_size + 1), InternalError);
+
+    // 扩容后所有页面都能同时常驻，不需要淘汰
+    bpm->resize(max_size);
+    EXPECT_EQ(max_size, bpm->get_pool_size());
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < max_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());  // NOLINT
+        page_ids.push_back(page_id);
+    }
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+    }
+    EXPECT_EQ(0, bpm->get_pages_evicted_dirty());
+
+    // 缩容时最后一个页面被另一个线程pin住一段时间，resize等待其释放
+    auto pinned = bpm->fetch_page(page_ids.back());
+    ASSERT_NE(nullptr, pinned);
+    std::thread unpinner([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bpm->unpin_page(page_ids.back(), false);
+    });
+    bpm->resize(initial_size / 2);
+    unpinner.join();
+    EXPECT_EQ(initial_size / 2, bpm->get_pool_size());
+    size_t cached = 0;
+    for (auto &part : bpm->partitions_) {
+        cached += part->page_table_.size();
+    }
+    EXPECT_LE(cached, static_cast<size_t>(initial_size / 2));
+
+    // 被回收的脏页已经写回，重新读入后内容不变
+    for (auto &page_id : page_ids) {
+        auto page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+        EXPECT_EQ(1, bpm->unpin_page(page_id, false));
+    }
+    bpm->flush_all_pages(fd);
+}
+
+/**
+ * @brief 乐观读路径：命中时不加锁pin住页面且不改动置换器；并发读和换入换出同时进行时读到的页面内容始终正确
+ */
+TEST_F(BufferPoolManagerConcurrencyTest, OptimisticReadTest) {
+    const int pool_size = 16;
+    const int num_pages = 64;
+    const int num_readers = 4;
+    const int num_writers = 2;
+    const int num_ops = 5000;
+
+    int fd = BufferPoolManagerConcurrencyTest::fd_;
+    auto disk_manager = BufferPoolManagerConcurrencyTest::disk_manager_.get();
+    std::shared_ptr<BufferPoolManager> bpm{new BufferPoolManager(pool_size, disk_manager, 1, "LRU")};
+
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        auto page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(page_id.page_no).c_str());  // NOLINT
+        EXPECT_EQ(1, bpm->unpin_page(page_id, true));
+        page_ids.push_back(page_id);
+    }
+
+    // 最后一个页面仍在缓冲池中，命中时它留在置换器里，pin和unpin都不经过置换器
+    auto &part = bpm->get_partition(page_ids.back());
+    size_t replacer_size = part.replacer_->Size();
+    auto page = bpm->fetch_page(page_ids.back());
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->pin_count_);
+    EXPECT_EQ(replacer_size, part.replacer_->Size());
+    EXPECT_EQ(1, bpm->unpin_page(page_ids.back(), false));
+    EXPECT_EQ(0, page->pin_count_);
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_readers + num_writers; tid++) {
+        threads.push_back(std::thread([&bpm, &page_ids, tid, num_readers]() {  // NOLINT
+            std::mt19937 rng(tid);
+            bool writer = tid >= num_readers;
+            for (int i = 0; i < num_ops; i++) {
+                // 读者集中访问前1/8的页面，使其大多命中；写者访问所有页面并标脏，不断触发淘汰和写回
+                PageId page_id = page_ids[rng() % (writer ? page_ids.size() : page_ids.size() / 8)];
+                auto page = bpm->fetch_page(page_id);
+                ASSERT_NE(nullptr, page);
+                EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+                EXPECT_EQ(1, bpm->unpin_page(page_id, writer));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < pool_size; i++) {
+        EXPECT_EQ(0, bpm->pages_[i].pin_count_);
+    }
+    bpm->flush_all_pages(fd);
+}
+
 // TODO: fix detected memory leaks found by Google Test
 TEST(StorageTest, SimpleTest) {
     srand((unsigned)time(nullptr));
@@ -501,6 +1386,48 @@ TEST(StorageTest, SimpleTest) {
     
 }
 
+/**
+ * @brief 位图的逐字和AVX2查找与逐位查找结果一致；get_set_bits和count与逐位统计一致
+ */
+TEST(BitmapTest, NextBitTest) {
+    std::mt19937 rng(0);
+    char bm[PAGE_SIZE];
+    int positions[PAGE_SIZE * BITMAP_WIDTH];
+    for (int max_n : {1, 7, 63, 64, 65, 501, 1024, 3622}) {
+        for (int fill : {0, 1, 50, 99, 100}) {
+            int size = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+            // 超出max_n的填充位随机设置，查找时不应被返回
+            for (int i = 0; i < size; i++) {
+                bm[i] = static_cast<char>(rng());
+            }
+            std::vector<int> expected;
+            for (int i = 0; i < max_n; i++) {
+                if (static_cast<int>(rng() % 100) < fill) {
+                    Bitmap::set(bm, i);
+                    expected.push_back(i);
+                } else {
+                    Bitmap::reset(bm, i);
+                }
+            }
+            for (bool bit : {false, true}) {
+                for (int curr = -1; curr < max_n; curr++) {
+                    int pos = Bitmap::next_bit_bitwise(bit, bm, max_n, curr);
+                    ASSERT_EQ(pos, Bitmap::next_bit_word(bit, bm, max_n, curr));
+#ifdef RMDB_BITMAP_AVX2
+                    if (Bitmap::has_avx2()) {
+                        ASSERT_EQ(pos, Bitmap::next_bit_avx2(bit, bm, max_n, curr));
+                    }
+#endif
+                    ASSERT_EQ(pos, Bitmap::next_bit(bit, bm, max_n, curr));
+                }
+            }
+            int n = Bitmap::get_set_bits(bm, max_n, positions);
+            EXPECT_EQ(expected, std::vector<int>(positions, positions + n));
+            EXPECT_EQ(static_cast<int>(expected.size()), Bitmap::count(bm, max_n));
+        }
+    }
+}
+
 TEST(RecordManagerTest, SimpleTest) {
     srand((unsigned)time(nullptr));
 
@@ -595,3 +1522,1489 @@ TEST(RecordManagerTest, SimpleTest) {
     rm_manager->close_file(file_handle.get());
     rm_manager->destroy_file(filename);
 }
+
+/**
+ * @brief 空闲空间映射：并发插入的线程使用不同的插入页面，记录互不覆盖；删除记录后释放的空间记录在FSM文件中，
+ * 重新打开文件后仍能被插入复用
+ */
+TEST(RecordManagerTest, FreeSpaceMapTest) {
+    const int num_threads = 4;
+    const int num_inserts = 200;
+    const int record_size = 256;
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(1024, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "fsm_test.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+
+    // 并发插入
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    std::vector<std::vector<Rid>> rids(num_threads);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&, tid]() {  // NOLINT
+            char buf[record_size];
+            for (int i = 0; i < num_inserts; i++) {
+                memset(buf, 0, record_size);
+                snprintf(buf, record_size, "%d-%d", tid, i);
+                rids[tid].push_back(file_handle->insert_record(buf, nullptr));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::set<std::pair<int, int>> all_rids;
+    for (int tid = 0; tid < num_threads; tid++) {
+        for (int i = 0; i < num_inserts; i++) {
+            Rid rid = rids[tid][i];
+            EXPECT_TRUE(all_rids.insert({rid.page_no, rid.slot_no}).second);
+            auto rec = file_handle->get_record(rid, nullptr);
+            ASSERT_NE(nullptr, rec);
+            EXPECT_EQ(std::to_string(tid) + "-" + std::to_string(i), std::string(rec->data));
+        }
+    }
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+
+    // 每个页面都删掉一半记录后并发插入：各插入目标在FSM中同时查找空闲页面，认领时发现已被占用的重新查找，
+    // 插入的记录仍然互不覆盖
+    rm_manager->create_file(filename, record_size);
+    file_handle = rm_manager->open_file(filename);
+    std::vector<Rid> filled;
+    {
+        char buf[record_size] = {};
+        for (int i = 0; i < num_threads * num_inserts; i++) {
+            filled.push_back(file_handle->insert_record(buf, nullptr));
+        }
+    }
+    for (size_t i = 0; i < filled.size(); i += 2) {
+        file_handle->delete_record(filled[i], nullptr);
+    }
+    int num_pages = file_handle->get_file_hdr().num_pages;
+    threads.clear();
+    for (int tid = 0; tid < num_threads; tid++) {
+        rids[tid].clear();
+        threads.push_back(std::thread([&, tid]() {  // NOLINT
+            char buf[record_size];
+            for (int i = 0; i < num_inserts / 2; i++) {
+                memset(buf, 0, record_size);
+                snprintf(buf, record_size, "%d-%d", tid, i);
+                rids[tid].push_back(file_handle->insert_record(buf, nullptr));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    all_rids.clear();
+    for (int tid = 0; tid < num_threads; tid++) {
+        for (int i = 0; i < num_inserts / 2; i++) {
+            Rid rid = rids[tid][i];
+            EXPECT_TRUE(all_rids.insert({rid.page_no, rid.slot_no}).second);
+            auto rec = file_handle->get_record(rid, nullptr);
+            ASSERT_NE(nullptr, rec);
+            EXPECT_EQ(std::to_string(tid) + "-" + std::to_string(i), std::string(rec->data));
+        }
+    }
+    // 删除释放的空间足够放下所有新记录，插入目标各自至多多分配一个页面
+    EXPECT_LE(file_handle->get_file_hdr().num_pages, num_pages + RM_INSERT_TARGETS);
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+
+    // 写满3个页面后删除中间页面上的一条记录，重新打开文件后插入复用该slot，不分配新页面
+    rm_manager->create_file(filename, record_size);
+    file_handle = rm_manager->open_file(filename);
+    int records_per_page = file_handle->get_file_hdr().num_records_per_page;
+    char buf[record_size] = {};
+    for (int i = 0; i < 3 * records_per_page; i++) {
+        file_handle->insert_record(buf, nullptr);
+    }
+    EXPECT_EQ(4, file_handle->get_file_hdr().num_pages);
+    Rid deleted = {.page_no = 2, .slot_no = records_per_page / 2};
+    file_handle->delete_record(deleted, nullptr);
+    rm_manager->close_file(file_handle.get());
+
+    file_handle = rm_manager->open_file(filename);
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    EXPECT_EQ(deleted.page_no, rid.page_no);
+    EXPECT_EQ(deleted.slot_no, rid.slot_no);
+    EXPECT_EQ(4, file_handle->get_file_hdr().num_pages);
+    rm_manager->close_file(file_handle.get());
+
+    // 页面已经写到磁盘、文件头还没有写回时崩溃：重新打开后按文件大小分配页号，不覆盖已有的页面
+    file_handle = rm_manager->open_file(filename);
+    for (int i = 0; i < 2 * records_per_page; i++) {
+        snprintf(buf, record_size, "%d", i);
+        file_handle->insert_record(buf, nullptr);
+    }
+    EXPECT_EQ(6, file_handle->get_file_hdr().num_pages);
+    buffer_pool_manager->flush_all_pages(file_handle->fd_);
+    buffer_pool_manager->flush_all_pages(file_handle->fsm_fd_);
+    disk_manager->close_file(file_handle->fd_);
+    disk_manager->close_file(file_handle->fsm_fd_);
+    file_handle.reset();
+    disk_manager = std::make_unique<DiskManager>();
+    buffer_pool_manager = std::make_unique<BufferPoolManager>(1024, disk_manager.get());
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(6, file_handle->get_file_hdr().num_pages);
+    EXPECT_EQ(6, disk_manager->get_fd2pageno(file_handle->fd_));
+    memset(buf, 0, record_size);
+    for (int i = 0; i < records_per_page; i++) {
+        EXPECT_LE(6, file_handle->insert_record(buf, nullptr).page_no);
+    }
+    auto rec = file_handle->get_record({5, 0}, nullptr);
+    EXPECT_EQ(std::to_string(records_per_page), std::string(rec->data));
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 页面校验和按文件记录在文件头中：带校验和创建的表在关闭默认设置后仍然校验；旧格式的表(文件头较短，
+ * 页面没有为校验和留出空间)在打开默认设置后仍不校验，可以写满整个页面；标记了校验和却没有留出空间的文件头拒绝打开
+ */
+TEST(RecordManagerTest, PageChecksumsTest) {
+    const int record_size = 37;     // 旧格式的页面中最后一个slot写到页尾
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "checksums_test.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+
+    disk_manager->set_page_checksums(true);
+    rm_manager->create_file(filename, record_size);
+    disk_manager->set_page_checksums(false);
+    auto file_handle = rm_manager->open_file(filename);
+    EXPECT_TRUE(disk_manager->has_page_checksums(file_handle->fd_));
+    EXPECT_TRUE(disk_manager->has_page_checksums(file_handle->fsm_fd_));
+    char buf[record_size] = {};
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_TRUE(disk_manager->has_page_checksums(file_handle->fd_));
+    EXPECT_TRUE(disk_manager->verify_page(file_handle->fd_, rid.page_no));
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+
+    // 旧格式的文件头只有前5个字段，没有FSM文件
+    int page_space = static_cast<int>(PAGE_SIZE - Page::OFFSET_PAGE_HDR - sizeof(RmPageHdr));
+    int old_hdr[5];
+    old_hdr[0] = record_size;
+    old_hdr[1] = 1;
+    old_hdr[2] = (BITMAP_WIDTH * page_space) / (1 + record_size * BITMAP_WIDTH);
+    old_hdr[3] = RM_NO_PAGE;
+    old_hdr[4] = (old_hdr[2] + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(old_hdr), sizeof(old_hdr));
+    disk_manager->close_file(fd);
+
+    disk_manager->set_page_checksums(true);
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_FALSE(disk_manager->has_page_checksums(file_handle->fd_));
+    EXPECT_FALSE(file_handle->get_file_hdr().page_checksums);
+    ASSERT_EQ(old_hdr[2], file_handle->get_file_hdr().num_records_per_page);
+    std::vector<Rid> rids;
+    for (int i = 0; i < old_hdr[2]; i++) {
+        memset(buf, 0, record_size);
+        snprintf(buf, record_size, "%d", i);
+        rids.push_back(file_handle->insert_record(buf, nullptr));
+        EXPECT_EQ(RM_FIRST_RECORD_PAGE, rids.back().page_no);
+    }
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    for (int i = 0; i < old_hdr[2]; i++) {
+        auto rec = file_handle->get_record(rids[i], nullptr);
+        ASSERT_NE(nullptr, rec);
+        EXPECT_EQ(std::to_string(i), std::string(rec->data));
+    }
+    rm_manager->close_file(file_handle.get());
+
+    // 标记了校验和，但页面格式仍写到页尾
+    RmFileHdr file_hdr;
+    fd = disk_manager->open_file(filename);
+    RmFileHandle::read_file_hdr(disk_manager.get(), fd, &file_hdr);
+    file_hdr.page_checksums = true;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, reinterpret_cast<char *>(&file_hdr), sizeof(file_hdr));
+    disk_manager->close_file(fd);
+    EXPECT_THROW(rm_manager->open_file(filename), InternalError);
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief slotted页面：有VARCHAR字段的记录去掉补齐后存储，每页能放下更多记录；随机插入、删除、变长/变短的更新后
+ * (包括搬到其他页面的记录)，读取、扫描和重新打开文件后的结果都与mock一致
+ */
+TEST(RecordManagerTest, SlottedPageTest) {
+    // | id: int | name: VARCHAR(200) | x: int | note: VARCHAR(100) |
+    const int record_size = 4 + 200 + 4 + 100;
+    const std::vector<RmColPos> var_cols = {{4, 200}, {208, 100}};
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "slotted_test.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, record_size, var_cols);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_slotted());
+
+    std::mt19937 rng(2023);
+    auto make_record = [&](int name_len, int note_len) {
+        std::string rec(record_size, '\0');
+        int id = static_cast<int>(rng());
+        memcpy(&rec[0], &id, sizeof(int));
+        for (int i = 0; i < name_len; i++) {
+            rec[4 + i] = static_cast<char>('a' + rng() % 26);
+        }
+        memcpy(&rec[204], &id, sizeof(int));
+        for (int i = 0; i < note_len; i++) {
+            rec[208 + i] = static_cast<char>('A' + rng() % 26);
+        }
+        return rec;
+    };
+
+    // 短字符串的记录：定长页面每页只能放下(PAGE_SIZE / record_size)条
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    const int num_short = 500;
+    for (int i = 0; i < num_short; i++) {
+        std::string rec = make_record(rng() % 16, rng() % 8);
+        mock[file_handle->insert_record(&rec[0], nullptr)] = rec;
+    }
+    int fixed_pages = (num_short + PAGE_SIZE / record_size - 1) / (PAGE_SIZE / record_size);
+    EXPECT_LT(file_handle->get_file_hdr().num_pages * 4, fixed_pages);
+    check_equal(file_handle.get(), mock);
+
+    // 随机插入、删除、更新，更新时记录长度随机变化
+    for (int round = 0; round < 2000; round++) {
+        int op = rng() % 3;
+        if (op == 0 || mock.empty()) {
+            std::string rec = make_record(rng() % 201, rng() % 101);
+            mock[file_handle->insert_record(&rec[0], nullptr)] = rec;
+            continue;
+        }
+        auto it = mock.begin();
+        std::advance(it, rng() % mock.size());
+        Rid rid = it->first;
+        if (op == 1) {
+            std::string rec = make_record(rng() % 201, rng() % 101);
+            file_handle->update_record(rid, &rec[0], nullptr);
+            it->second = rec;
+        } else {
+            file_handle->delete_record(rid, nullptr);
+            mock.erase(it);
+        }
+        if (round % 500 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+        }
+    }
+    check_equal(file_handle.get(), mock);
+
+    // 删除全部记录后页面整理为空，再插入不需要分配新页面
+    int num_pages = file_handle->get_file_hdr().num_pages;
+    for (auto &entry : mock) {
+        file_handle->delete_record(entry.first, nullptr);
+    }
+    mock.clear();
+    check_equal(file_handle.get(), mock);
+    for (int i = 0; i < num_short; i++) {
+        std::string rec = make_record(rng() % 16, rng() % 8);
+        mock[file_handle->insert_record(&rec[0], nullptr)] = rec;
+    }
+    EXPECT_EQ(num_pages, file_handle->get_file_hdr().num_pages);
+    check_equal(file_handle.get(), mock);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+TEST(RecordManagerTest, PaxLayoutTest) {
+    // | id: int | name: char(20) | price: float | qty: int |
+    const int record_size = 4 + 20 + 4 + 4;
+    const std::vector<RmColPos> pax_cols = {{0, 4}, {4, 20}, {24, 4}, {28, 4}};
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "pax_test.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, record_size, {}, pax_cols);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_pax());
+
+    std::mt19937 rng(2023);
+    auto make_record = [&]() {
+        std::string rec(record_size, '\0');
+        rand_buf(record_size, &rec[0]);
+        return rec;
+    };
+
+    // 随机插入、删除、更新
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    for (int round = 0; round < 5000; round++) {
+        int op = mock.empty() ? 0 : rng() % 4;
+        if (op <= 1) {
+            std::string rec = make_record();
+            mock[file_handle->insert_record(&rec[0], nullptr)] = rec;
+            continue;
+        }
+        auto it = mock.begin();
+        std::advance(it, rng() % mock.size());
+        Rid rid = it->first;
+        if (op == 2) {
+            std::string rec = make_record();
+            file_handle->update_record(rid, &rec[0], nullptr);
+            it->second = rec;
+        } else {
+            file_handle->delete_record(rid, nullptr);
+            mock.erase(it);
+        }
+        if (round % 1000 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+        }
+    }
+    check_equal(file_handle.get(), mock);
+
+    // 按列访问每个页面上的字段值，与整条记录中的字段一致
+    size_t num_checked = 0;
+    RmScan scan(file_handle.get());
+    while (!scan.is_end()) {
+        int page_no = scan.rid().page_no;
+        for (auto &col : pax_cols) {
+            RmColumnView column = scan.get_column(col.offset, col.len);
+            EXPECT_EQ(column.stride, col.len);
+            for (int slot_no : scan.page_slots()) {
+                auto &rec = mock.at(Rid{page_no, slot_no});
+                EXPECT_EQ(memcmp(column.base + slot_no * column.stride, rec.data() + col.offset, col.len), 0);
+            }
+        }
+        num_checked += scan.page_slots().size();
+        scan.next_page();
+    }
+    EXPECT_EQ(num_checked, mock.size());
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+TEST(RecordManagerTest, ZoneMapTest) {
+    // | id: int | price: float | pad: char(24) |
+    const int record_size = 4 + 4 + 24;
+    const std::vector<RmZoneCol> zone_cols = {{0, TYPE_INT}, {4, TYPE_FLOAT}};
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "zone_map_test.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, record_size, {}, {}, zone_cols);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_EQ(file_handle->get_zone_col(4), 1);
+    ASSERT_EQ(file_handle->get_zone_col(8), -1);
+
+    std::mt19937 rng(2023);
+    auto make_record = [&](int id) {
+        std::string rec(record_size, '\0');
+        rand_buf(record_size, &rec[0]);
+        float price = static_cast<float>(rng() % 10000) / 100;
+        memcpy(&rec[0], &id, sizeof(int));
+        memcpy(&rec[4], &price, sizeof(float));
+        return rec;
+    };
+    auto satisfies = [&](const std::string &rec, const std::vector<RmZonePred> &preds) {
+        for (auto &pred : preds) {
+            double val;
+            if (zone_cols[pred.zone_col].type == TYPE_INT) {
+                val = *reinterpret_cast<const int *>(rec.data() + zone_cols[pred.zone_col].offset);
+            } else {
+                val = *reinterpret_cast<const float *>(rec.data() + zone_cols[pred.zone_col].offset);
+            }
+            bool ok = pred.op == OP_EQ ? val == pred.val : pred.op == OP_NE ? val != pred.val :
+                      pred.op == OP_LT ? val < pred.val : pred.op == OP_LE ? val <= pred.val :
+                      pred.op == OP_GT ? val > pred.val : val >= pred.val;
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // 扫描出的记录必须包含所有满足条件的记录，返回读取的页面数
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    auto check_scan = [&](const std::vector<RmZonePred> &preds) {
+        std::set<std::pair<int, int>> scanned;
+        int num_pages = 0;
+        RmScan scan(file_handle.get(), preds);
+        while (!scan.is_end()) {
+            num_pages++;
+            for (int slot_no : scan.page_slots()) {
+                scanned.emplace(scan.rid().page_no, slot_no);
+            }
+            scan.next_page();
+        }
+        for (auto &entry : mock) {
+            if (satisfies(entry.second, preds)) {
+                EXPECT_TRUE(scanned.count({entry.first.page_no, entry.first.slot_no}));
+            }
+        }
+        return num_pages;
+    };
+
+    // id按插入顺序递增，id > 4000的记录集中在最后的页面上
+    const int num_records = 5000;
+    for (int id = 0; id < num_records; id++) {
+        std::string rec = make_record(id);
+        mock[file_handle->insert_record(&rec[0], nullptr)] = rec;
+    }
+    int num_pages = file_handle->get_file_hdr().num_pages - 1;
+    int tail_pages = (num_records - 4000) / file_handle->get_file_hdr().num_records_per_page + 2;
+    std::vector<RmZonePred> tail = {{0, OP_GT, 4000}};
+    EXPECT_EQ(check_scan({}), num_pages);
+    EXPECT_LE(check_scan(tail), tail_pages);
+    EXPECT_EQ(check_scan({{0, OP_LT, 0}}), 0);
+
+    // 重新打开文件后范围未知，第一次扫描读取所有页面、计算出范围后跳过不满足条件的页面
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(file_handle->get_zone_state(RM_FIRST_RECORD_PAGE), RM_ZONE_UNKNOWN);
+    EXPECT_LE(check_scan(tail), tail_pages);
+    EXPECT_EQ(file_handle->get_zone_state(RM_FIRST_RECORD_PAGE), RM_ZONE_EXACT);
+    EXPECT_LE(check_scan(tail), tail_pages);
+
+    // 随机插入、删除、更新后跳过页面仍然正确
+    for (int round = 0; round < 3000; round++) {
+        int op = rng() % 3;
+        if (op == 0) {
+            std::string rec = make_record(static_cast<int>(rng() % (2 * num_records)));
+            mock[file_handle->insert_record(&rec[0], nullptr)] = rec;
+            continue;
+        }
+        auto it = mock.begin();
+        std::advance(it, rng() % mock.size());
+        if (op == 1) {
+            std::string rec = make_record(static_cast<int>(rng() % (2 * num_records)));
+            file_handle->update_record(it->first, &rec[0], nullptr);
+            it->second = rec;
+        } else {
+            file_handle->delete_record(it->first, nullptr);
+            mock.erase(it);
+        }
+        if (round % 100 == 0) {
+            std::vector<RmZonePred> preds;
+            CompOp ops[] = {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE};
+            for (int i = 0; i < 2; i++) {
+                int col = rng() % 2;
+                double val = col == 0 ? static_cast<double>(rng() % (2 * num_records)) : static_cast<float>(rng() % 10000) / 100;
+                preds.push_back(RmZonePred{col, ops[rng() % 6], val});
+            }
+            check_scan(preds);
+        }
+    }
+
+    // 删除后页面的范围不精确，扫描时重新计算
+    for (auto it = mock.begin(); it != mock.end();) {
+        if (it->first.page_no == RM_FIRST_RECORD_PAGE) {
+            file_handle->delete_record(it->first, nullptr);
+            it = mock.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    EXPECT_EQ(file_handle->get_zone_state(RM_FIRST_RECORD_PAGE), RM_ZONE_LOOSE);
+    check_scan({});
+    EXPECT_EQ(file_handle->get_zone_state(RM_FIRST_RECORD_PAGE), RM_ZONE_EXACT);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+// 结点内key查找：各种key格式的比较器与按字段逐个ix_compare的结果一致
+TEST(IndexTest, KeySearchTest) {
+    std::mt19937 rng(2023);
+    std::vector<std::vector<std::pair<ColType, int>>> schemas = {
+        {{TYPE_INT, 4}},
+        {{TYPE_FLOAT, 4}},
+        {{TYPE_INT, 4}, {TYPE_INT, 4}},
+        {{TYPE_INT, 4}, {TYPE_INT, 4}, {TYPE_INT, 4}},
+        {{TYPE_STRING, 8}},
+        {{TYPE_STRING, 3}, {TYPE_STRING, 5}},
+        {{TYPE_INT, 4}, {TYPE_STRING, 4}},
+        {{TYPE_FLOAT, 4}, {TYPE_INT, 4}},
+    };
+    for (auto &schema : schemas) {
+        IxFileHdr file_hdr;
+        file_hdr.col_num_ = static_cast<int>(schema.size());
+        file_hdr.col_tot_len_ = 0;
+        for (auto &[type, len] : schema) {
+            file_hdr.col_types_.push_back(type);
+            file_hdr.col_lens_.push_back(len);
+            file_hdr.col_tot_len_ += len;
+        }
+        IxKeySearch key_search(file_hdr);
+        int key_len = file_hdr.col_tot_len_;
+        // 值取自很小的范围，产生大量相同的字段，多字段的key需要比较后面的字段
+        auto rand_key = [&](char *key) {
+            int offset = 0;
+            for (auto &[type, len] : schema) {
+                if (type == TYPE_INT) {
+                    int v = static_cast<int>(rng() % 40) - 20;
+                    memcpy(key + offset, &v, sizeof(v));
+                } else if (type == TYPE_FLOAT) {
+                    float v = static_cast<float>(static_cast<int>(rng() % 40) - 20) / 4;
+                    memcpy(key + offset, &v, sizeof(v));
+                } else {
+                    for (int i = 0; i < len; i++) {
+                        key[offset + i] = static_cast<char>("ab\xf0"[rng() % 3]);
+                    }
+                }
+                offset += len;
+            }
+        };
+        auto ref_cmp = [&](const char *a, const char *b) {
+            return ix_compare(a, b, file_hdr.col_types_, file_hdr.col_lens_);
+        };
+        for (int n : {0, 1, 2, 7, 8, 9, 63, 64, 65, 100, 340}) {
+            // n个有序的key
+            std::vector<std::vector<char>> sorted(n, std::vector<char>(key_len));
+            for (auto &key : sorted) {
+                rand_key(key.data());
+            }
+            std::sort(sorted.begin(), sorted.end(),
+                      [&](const std::vector<char> &a, const std::vector<char> &b) { return ref_cmp(a.data(), b.data()) < 0; });
+            std::vector<char> keys(static_cast<size_t>(n) * key_len + 1);
+            for (int i = 0; i < n; i++) {
+                memcpy(keys.data() + i * key_len, sorted[i].data(), key_len);
+            }
+            std::vector<char> target(key_len);
+            for (int round = 0; round < 50; round++) {
+                rand_key(target.data());
+                int begin = n > 0 ? static_cast<int>(rng() % 2) : 0;
+                int lower = begin, upper = begin;
+                while (lower < n && ref_cmp(keys.data() + lower * key_len, target.data()) < 0) {
+                    lower++;
+                }
+                while (upper < n && ref_cmp(keys.data() + upper * key_len, target.data()) <= 0) {
+                    upper++;
+                }
+                EXPECT_EQ(lower, key_search.lower_bound(keys.data(), begin, n, target.data()));
+                EXPECT_EQ(upper, key_search.upper_bound(keys.data(), begin, n, target.data()));
+                if (n > 0) {
+                    const char *key = keys.data() + (rng() % n) * key_len;
+                    int res = ref_cmp(key, target.data());
+                    int got = key_search.compare(key, target.data());
+                    EXPECT_EQ((res > 0) - (res < 0), (got > 0) - (got < 0));
+                }
+            }
+        }
+    }
+}
+
+// 结点内键值对的插入、查找与删除
+TEST(IndexTest, NodeTest) {
+    const std::string filename = "node_test";
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(16, disk_manager.get());
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+
+    IxFileHdr file_hdr;
+    file_hdr.col_num_ = 1;
+    file_hdr.col_types_ = {TYPE_INT};
+    file_hdr.col_lens_ = {4};
+    file_hdr.col_tot_len_ = 4;
+    file_hdr.btree_order_ = static_cast<int>((Page::OFFSET_CHECKSUM - sizeof(IxPageHdr)) / (4 + sizeof(Rid)) - 1);
+    file_hdr.keys_size_ = (file_hdr.btree_order_ + 1) * file_hdr.col_tot_len_;
+    IxKeySearch key_search(file_hdr);
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager->new_page(&page_id);
+    IxNodeHandle node(&file_hdr, &key_search, page);
+    node.page_hdr->num_key = 0;
+    node.page_hdr->is_leaf = true;
+
+    std::mt19937 rng(2023);
+    std::vector<int> values(node.get_max_size() - 1);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<int>(i) * 3;
+    }
+    std::shuffle(values.begin(), values.end(), rng);
+    for (size_t i = 0; i < values.size(); i++) {
+        Rid rid = {values[i], values[i] + 1};
+        EXPECT_EQ(static_cast<int>(i) + 1, node.insert(reinterpret_cast<const char *>(&values[i]), rid));
+        // 重复的key不插入
+        EXPECT_EQ(static_cast<int>(i) + 1, node.insert(reinterpret_cast<const char *>(&values[i]), rid));
+    }
+    std::set<int> expected(values.begin(), values.end());
+    auto check_node = [&]() {
+        ASSERT_EQ(static_cast<int>(expected.size()), node.get_size());
+        int i = 0;
+        for (int v : expected) {
+            EXPECT_EQ(v, node.key_at(i));
+            EXPECT_EQ(v + 1, node.get_rid(i)->slot_no);
+            i++;
+        }
+        for (int v = -1; v < static_cast<int>(values.size()) * 3 + 1; v++) {
+            Rid *rid = nullptr;
+            bool found = node.leaf_lookup(reinterpret_cast<const char *>(&v), &rid);
+            EXPECT_EQ(expected.count(v) > 0, found);
+            if (found) {
+                EXPECT_EQ(v, rid->page_no);
+            }
+            int lower = static_cast<int>(std::distance(expected.begin(), expected.lower_bound(v)));
+            EXPECT_EQ(lower, node.lower_bound(reinterpret_cast<const char *>(&v)));
+        }
+    };
+    check_node();
+    for (size_t i = 0; i < values.size(); i += 2) {
+        node.remove(reinterpret_cast<const char *>(&values[i]));
+        expected.erase(values[i]);
+    }
+    int missing = 1;
+    EXPECT_EQ(static_cast<int>(expected.size()), node.remove(reinterpret_cast<const char *>(&missing)));
+    check_node();
+
+    buffer_pool_manager->unpin_page(page_id, false);
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(filename);
+}
+
+// 400字节的字符串key使btree_order只有8左右，少量key就能得到多层的B+树
+static const int IX_TEST_KEY_LEN = 400;
+
+static std::vector<char> ix_test_key(int v) {
+    std::vector<char> key(IX_TEST_KEY_LEN, 0);  // 与CHAR字段相同，末尾补0
+    snprintf(key.data(), key.size(), "%08d", v);  // 前导0保证memcmp的顺序与整数顺序一致
+    return key;
+}
+
+// 沿叶子链表检查所有key有序且与expected一致，并逐个检查get_value
+static void check_tree(IxIndexHandle *ih, const std::set<int> &expected) {
+    std::vector<int> scanned;
+    IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), ih->buffer_pool_manager_);
+    for (; !scan.is_end(); scan.next()) {
+        scanned.push_back(scan.rid().page_no);
+    }
+    EXPECT_EQ(std::vector<int>(expected.begin(), expected.end()), scanned);
+    for (int v : expected) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih->get_value(ix_test_key(v).data(), &result, nullptr));
+        ASSERT_EQ(1u, result.size());
+        EXPECT_EQ(v, result[0].page_no);
+    }
+    if (!expected.empty()) {
+        int v = *expected.begin();
+        EXPECT_EQ(ih->leaf_begin(), ih->lower_bound(ix_test_key(v).data()));
+        Iid upper = ih->upper_bound(ix_test_key(*expected.rbegin()).data());
+        EXPECT_EQ(ih->leaf_end(), upper);
+    }
+}
+
+// 沿叶子链表求叶结点中最多的键值对数量
+static int max_leaf_size(IxIndexHandle *ih) {
+    int max_size = 0;
+    for (page_id_t page_no = ih->file_hdr_->first_leaf_; page_no != IX_LEAF_HEADER_PAGE;) {
+        IxNodeHandle *leaf = ih->fetch_node(page_no);
+        max_size = std::max(max_size, leaf->get_size());
+        page_no = leaf->get_next_leaf();
+        ih->buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    return max_size;
+}
+
+// B+树的插入、删除(分裂、合并与重分配)以及重新打开索引之后继续插入
+static void test_bplus_tree(bool blink, bool compress = false) {
+    const std::string filename =
+        std::string(compress ? "compressed_" : "") + (blink ? "blink_tree_test" : "bplus_tree_test");
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(4096, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "k", .type = TYPE_STRING,
+                                        .len = IX_TEST_KEY_LEN, .offset = 0, .index = true}};
+    if (disk_manager->is_file(ix_manager->get_index_name(filename, index_cols))) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols, blink, compress);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    ASSERT_EQ(blink, ih->file_hdr_->blink_);
+    ASSERT_EQ(compress, ih->file_hdr_->compress_);
+    ASSERT_LT(ih->file_hdr_->btree_order_, 16);
+
+    std::mt19937 rng(2023);
+    const int num_keys = 3000;
+    std::vector<int> values(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        values[i] = i * 2;
+    }
+    std::shuffle(values.begin(), values.end(), rng);
+    std::set<int> expected;
+    for (int v : values) {
+        ih->insert_entry(ix_test_key(v).data(), Rid{v, v}, nullptr);
+        expected.insert(v);
+    }
+    // 重复的key不插入
+    ih->insert_entry(ix_test_key(values[0]).data(), Rid{-1, -1}, nullptr);
+    check_tree(ih.get(), expected);
+    if (compress) {
+        // 压缩后每个key只保存几个字节，结点能装入的键值对比btree_order多
+        EXPECT_GT(max_leaf_size(ih.get()), ih->file_hdr_->btree_order_ + 1);
+    }
+    std::vector<Rid> result;
+    EXPECT_FALSE(ih->get_value(ix_test_key(1).data(), &result, nullptr));
+    // 不存在的key落在两个key之间
+    Iid iid = ih->lower_bound(ix_test_key(1).data());
+    EXPECT_EQ(2, ih->get_rid(iid).page_no);
+    iid = ih->upper_bound(ix_test_key(2).data());
+    EXPECT_EQ(4, ih->get_rid(iid).page_no);
+
+    std::shuffle(values.begin(), values.end(), rng);
+    for (int i = 0; i < num_keys / 2; i++) {
+        EXPECT_TRUE(ih->delete_entry(ix_test_key(values[i]).data(), nullptr));
+        EXPECT_FALSE(ih->delete_entry(ix_test_key(values[i]).data(), nullptr));
+        expected.erase(values[i]);
+    }
+    check_tree(ih.get(), expected);
+
+    // 删空之后根结点仍是一个空的叶结点(B-link树不合并结点，所有叶结点都为空)
+    for (int i = num_keys / 2; i < num_keys; i++) {
+        EXPECT_TRUE(ih->delete_entry(ix_test_key(values[i]).data(), nullptr));
+        expected.erase(values[i]);
+    }
+    check_tree(ih.get(), expected);
+    EXPECT_EQ(ih->leaf_begin(), ih->leaf_end());
+
+    for (int i = 0; i < num_keys / 2; i++) {
+        ih->insert_entry(ix_test_key(values[i]).data(), Rid{values[i], values[i]}, nullptr);
+        expected.insert(values[i]);
+    }
+    int num_pages = ih->file_hdr_->num_pages_;
+    ix_manager->close_index(ih.get());
+
+    // 重新打开后从num_pages开始分配新页面，不会覆盖已有结点
+    ih = ix_manager->open_index(filename, index_cols);
+    EXPECT_EQ(num_pages, disk_manager->get_fd2pageno(ih->fd_));
+    for (int i = num_keys / 2; i < num_keys; i++) {
+        ih->insert_entry(ix_test_key(values[i]).data(), Rid{values[i], values[i]}, nullptr);
+        expected.insert(values[i]);
+    }
+    check_tree(ih.get(), expected);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+TEST(IndexTest, BPlusTreeTest) { test_bplus_tree(false); }
+
+TEST(IndexTest, BLinkTreeTest) { test_bplus_tree(true); }
+
+TEST(IndexTest, CompressedBPlusTreeTest) { test_bplus_tree(false, true); }
+
+TEST(IndexTest, CompressedBLinkTreeTest) { test_bplus_tree(true, true); }
+
+// 文件头中没有格式版本号的索引文件(结点格式不同的旧文件)在打开时被拒绝
+TEST(IndexTest, LayoutVersionTest) {
+    const std::string filename = "layout_version_test";
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "k", .type = TYPE_STRING,
+                                        .len = IX_TEST_KEY_LEN, .offset = 0, .index = true}};
+    std::string ix_name = ix_manager->get_index_name(filename, index_cols);
+    if (disk_manager->is_file(ix_name)) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols, true, true);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    EXPECT_EQ(IX_LAYOUT_VERSION, ih->file_hdr_->layout_version_);
+    ix_manager->close_index(ih.get());
+
+    // 去掉文件头末尾的版本号，模拟加入版本号之前写出的文件
+    int fd = disk_manager->open_file(ix_name);
+    std::vector<char> buf(PAGE_SIZE);
+    disk_manager->read_page(fd, IX_FILE_HDR_PAGE, buf.data(), PAGE_SIZE);
+    IxFileHdr file_hdr;
+    file_hdr.deserialize(buf.data());
+    int tot_len = file_hdr.tot_len_ - static_cast<int>(sizeof(int));
+    memcpy(buf.data(), &tot_len, sizeof(int));
+    disk_manager->write_page(fd, IX_FILE_HDR_PAGE, buf.data(), PAGE_SIZE);
+    disk_manager->close_file(fd);
+    EXPECT_THROW(ix_manager->open_index(filename, index_cols), InternalError);
+
+    // 版本号不符的文件同样被拒绝
+    tot_len += sizeof(int);
+    int version = IX_LAYOUT_VERSION + 1;
+    memcpy(buf.data(), &tot_len, sizeof(int));
+    memcpy(buf.data() + tot_len - sizeof(int), &version, sizeof(int));
+    fd = disk_manager->open_file(ix_name);
+    disk_manager->write_page(fd, IX_FILE_HDR_PAGE, buf.data(), PAGE_SIZE);
+    disk_manager->close_file(fd);
+    EXPECT_THROW(ix_manager->open_index(filename, index_cols), InternalError);
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+// 多线程并发插入、删除与查找：其他线程的分裂与合并不影响查找已存在的key
+static void test_concurrency(bool blink, bool compress = false) {
+    const std::string filename = std::string(compress ? "compressed_" : "") +
+                                 (blink ? "blink_tree_concurrency_test" : "bplus_tree_concurrency_test");
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(4096, disk_manager.get(), BUFFER_POOL_PARTITIONS);
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "k", .type = TYPE_STRING,
+                                        .len = IX_TEST_KEY_LEN, .offset = 0, .index = true}};
+    if (disk_manager->is_file(ix_manager->get_index_name(filename, index_cols))) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols, blink, compress);
+    auto ih = ix_manager->open_index(filename, index_cols);
+
+    const int num_threads = 8;
+    const int keys_per_thread = 500;
+    const int num_keys = num_threads * keys_per_thread;
+    auto run_threads = [&](const std::function<void(int)> &func) {
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.emplace_back(func, tid);
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    };
+
+    // 每个线程插入v % num_threads == tid的key，插入后立即能查到
+    std::atomic<int> lookup_failures{0};
+    run_threads([&](int tid) {
+        std::mt19937 rng(tid);
+        std::vector<int> mine;
+        for (int v = tid; v < num_keys; v += num_threads) {
+            mine.push_back(v);
+        }
+        std::shuffle(mine.begin(), mine.end(), rng);
+        for (size_t i = 0; i < mine.size(); i++) {
+            ih->insert_entry(ix_test_key(mine[i]).data(), Rid{mine[i], mine[i]}, nullptr);
+            int v = mine[rng() % (i + 1)];
+            std::vector<Rid> result;
+            if (!ih->get_value(ix_test_key(v).data(), &result, nullptr) || result[0].page_no != v) {
+                lookup_failures++;
+            }
+        }
+    });
+    EXPECT_EQ(0, lookup_failures.load());
+    std::set<int> expected;
+    for (int v = 0; v < num_keys; v++) {
+        expected.insert(v);
+    }
+    check_tree(ih.get(), expected);
+
+    // 一半线程删除奇数key，另一半线程查找偶数key
+    run_threads([&](int tid) {
+        std::mt19937 rng(tid);
+        if (tid % 2 == 0) {
+            for (int v = tid + 1; v < num_keys; v += num_threads) {
+                if (!ih->delete_entry(ix_test_key(v).data(), nullptr)) {
+                    lookup_failures++;
+                }
+            }
+        } else {
+            for (int i = 0; i < keys_per_thread * 2; i++) {
+                int v = static_cast<int>(rng() % (num_keys / 2)) * 2;
+                std::vector<Rid> result;
+                if (!ih->get_value(ix_test_key(v).data(), &result, nullptr) || result[0].page_no != v) {
+                    lookup_failures++;
+                }
+            }
+        }
+    });
+    EXPECT_EQ(0, lookup_failures.load());
+    for (int v = 1; v < num_keys; v += 2) {
+        expected.erase(v);
+    }
+    check_tree(ih.get(), expected);
+
+    // 所有线程插入递增的key，每次插入都落在最右的叶结点上
+    std::atomic<int> next_key{num_keys};
+    run_threads([&](int tid) {
+        for (int i = 0; i < keys_per_thread; i++) {
+            int v = next_key++;
+            ih->insert_entry(ix_test_key(v).data(), Rid{v, v}, nullptr);
+            std::vector<Rid> result;
+            if (!ih->get_value(ix_test_key(v).data(), &result, nullptr) || result[0].page_no != v) {
+                lookup_failures++;
+            }
+        }
+    });
+    EXPECT_EQ(0, lookup_failures.load());
+    for (int v = num_keys; v < next_key.load(); v++) {
+        expected.insert(v);
+    }
+    check_tree(ih.get(), expected);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+TEST(IndexTest, ConcurrencyTest) { test_concurrency(false); }
+
+TEST(IndexTest, BLinkConcurrencyTest) { test_concurrency(true); }
+
+TEST(IndexTest, CompressedConcurrencyTest) { test_concurrency(false, true); }
+
+TEST(IndexTest, CompressedBLinkConcurrencyTest) { test_concurrency(true, true); }
+
+// 删除引起叶结点合并与重分配的同时，查找沿叶子链表移动到后继：删除持有叶结点时获取左兄弟的锁，
+// 扫描持有叶结点时获取后继的锁，二者不能互相等待
+static void test_scan_concurrency(bool compress) {
+    const std::string filename = compress ? "compressed_bplus_tree_scan_test" : "bplus_tree_scan_test";
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(4096, disk_manager.get(), BUFFER_POOL_PARTITIONS);
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "k", .type = TYPE_STRING,
+                                        .len = IX_TEST_KEY_LEN, .offset = 0, .index = true}};
+    if (disk_manager->is_file(ix_manager->get_index_name(filename, index_cols))) {
+        ix_manager->destroy_index(filename, index_cols);
+    }
+    ix_manager->create_index(filename, index_cols, false, compress);
+    auto ih = ix_manager->open_index(filename, index_cols);
+
+    const int num_keys = 4000;
+    std::set<int> expected;
+    for (int v = 0; v < num_keys; v++) {
+        ih->insert_entry(ix_test_key(v).data(), Rid{v, v}, nullptr);
+        expected.insert(v);
+    }
+
+    // 4个线程删除所有奇数key，同时4个线程不断定位，落在叶结点末尾时移动到后继
+    const int num_deleters = 4;
+    std::atomic<int> running{num_deleters};
+    std::atomic<int> failures{0};
+    std::atomic<int> positioned{0};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_deleters; tid++) {
+        threads.emplace_back([&, tid]() {
+            std::vector<int> mine;
+            for (int v = tid * 2 + 1; v < num_keys; v += num_deleters * 2) {
+                mine.push_back(v);
+            }
+            std::shuffle(mine.begin(), mine.end(), std::mt19937(tid));
+            for (int v : mine) {
+                if (!ih->delete_entry(ix_test_key(v).data(), nullptr)) {
+                    failures++;
+                }
+            }
+            running--;
+        });
+        threads.emplace_back([&, tid]() {
+            std::mt19937 rng(tid + num_deleters);
+            while (running.load() > 0) {
+                int v = static_cast<int>(rng() % num_keys);
+                Iid iid = v % 2 == 0 ? ih->lower_bound(ix_test_key(v).data()) : ih->upper_bound(ix_test_key(v).data());
+                if (iid.page_no < IX_INIT_ROOT_PAGE) {
+                    failures++;
+                }
+                positioned++;
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(0, failures.load());
+    EXPECT_GT(positioned.load(), 0);
+    for (int v = 1; v < num_keys; v += 2) {
+        expected.erase(v);
+    }
+    check_tree(ih.get(), expected);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+TEST(IndexTest, ScanConcurrencyTest) {
+    test_scan_concurrency(false);
+    test_scan_concurrency(true);
+}
+
+// 批量构建B+树：内存不够时外部排序，重复的key只保留rid最小的；构建出的树可以继续插入和删除
+static void test_bulk_load(bool blink, int fill_factor, bool compress = false) {
+    const std::string filename = std::string(compress ? "compressed_" : "") +
+                                 (blink ? "blink_tree_bulk_load_test" : "bplus_tree_bulk_load_test");
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(4096, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::vector<ColMeta> index_cols = {{.tab_name = filename, .name = "k", .type = TYPE_STRING,
+                                        .len = IX_TEST_KEY_LEN, .offset = 0, .index = true}};
+    std::string ix_name = ix_manager->get_index_name(filename, index_cols);
+    auto create = [&]() {
+        if (disk_manager->is_file(ix_name)) {
+            ix_manager->destroy_index(filename, index_cols);
+        }
+        ix_manager->create_index(filename, index_cols, blink, compress);
+        return disk_manager->open_file(ix_name);
+    };
+
+    // 没有键值对时仍是只有一个空的根叶结点的树
+    int fd = create();
+    EXPECT_EQ(0, IxBulkLoader(disk_manager.get(), fd, fill_factor).finish());
+    disk_manager->close_file(fd);
+    auto ih = ix_manager->open_index(filename, index_cols);
+    EXPECT_EQ(IX_INIT_ROOT_PAGE, ih->file_hdr_->root_page_);
+    EXPECT_EQ(ih->leaf_begin(), ih->leaf_end());
+    ix_manager->close_index(ih.get());
+
+    std::mt19937 rng(2023);
+    const int num_keys = 3000;
+    std::vector<int> values(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        values[i] = i * 2;
+    }
+    std::shuffle(values.begin(), values.end(), rng);
+    fd = create();
+    {
+        // 每个run只有100个键值对，排序需要多路归并
+        IxBulkLoader loader(disk_manager.get(), fd, fill_factor, 100 * (IX_TEST_KEY_LEN + sizeof(Rid)));
+        for (int v : values) {
+            loader.add(ix_test_key(v).data(), Rid{v, v});
+            if (v % 3 == 0) {
+                loader.add(ix_test_key(v).data(), Rid{num_keys * 2, v});
+            }
+        }
+        EXPECT_GT(loader.num_runs(), 10u);
+        EXPECT_EQ(num_keys, loader.finish());
+    }
+    disk_manager->close_file(fd);
+
+    ih = ix_manager->open_index(filename, index_cols);
+    std::set<int> expected(values.begin(), values.end());
+    check_tree(ih.get(), expected);
+    // 叶结点按填充因子装满，页号连续。压缩的叶结点按各自的容量贪心地装入，结点数更少
+    int order = ih->file_hdr_->btree_order_;
+    int leaf_cap = std::clamp(order * fill_factor / 100, 3, order);
+    int num_leaves = 0;
+    for (page_id_t page_no = IX_INIT_ROOT_PAGE; page_no != IX_LEAF_HEADER_PAGE; num_leaves++) {
+        IxNodeHandle *leaf = ih->fetch_node(page_no);
+        EXPECT_EQ(IX_INIT_ROOT_PAGE + num_leaves, page_no);
+        if (compress) {
+            EXPECT_GE(leaf->get_size(), leaf->get_min_size());
+            EXPECT_LE(leaf->get_size(), leaf->get_max_size());
+        } else {
+            EXPECT_LE(leaf->get_size(), leaf_cap);
+            EXPECT_GE(leaf->get_size(), leaf_cap - 1);
+        }
+        page_no = leaf->get_next_leaf();
+        if (blink && page_no != IX_LEAF_HEADER_PAGE) {
+            EXPECT_EQ(page_no, leaf->get_right_link());
+            IxNodeHandle *next = ih->fetch_node(page_no);
+            if (compress) {
+                // high key是截断后的分隔key：大于这个结点的所有key，不大于下一个结点的所有key
+                std::vector<char> last(leaf->get_key(leaf->get_size() - 1),
+                                       leaf->get_key(leaf->get_size() - 1) + IX_TEST_KEY_LEN);
+                EXPECT_LT(memcmp(last.data(), leaf->get_high_key(), IX_TEST_KEY_LEN), 0);
+                EXPECT_LE(memcmp(leaf->get_high_key(), next->get_key(0), IX_TEST_KEY_LEN), 0);
+            } else {
+                EXPECT_EQ(0, memcmp(leaf->get_high_key(), next->get_key(0), IX_TEST_KEY_LEN));
+            }
+            buffer_pool_manager->unpin_page(next->get_page_id(), false);
+            delete next;
+        }
+        buffer_pool_manager->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    if (compress) {
+        EXPECT_LT(num_leaves, (num_keys + leaf_cap - 1) / leaf_cap);
+    } else {
+        EXPECT_EQ((num_keys + leaf_cap - 1) / leaf_cap, num_leaves);
+    }
+    EXPECT_EQ(IX_INIT_ROOT_PAGE + num_leaves - 1, ih->file_hdr_->last_leaf_);
+    EXPECT_EQ(ih->file_hdr_->root_page_ + 1, ih->file_hdr_->num_pages_);
+
+    // 继续插入奇数key(分裂)并删除一半的偶数key(合并与重分配)
+    for (int v = 1; v < num_keys * 2; v += 2) {
+        ih->insert_entry(ix_test_key(v).data(), Rid{v, v}, nullptr);
+        expected.insert(v);
+    }
+    for (int i = 0; i < num_keys / 2; i++) {
+        EXPECT_TRUE(ih->delete_entry(ix_test_key(values[i]).data(), nullptr));
+        expected.erase(values[i]);
+    }
+    check_tree(ih.get(), expected);
+
+    ix_manager->close_index(ih.get());
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+TEST(IndexTest, BulkLoadTest) {
+    test_bulk_load(false, 100);
+    test_bulk_load(false, 50);
+}
+
+TEST(IndexTest, BLinkBulkLoadTest) {
+    test_bulk_load(true, 100);
+    test_bulk_load(true, 50);
+}
+
+TEST(IndexTest, CompressedBulkLoadTest) {
+    test_bulk_load(false, 100, true);
+    test_bulk_load(false, 50, true);
+    test_bulk_load(true, 100, true);
+}
+
+// 压缩的索引中key的编码保持INT/FLOAT的顺序，分隔key落在左右两个key之间
+TEST(IndexTest, KeyCompressionTest) {
+    std::vector<ColMeta> cols = {{.tab_name = "t", .name = "a", .type = TYPE_INT, .len = sizeof(int), .offset = 0},
+                                 {.tab_name = "t", .name = "b", .type = TYPE_FLOAT, .len = sizeof(float), .offset = 4}};
+    IxFileHdr hdr(IX_NO_PAGE, 0, IX_NO_PAGE, 2, 8, 8, 0, IX_NO_PAGE, IX_NO_PAGE, false, true);
+    for (auto &col : cols) {
+        hdr.col_types_.push_back(col.type);
+        hdr.col_lens_.push_back(col.len);
+    }
+    auto encode = [&](int a, float b) {
+        std::vector<char> key(8);
+        memcpy(key.data(), &a, sizeof(a));
+        memcpy(key.data() + 4, &b, sizeof(b));
+        ix_encode_key(hdr, key.data(), key.data());
+        return key;
+    };
+    std::vector<std::vector<char>> keys = {encode(INT32_MIN, 0), encode(-5, -1e30f), encode(-5, -1.5f),
+                                           encode(-5, -0.0f),    encode(-5, 0.25f),  encode(0, 0),
+                                           encode(1, -2),        encode(256, 1),     encode(INT32_MAX, 1e30f)};
+    for (size_t i = 1; i < keys.size(); i++) {
+        EXPECT_LT(memcmp(keys[i - 1].data(), keys[i].data(), 8), 0);
+        char sep[8];
+        ix_shortest_separator(keys[i - 1].data(), keys[i].data(), 8, sep);
+        EXPECT_LT(memcmp(keys[i - 1].data(), sep, 8), 0);
+        EXPECT_LE(memcmp(sep, keys[i].data(), 8), 0);
+    }
+    EXPECT_EQ(encode(3, 0.0f), encode(3, -0.0f));
+
+    // 有序的key共享的前缀只保存一次，末尾的0不保存
+    const char sorted[3][8] = {"ab\0\0\0\0\0", "abc\0\0\0\0", "abd\0x\0\0"};
+    IxKeyLayout layout = ix_key_layout(sorted[0], 3, 0, 8);
+    EXPECT_EQ(2, layout.prefix_len);
+    EXPECT_EQ(3, layout.key_width);
+    layout = ix_key_layout(sorted[0], 3, 1, 8);
+    EXPECT_EQ(2, layout.prefix_len);
+}
+
+// (INT, INT, CHAR(100))组合索引：压缩后的索引页面明显更少，查找结果与未压缩的索引相同
+TEST(IndexTest, CompressedCompositeIndexTest) {
+    const std::string filename = "compressed_composite_index_test";
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(4096, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::vector<ColMeta> index_cols = {
+        {.tab_name = filename, .name = "w_id", .type = TYPE_INT, .len = sizeof(int), .offset = 0, .index = true},
+        {.tab_name = filename, .name = "d_id", .type = TYPE_INT, .len = sizeof(int), .offset = 4, .index = true},
+        {.tab_name = filename, .name = "last", .type = TYPE_STRING, .len = 100, .offset = 8, .index = true}};
+    auto make_key = [](int w_id, int d_id, int n) {
+        std::vector<char> key(108, 0);
+        memcpy(key.data(), &w_id, sizeof(int));
+        memcpy(key.data() + 4, &d_id, sizeof(int));
+        snprintf(key.data() + 8, 100, "NAME%04d", n);
+        return key;
+    };
+    std::vector<std::vector<char>> keys;
+    for (int w_id = -2; w_id <= 2; w_id++) {
+        for (int d_id = 1; d_id <= 10; d_id++) {
+            for (int n = 0; n < 60; n++) {
+                keys.push_back(make_key(w_id, d_id, n));
+            }
+        }
+    }
+    std::vector<int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(2023));
+
+    int num_pages[2];
+    for (int compress = 0; compress < 2; compress++) {
+        if (disk_manager->is_file(ix_manager->get_index_name(filename, index_cols))) {
+            ix_manager->destroy_index(filename, index_cols);
+        }
+        ix_manager->create_index(filename, index_cols, false, compress);
+        auto ih = ix_manager->open_index(filename, index_cols);
+        for (int i : order) {
+            ih->insert_entry(keys[i].data(), Rid{i, i}, nullptr);
+        }
+        // keys按(w_id, d_id, last)有序，扫描得到的rid依次递增
+        std::vector<int> scanned;
+        IxScan scan(ih.get(), ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager.get());
+        for (; !scan.is_end(); scan.next()) {
+            scanned.push_back(scan.rid().page_no);
+        }
+        std::vector<int> expected(keys.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        EXPECT_EQ(expected, scanned);
+        for (int i = 0; i < static_cast<int>(keys.size()); i += 7) {
+            std::vector<Rid> result;
+            ASSERT_TRUE(ih->get_value(keys[i].data(), &result, nullptr));
+            EXPECT_EQ(i, result[0].page_no);
+        }
+        // w_id = 0, d_id = 3的第一个key前面有2 * 10 + 2个d_id
+        std::vector<char> lower = make_key(0, 3, 0);
+        EXPECT_EQ((2 * 10 + 2) * 60, ih->get_rid(ih->lower_bound(lower.data())).page_no);
+        num_pages[compress] = ih->file_hdr_->num_pages_;
+        ix_manager->close_index(ih.get());
+    }
+    EXPECT_LT(num_pages[1] * 3, num_pages[0] * 2);
+    ix_manager->destroy_index(filename, index_cols);
+}
+
+/**
+ * @brief db.meta的格式版本：没有版本行的旧格式中ColMeta没有varlen，读出为false；当前格式写出后能原样读回
+ */
+TEST(SystemTest, DbMetaVersionTest) {
+    const std::string baseline =
+        "db\n"
+        "1\n"
+        "t\n"
+        "2\n"
+        "t a 0 4 0 1\n"
+        "t b 2 16 4 0\n"
+        "1\n"
+        "t 4 1\n"
+        "t a 0 4 0 1\n";
+    DbMeta db_meta;
+    std::istringstream iss(baseline);
+    iss >> db_meta;
+    ASSERT_FALSE(iss.fail());
+    ASSERT_TRUE(db_meta.is_table("t"));
+    TabMeta &tab = db_meta.get_table("t");
+    ASSERT_EQ(2u, tab.cols.size());
+    EXPECT_EQ("b", tab.cols[1].name);
+    EXPECT_EQ(TYPE_STRING, tab.cols[1].type);
+    EXPECT_EQ(16, tab.cols[1].len);
+    EXPECT_EQ(4, tab.cols[1].offset);
+    EXPECT_FALSE(tab.cols[0].varlen);
+    EXPECT_FALSE(tab.cols[1].varlen);
+    ASSERT_EQ(1u, tab.indexes.size());
+    EXPECT_TRUE(tab.is_index({"a"}));
+
+    tab.cols[1].varlen = true;
+    std::ostringstream oss;
+    oss << db_meta;
+    EXPECT_EQ(0u, oss.str().find(DB_META_VERSION_TAG + " " + std::to_string(DB_META_VERSION) + "\n"));
+    DbMeta reloaded;
+    std::istringstream iss2(oss.str());
+    iss2 >> reloaded;
+    ASSERT_FALSE(iss2.fail());
+    TabMeta &tab2 = reloaded.get_table("t");
+    ASSERT_EQ(2u, tab2.cols.size());
+    EXPECT_FALSE(tab2.cols[0].varlen);
+    EXPECT_TRUE(tab2.cols[1].varlen);
+    EXPECT_EQ(16, tab2.cols[1].len);
+    EXPECT_TRUE(tab2.is_index({"a"}));
+
+    std::istringstream future(DB_META_VERSION_TAG + " " + std::to_string(DB_META_VERSION + 1) + "\ndb\n0\n");
+    DbMeta unsupported;
+    EXPECT_THROW(future >> unsupported, InternalError);
+}
+
+// RmRecord的复制赋值：大小相同时复用已分配的空间，大小不同时重新分配；自赋值不改变内容。移动后源记录不再拥有数据
+TEST(RecordTest, RmRecordTest) {
+    RmRecord a(8, "abcdefg");
+    RmRecord b(8, "1234567");
+    char *b_data = b.data;
+    b = a;
+    EXPECT_EQ(b_data, b.data);
+    EXPECT_STREQ("abcdefg", b.data);
+
+    RmRecord c(4, "xyz");
+    c = a;
+    EXPECT_EQ(8, c.size);
+    EXPECT_NE(a.data, c.data);
+    EXPECT_STREQ("abcdefg", c.data);
+
+    RmRecord &self = a;
+    char *a_data = a.data;
+    a = self;
+    EXPECT_EQ(a_data, a.data);
+    EXPECT_STREQ("abcdefg", a.data);
+
+    RmRecord unallocated;
+    unallocated = a;
+    EXPECT_TRUE(unallocated.allocated_);
+    EXPECT_STREQ("abcdefg", unallocated.data);
+
+    RmRecord moved(std::move(a));
+    EXPECT_EQ(a_data, moved.data);
+    EXPECT_EQ(nullptr, a.data);
+    EXPECT_FALSE(a.allocated_);
+    c = std::move(moved);
+    EXPECT_EQ(a_data, c.data);
+    EXPECT_EQ(8, c.size);
+    EXPECT_EQ(nullptr, moved.data);
+    EXPECT_FALSE(moved.allocated_);
+    c = std::move(c);
+    EXPECT_EQ(a_data, c.data);
+}
+
+// RmPageGuard在release()、被移动覆盖和析构时unpin页面，移动只转移pin，不增加也不提前释放
+TEST_F(BufferPoolManagerTest, PageGuardTest) {
+    BufferPoolManager bpm(8, BufferPoolManagerTest::disk_manager_.get());
+    bpm.set_optimistic_reads(false);
+    PageId page_ids[2];
+    Page *pages[2];
+    for (int i = 0; i < 2; i++) {
+        page_ids[i] = {.fd = BufferPoolManagerTest::fd_, .page_no = INVALID_PAGE_ID};
+        pages[i] = bpm.new_page(&page_ids[i]);
+        ASSERT_NE(nullptr, pages[i]);
+    }
+    EXPECT_EQ(1, pages[0]->pin_count_);
+
+    {
+        RmPageGuard guard(&bpm, pages[0]);
+        guard.release();
+        EXPECT_EQ(0, pages[0]->pin_count_);
+        EXPECT_EQ(nullptr, guard.page());
+        guard.release();
+        EXPECT_EQ(0, pages[0]->pin_count_);
+    }
+    EXPECT_EQ(0, pages[0]->pin_count_);
+
+    ASSERT_EQ(pages[0], bpm.fetch_page(page_ids[0]));
+    {
+        RmPageGuard guard(&bpm, pages[0]);
+        RmPageGuard moved(std::move(guard));
+        EXPECT_EQ(nullptr, guard.page());
+        EXPECT_EQ(pages[0], moved.page());
+        EXPECT_EQ(1, pages[0]->pin_count_);
+
+        // 移动赋值先释放原来持有的页面
+        RmPageGuard other(&bpm, pages[1]);
+        other = std::move(moved);
+        EXPECT_EQ(0, pages[1]->pin_count_);
+        EXPECT_EQ(1, pages[0]->pin_count_);
+        EXPECT_EQ(pages[0], other.page());
+    }
+    EXPECT_EQ(0, pages[0]->pin_count_);
+
+    // 记录视图通过guard持有页面
+    ASSERT_EQ(pages[0], bpm.fetch_page(page_ids[0]));
+    {
+        RmRecordView view(pages[0]->get_data(), 8, RmPageGuard(&bpm, pages[0]));
+        EXPECT_TRUE(view);
+        RmRecordView moved = std::move(view);
+        EXPECT_EQ(1, pages[0]->pin_count_);
+    }
+    EXPECT_EQ(0, pages[0]->pin_count_);
+    EXPECT_FALSE(RmRecordView());
+}
+
+/**
+ * @brief NextView()经过SeqScan和Projection时不复制记录：SeqScan的视图指向缓冲池中的页面，Projection的视图指向复用的缓冲区；
+ * 扫描结束后不残留pin。DeleteExecutor遇到已经删除的记录时跳过
+ */
+TEST(ExecutorTest, NextViewTest) {
+    const int num_records = 500;
+    const std::string tab_name = "next_view_test";
+    // | a: int | b: char(8) | c: int |
+    const int record_size = 16;
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    buffer_pool_manager->set_optimistic_reads(false);
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    SmManager sm_manager(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
+    if (disk_manager->is_file(tab_name)) {
+        rm_manager->destroy_file(tab_name);
+    }
+    rm_manager->create_file(tab_name, record_size);
+
+    TabMeta tab;
+    tab.name = tab_name;
+    tab.cols = {ColMeta{tab_name, "a", TYPE_INT, 4, 0, false},
+                ColMeta{tab_name, "b", TYPE_STRING, 8, 4, false},
+                ColMeta{tab_name, "c", TYPE_INT, 4, 12, false}};
+    sm_manager.db_.SetTabMeta(tab_name, tab);
+    sm_manager.fhs_.emplace(tab_name, rm_manager->open_file(tab_name));
+    RmFileHandle *fh = sm_manager.fhs_.at(tab_name).get();
+    std::vector<Rid> rids;
+    for (int i = 0; i < num_records; i++) {
+        char buf[record_size] = {};
+        *reinterpret_cast<int *>(buf) = i;
+        snprintf(buf + 4, 8, "r%d", i);
+        *reinterpret_cast<int *>(buf + 12) = -i;
+        rids.push_back(fh->insert_record(buf, nullptr));
+    }
+
+    // SeqScan：视图不持有pin也不拥有数据，直接指向扫描器pin住的页面
+    SeqScanExecutor scan(&sm_manager, tab_name, {}, nullptr);
+    int count = 0;
+    for (scan.beginTuple(); !scan.is_end(); scan.nextTuple()) {
+        RmRecordView view = scan.NextView();
+        ASSERT_TRUE(view);
+        EXPECT_EQ(record_size, view.size);
+        EXPECT_EQ(nullptr, view.guard.page());
+        EXPECT_EQ(nullptr, view.owned);
+        Page *page = buffer_pool_manager->fetch_page({fh->GetFd(), scan.rid().page_no});
+        EXPECT_GE(view.data, page->get_data());
+        EXPECT_LT(view.data, page->get_data() + PAGE_SIZE);
+        buffer_pool_manager->unpin_page(page->get_page_id(), false);
+        EXPECT_EQ(count, *reinterpret_cast<const int *>(view.data));
+        count++;
+    }
+    EXPECT_EQ(num_records, count);
+    EXPECT_FALSE(scan.NextView());
+
+    // Projection(c, b)：视图每次都指向同一个缓冲区
+    Condition cond;
+    cond.lhs_col = {tab_name, "a"};
+    cond.op = OP_GE;
+    cond.is_rhs_val = true;
+    cond.rhs_val.set_int(num_records / 2);
+    auto child = std::make_unique<SeqScanExecutor>(&sm_manager, tab_name, std::vector<Condition>{cond}, nullptr);
+    ProjectionExecutor projection(std::move(child), {{tab_name, "c"}, {tab_name, "b"}});
+    EXPECT_EQ(12u, projection.tupleLen());
+    const char *proj_buf = nullptr;
+    count = 0;
+    for (projection.beginTuple(); !projection.is_end(); projection.nextTuple()) {
+        RmRecordView view = projection.NextView();
+        ASSERT_TRUE(view);
+        if (proj_buf == nullptr) {
+            proj_buf = view.data;
+        }
+        EXPECT_EQ(proj_buf, view.data);
+        int a = num_records / 2 + count;
+        EXPECT_EQ(-a, *reinterpret_cast<const int *>(view.data));
+        EXPECT_EQ("r" + std::to_string(a), std::string(view.data + 4));
+        auto rec = projection.Next();
+        EXPECT_EQ(0, memcmp(rec->data, view.data, 12));
+        count++;
+    }
+    EXPECT_EQ(num_records - num_records / 2, count);
+    EXPECT_FALSE(projection.NextView());
+
+    // 扫描结束后所有数据页面都没有pin
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < fh->get_file_hdr().num_pages; page_no++) {
+        Page *page = buffer_pool_manager->fetch_page({fh->GetFd(), page_no});
+        EXPECT_EQ(1, page->pin_count_);
+        buffer_pool_manager->unpin_page(page->get_page_id(), false);
+    }
+
+    // 已经删除的记录在get_record_view中得到空视图，DeleteExecutor跳过它
+    fh->delete_record(rids[0], nullptr);
+    EXPECT_FALSE(fh->get_record_view(rids[0], nullptr));
+    DeleteExecutor del(&sm_manager, tab_name, {}, {rids[0], rids[1]}, nullptr);
+    del.Next();
+    EXPECT_FALSE(fh->is_record(rids[1]));
+
+    rm_manager->close_file(fh);
+    sm_manager.fhs_.clear();
+    rm_manager->destroy_file(tab_name);
+}